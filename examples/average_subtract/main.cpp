@@ -10,9 +10,12 @@
 // openpiv
 #include "loaders/image_loader.h"
 #include "core/enumerate.h"
+#include "core/executor.h"
 #include "core/image.h"
+#include "core/image_evaluate.h"
 #include "core/image_utils.h"
 #include "core/log.h"
+#include "core/pipeline.h"
 #include "core/stream_utils.h"
 #include "algos/stats.h"
 
@@ -98,6 +101,7 @@ int main( int argc, char* argv[] )
     // process: find average
     core::size s;
     core::gf_image avg;
+    core::work_stealing_executor executor;
     size_t processed = 0;
 
     try {
@@ -111,18 +115,19 @@ int main( int argc, char* argv[] )
         return 1;
     }
 
-    for ( size_t i=1; i<input_files.size(); ++i)
-    {
-        try {
-            auto image = load_from_file(input_files[i]);
-            avg = avg + image;
-            ++processed;
-        }
-        catch ( std::exception& e )
+    // load of image N+1 overlaps with accumulation of image N
+    core::run_pipeline(
+        input_files.size() - 1,
+        [&input_files]( size_t i ) { return load_from_file(input_files[i + 1]); },
+        [&avg, &executor, s]( size_t, core::gf_image&& image )
         {
-            logger::error("failed to load image: {}", e.what());
-        }
-    }
+            if ( image.size() != s )
+                return false;
+
+            core::evaluate_in_place<core::plus_op>( avg, image, executor );
+            return true;
+        },
+        [&processed]( size_t, bool&& accumulated ) { processed += accumulated ? 1 : 0; } );
 
     if ( processed == 0 )
     {
@@ -131,7 +136,7 @@ int main( int argc, char* argv[] )
     }
 
     // normalize
-    avg = avg / core::g_f{processed};
+    core::evaluate_in_place<core::div_op>( avg, core::g_f{processed}, executor );
 
     logger::info("found average; processed {} image files", processed);
 
@@ -143,20 +148,32 @@ int main( int argc, char* argv[] )
         return 1;
     }
 
-    // iterate over all images, subtract average and write
-    for ( size_t i=0; i<input_files.size(); ++i )
-    {
-        try {
-            auto image = load_from_file(input_files[i]);
-            image = image - avg;
-            std::fstream os(
-                input_files[i] + ".avg_sub.pnm",
-                std::ios_base::trunc | std::ios_base::out | std::ios_base::binary );
-            writer->save( os, image );
-        }
-        catch ( std::exception& )
-        {}
-    }
+    // iterate over all images, subtract average and write; loading,
+    // subtraction and writing of consecutive images overlap
+    core::run_pipeline(
+        input_files.size(),
+        [&input_files]( size_t i ) { return load_from_file(input_files[i]); },
+        [&avg, &executor]( size_t, core::gf_image&& image )
+        {
+            if ( image.size() == avg.size() )
+                core::evaluate_in_place<core::minus_op>( image, avg, executor );
+
+            return std::move(image);
+        },
+        [&input_files, &writer, &avg]( size_t i, core::gf_image&& image )
+        {
+            if ( image.size() != avg.size() )
+                return;
+
+            try {
+                std::fstream os(
+                    input_files[i] + ".avg_sub.pnm",
+                    std::ios_base::trunc | std::ios_base::out | std::ios_base::binary );
+                writer->save( os, image );
+            }
+            catch ( std::exception& )
+            {}
+        } );
 
     return 0;
 };
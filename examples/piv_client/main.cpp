@@ -0,0 +1,124 @@
+// std
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// utils
+#include <cxxopts.hpp>
+
+// openpiv
+#include "loaders/image_loader.h"
+#include "core/exception_builder.h"
+#include "core/image.h"
+#include "core/log.h"
+#include "core/stream_utils.h"
+#include "io/piv_service.h"
+#include "io/vector_field_io.h"
+
+using namespace openpiv;
+namespace logger = openpiv::core::logger;
+
+core::gf_image load_from_file( const std::string& filename )
+{
+    std::ifstream is(filename, std::ios::binary);
+    if ( !is.is_open() )
+        core::exception_builder<std::runtime_error>() << "failed to open " << filename;
+
+    auto loader{ core::image_loader_registry::find(is) };
+    if ( !loader )
+        core::exception_builder<std::runtime_error>() << "failed to find loader for " << filename;
+
+    core::gf_image image;
+    loader->load( is, image );
+
+    return image;
+}
+
+int main( int argc, char* argv[] )
+{
+    // get arguments
+    cxxopts::Options options(argv[0]);
+    options
+        .positional_help("[input files]")
+        .show_positional_help();
+
+    std::string socket_path;
+    std::vector<std::string> input_files;
+    bool shutdown = false;
+    auto log_level = logger::Level::INFO;
+
+    try
+    {
+        options
+            .add_options()
+            ("h, help", "help", cxxopts::value<bool>())
+            ("s, socket", "socket path of a running `process --daemon`", cxxopts::value<std::string>(socket_path))
+            ("i, input", "input files", cxxopts::value<std::vector<std::string>>(input_files))
+            ("shutdown", "ask the daemon to shut down after processing", cxxopts::value<bool>(shutdown))
+            ("loglevel", "log level", cxxopts::value<logger::Level>(log_level)->default_value("INFO"));
+
+        options.parse_positional({"input"});
+        auto result = options.parse(argc, argv);
+
+        // log to stderr
+        logger::Logger::instance().add_sink(
+            [log_level](logger::Level l, const std::string& m) -> bool
+            {
+                if ( l > log_level )
+                    return true;
+
+                std::cerr << m << "\n";
+                return true;
+            });
+
+        if (result.count("help"))
+        {
+            std::cout << options.help({""}) << "\n";
+            return 0;
+        }
+
+        if (socket_path.empty() || input_files.size() % 2 != 0)
+        {
+            logger::error("require a socket path and zero or more pairs of input images");
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        logger::error("error parsing options: {}", e.what());
+        return 1;
+    }
+
+    // send each pair to the daemon and write the results to stdout in
+    // the same layout as examples/process
+    try
+    {
+        core::piv_client client( socket_path );
+        const size_t pair_count = input_files.size()/2;
+        for ( size_t i=0; i<pair_count; ++i )
+        {
+            auto a = load_from_file( input_files[2*i] );
+            auto b = load_from_file( input_files[2*i + 1] );
+
+            const auto start = std::chrono::steady_clock::now();
+            auto field = client.process( a, b );
+            logger::info("{}: {}us round trip",
+                         input_files[2*i],
+                         std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count());
+
+            if ( pair_count > 1 )
+                std::cout << "# " << input_files[2*i] << ", " << input_files[2*i + 1] << "\n";
+            core::write_vector_field_text( std::cout, field );
+        }
+
+        if ( shutdown )
+            client.shutdown();
+    }
+    catch (const std::exception& e)
+    {
+        logger::error("failed: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,11 +1,19 @@
 
 // std
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cinttypes>
+#include <csignal>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // utils
@@ -20,17 +28,57 @@
 #include "algos/fft.h"
 #include "algos/pocket_fft.h"
 #include "loaders/image_loader.h"
+#include "core/batch.h"
 #include "core/enumerate.h"
+#include "core/executor.h"
+#include "core/filters.h"
 #include "core/grid.h"
 #include "core/image.h"
 #include "core/image_utils.h"
+#include "core/integral_image.h"
 #include "core/log.h"
+#include "core/memory_resource.h"
+#include "core/pipeline.h"
+#include "core/realtime.h"
+#include "core/sharded_batch.h"
 #include "core/stream_utils.h"
 #include "core/vector.h"
+#include "core/vector_field.h"
+#include "io/async_writer.h"
+#include "io/piv_service.h"
+#include "io/vector_field_series.h"
 
 using namespace openpiv;
 namespace logger = openpiv::core::logger;
 
+core::g16_image load_from_file( const std::string& filename )
+{
+    std::ifstream is(filename, std::ios::binary);
+    if ( !is.is_open() )
+        core::exception_builder<std::runtime_error>() << "failed to open " << filename;
+
+    auto loader{ core::image_loader_registry::find(is) };
+    if ( !loader )
+        core::exception_builder<std::runtime_error>() << "failed to find loader for " << filename;
+
+    // frames are kept at 16 bits per pixel, with rows aligned for
+    // vectorised correlation; windows are converted to floating point
+    // as they're loaded by the correlator
+    core::g16_image image{ {1, 1}, core::g_16{}, core::image_layout::aligned() };
+    loader->load( is, image );
+
+    return image;
+}
+
+// daemon mode: stopped by SIGINT/SIGTERM
+std::atomic<core::piv_service*> running_service{ nullptr };
+
+extern "C" void stop_service( int )
+{
+    if ( auto* service = running_service.load() )
+        service->stop();
+}
+
 int main( int argc, char* argv[] )
 {
     // get arguments
@@ -45,7 +93,19 @@ int main( int argc, char* argv[] )
     std::string execution;
     uint8_t thread_count = std::thread::hardware_concurrency()-1;
     bool limit_search = false;
+    bool binary_output = false;
+    std::string hdf5_output;
+    size_t memory_budget_mb = 1024;
+    size_t process_count = 1;
+    std::string series_output;
+    std::string daemon_socket;
+    double realtime_deadline_ms = 0;
+    double frame_rate = 10;
+    uint32_t background_radius = 0;
+    double highpass_sigma = 0;
+    double min_contrast = 0;
     std::string fft_type;
+    auto order = core::grid_order::ROW_MAJOR;
     auto log_level = logger::Level::INFO;
 
     try
@@ -59,7 +119,19 @@ int main( int argc, char* argv[] )
             ("t, thread-count", "pool thread count", cxxopts::value<uint8_t>(thread_count)->default_value(std::to_string(thread_count)))
             ("e, exec", "execution method", cxxopts::value<std::string>(execution)->default_value("pool"))
             ("l, limit-search", "limit peak search to central 25% of interrogation area", cxxopts::value<bool>(limit_search))
+            ("b, binary", "write each vector field in binary format to <image a>.vec", cxxopts::value<bool>(binary_output))
+            ("hdf5", "append all vector fields to an HDF5 file", cxxopts::value<std::string>(hdf5_output))
+            ("memory-budget", "batch execution: memory for in-flight images, MiB", cxxopts::value<size_t>(memory_budget_mb)->default_value("1024"))
+            ("p, processes", "number of worker processes, each processing a shard of the image pairs", cxxopts::value<size_t>(process_count)->default_value("1"))
+            ("series", "with --processes: file collecting the vector fields of all workers, default <first image>.vfs", cxxopts::value<std::string>(series_output))
+            ("daemon", "serve image pairs sent to this Unix socket path until stopped", cxxopts::value<std::string>(daemon_socket))
+            ("realtime", "bounded latency: treat the pairs as a live stream, degrading or dropping frames to meet this deadline, ms", cxxopts::value<double>(realtime_deadline_ms))
+            ("frame-rate", "with --realtime: rate at which pairs are acquired, Hz", cxxopts::value<double>(frame_rate)->default_value("10"))
+            ("background", "subtract the minimum over a square window of this radius from each image, pixels", cxxopts::value<uint32_t>(background_radius))
+            ("highpass", "subtract a Gaussian smoothing with this standard deviation from each image, pixels", cxxopts::value<double>(highpass_sigma))
+            ("min-contrast", "mask windows whose intensity standard deviation in either image is below this", cxxopts::value<double>(min_contrast))
             ("f, ffttype", "FFT type", cxxopts::value<std::string>(fft_type)->default_value("complex"))
+            ("grid-order", "grid traversal order for work-stealing: row-major, morton, hilbert, supertile", cxxopts::value<core::grid_order>(order)->default_value("row-major"))
             ("loglevel", "log level", cxxopts::value<logger::Level>(log_level)->default_value("INFO"));
 
         options.parse_positional({"input"});
@@ -82,9 +154,9 @@ int main( int argc, char* argv[] )
             return 0;
         }
 
-        if (result.count("input") != 2)
+        if (daemon_socket.empty() && (input_files.size() < 2 || input_files.size() % 2 != 0))
         {
-            logger::error("require two input images");
+            logger::error("require one or more pairs of input images");
             return 1;
         }
     }
@@ -99,97 +171,68 @@ int main( int argc, char* argv[] )
     logger::info("overlap: {}", overlap);
     logger::info("input files: {}", core::join(input_files, ", "));
     logger::info("execution: {}", execution);
-
-    // get images
-    std::vector<core::gf_image> images;
-    try {
-        for ( const auto& input_file : input_files )
-        {
-            std::ifstream is(input_file, std::ios::binary);
-            if ( !is.is_open() )
-                core::exception_builder<std::runtime_error>() << "failed to open " << input_file;
-
-            auto loader{ core::image_loader_registry::find(is) };
-            if ( !loader )
-                core::exception_builder<std::runtime_error>() << "failed to find loader for " << input_file;
-
-            core::gf_image image;
-            loader->load( is, image );
-            images.emplace_back(std::move(image));
-        }
-    }
-    catch ( std::exception& e )
-    {
-        logger::error("failed to load image: {}", e.what());
-        return 1;
-    }
-
-    // check image sizes
-    if ( images[0].size() != images[1].size() )
-    {
-        logger::error("image sizes don't match: {}, {}", images[0].size(), images[1].size());
-        return 1;
-    }
-
-    logger::info("loaded images have size: {}", images[0].size());
-
-    // create a grid for processing
-    auto ia = core::size{size, size};
-    auto grid = core::generate_cartesian_grid( images[0].size(), ia, overlap );
-    logger::info("generated grid for image size: {}, ia: {} ({}% overlap)", images[0].size(), ia, overlap*100);
-    logger::info("grid count: {}", grid.size());
-    logger::debug("grid: {}", grid);
+    logger::info("grid order: {}", core::to_string(order));
 
     // process!
-    struct point_vector
-    {
-        core::point2<double> xy;
-        core::vector2<double> vxy;
-        double sn = 0.0;
-    };
-    std::vector<point_vector> found_peaks( grid.size() );
-
-    // wrap correlators
-    using correlator_t = std::function<core::gf_image(const core::gf_image&, const core::gf_image&)>;
-    std::unordered_map<std::string, correlator_t> correlators = {
-        {"complex",
-         [ia](const core::gf_image& im_a, const core::gf_image& im_b) -> core::gf_image
-             {
-                 static algos::FFT fft{ ia };
-                 return fft.cross_correlate(im_a, im_b);
-             } },
-        {"real",
-         [ia](const core::gf_image& im_a, const core::gf_image& im_b) -> core::gf_image
-             {
-                 static algos::FFT fft{ ia };
-                 return fft.cross_correlate_real(im_a, im_b);
-             } },
-        {"pocket",
-         [ia](const core::gf_image& im_a, const core::gf_image& im_b) -> core::gf_image
-             {
-                 static algos::PocketFFT fft{ ia };
-                 return fft.cross_correlate(im_a, im_b);
-             } },
-        {"pocket_real",
-         [ia](const core::gf_image& im_a, const core::gf_image& im_b) -> core::gf_image
-             {
-                 static algos::PocketFFT fft{ ia };
-                 return fft.cross_correlate_real(im_a, im_b);
-             } } };
-
-    if (correlators.count(fft_type) == 0)
+    using image_pair_t = std::array<core::g16_image, 2>;
+    using field_t = core::vector_field_d;
+    const auto ia = core::size{size, size};
+
+    // wrap correlators; these take views onto the interrogation
+    // areas so window data is read directly from the source images,
+    // of any pixel type, and produce a floating point correlation
+    enum class correlator_type { COMPLEX, REAL, POCKET, POCKET_REAL };
+    const std::unordered_map<std::string, correlator_type> correlator_types = {
+        {"complex", correlator_type::COMPLEX},
+        {"real", correlator_type::REAL},
+        {"pocket", correlator_type::POCKET},
+        {"pocket_real", correlator_type::POCKET_REAL} };
+
+    if (correlator_types.count(fft_type) == 0)
     {
         logger::error("unknown fft type: {}", fft_type);
         return 1;
     }
 
-    auto correlator = correlators[fft_type];
+    auto correlator = [ia, type = correlator_types.at(fft_type)](const auto& im_a, const auto& im_b) -> core::gf_image
+        {
+            switch ( type )
+            {
+            case correlator_type::COMPLEX:
+            {
+                static algos::FFT fft{ ia };
+                return fft.cross_correlate(im_a, im_b);
+            }
+            case correlator_type::REAL:
+            {
+                static algos::FFT fft{ ia };
+                return fft.cross_correlate_real(im_a, im_b);
+            }
+            case correlator_type::POCKET:
+            {
+                static algos::PocketFFT fft{ ia };
+                return fft.cross_correlate(im_a, im_b);
+            }
+            case correlator_type::POCKET_REAL:
+            default:
+            {
+                static algos::PocketFFT fft{ ia };
+                return fft.cross_correlate_real(im_a, im_b);
+            }
+            }
+        };
 
     // processing strategy
-    auto processor = [&images, &found_peaks, correlator = std::move(correlator), limit_search]( size_t i, const core::rect& ia )
+    auto processor = [correlator = std::move(correlator), limit_search]( const auto& image_a, const auto& image_b, field_t& found_peaks, size_t i, const core::rect& ia, bool subpixel = true )
                      {
-                         const auto view_a{ core::extract( images[0], ia ) };
-                         const auto view_b{ core::extract( images[1], ia ) };
+                         if ( found_peaks.flags()[i] & core::vector_flag::MASKED )
+                             return;
+
+                         // temporaries of this window are allocated from
+                         // a per-thread arena and released together
+                         const core::scoped_arena arena;
+                         const auto view_a{ core::create_image_view( image_a, ia ) };
+                         const auto view_b{ core::create_image_view( image_b, ia ) };
 
                          // prepare & correlate
                          // output of correlation has lost positional information
@@ -214,105 +257,494 @@ int main( int argc, char* argv[] )
                          if ( peaks.size() != num_peaks )
                          {
                              logger::error("failed to find a peak for ia: {}", ia);
+                             found_peaks.flags()[i] = core::vector_flag::INVALID;
                              return;
                          }
 
-                         point_vector result;
+                         field_t::entry result;
                          auto bl = ia.bottomLeft();
                          auto midpoint = ia.midpoint();
                          auto peak = peaks[0];
-                         auto peak_location = core::fit_simple_gaussian( peak );
+                         auto peak_location = subpixel
+                             ? core::fit_simple_gaussian( peak )
+                             : core::point2<double>{ peak.rect().midpoint() };
 
                          result.xy = midpoint;
-                         result.vxy = { midpoint[0] - (bl[0] + peak_location[0]), midpoint[1] - (bl[1] + peak_location[1]) };
+                         result.uv = { midpoint[0] - (bl[0] + peak_location[0]), midpoint[1] - (bl[1] + peak_location[1]) };
 
                          // convert from image normal cartesian
-                         result.xy[1] = images[0].height() - result.xy[1];
+                         result.xy[1] = image_a.height() - result.xy[1];
 
                          // find s/n (or rather, highest to next highest peak)
                          if ( peaks[1][ {1, 1} ] > 0 )
-                             result.sn = peaks[0][ {1, 1} ]/peaks[1][ {1, 1} ];
+                             result.quality = peaks[0][ {1, 1} ]/peaks[1][ {1, 1} ];
 
-                         found_peaks[i] = std::move(result);
+                         found_peaks.set( i, result );
                      };
 
-    const auto t1 = std::chrono::high_resolution_clock::now();
+    // windows without the contrast to correlate, e.g. without
+    // particles, are masked before processing; the standard deviation
+    // of each window comes from the summed-area tables of each image
+    auto mask_windows = [min_contrast]( const auto& image_a, const auto& image_b, const std::vector<core::rect>& grid, field_t& found_peaks )
+    {
+        if ( min_contrast <= 0 )
+            return;
+
+        using pixel_t = typename std::decay_t<decltype(image_a)>::pixel_t;
+        const core::integral_image<pixel_t> integral_a{ image_a };
+        const core::integral_image<pixel_t> integral_b{ image_b };
+        for ( size_t i=0; i<grid.size(); ++i )
+        {
+            if ( integral_a.stddev( grid[i] ) >= min_contrast && integral_b.stddev( grid[i] ) >= min_contrast )
+                continue;
+
+            field_t::entry masked;
+            masked.xy = grid[i].midpoint();
+            masked.xy[1] = image_a.height() - masked.xy[1];
+            masked.flags = core::vector_flag::MASKED;
+            found_peaks.set( i, masked );
+        }
+    };
+
+    // work-stealing executor is kept alive across all image pairs; it
+    // is created once we know which process does the work
+    const bool realtime = realtime_deadline_ms > 0;
+    const bool use_executor = execution == "work-stealing" || execution == "batch" || realtime;
+    std::unique_ptr<core::work_stealing_executor> executor;
+    auto create_executor = [&executor, use_executor, thread_count, realtime]() {
+        executor = std::make_unique<core::work_stealing_executor>( use_executor ? thread_count : 0, realtime );
+    };
 
-    // check execution
-    if (thread_count <= 1)
+    // process all interrogation areas of a single image pair; loaded
+    // pairs are g16, the daemon's are of the client's pixel type and
+    // read in place from its buffer
+    auto process_pair = [&]( const auto& image_a, const auto& image_b ) -> field_t
     {
-        logger::info("processing using single thread");
-        size_t i = 0;
-        for ( const auto& ia : grid )
+        // create a grid for processing
+        auto grid = core::generate_cartesian_grid( image_a.size(), ia, overlap );
+        logger::debug("generated grid for image size: {}, ia: {} ({}% overlap)", image_a.size(), ia, overlap*100);
+        logger::debug("grid count: {}", grid.size());
+
+        field_t found_peaks( core::grid_shape( grid ) );
+        mask_windows( image_a, image_b, grid, found_peaks );
+
+        // check execution
+        if (thread_count <= 1)
         {
-            processor(i++, ia);
+            size_t i = 0;
+            for ( const auto& ia : grid )
+            {
+                processor(image_a, image_b, found_peaks, i++, ia);
+            }
         }
-    }
-    else
+        else
 #if defined(ASYNCPLUSPLUS)
-    if ( execution == "async++" )
-    {
-        logger::info("processing using async++");
-        std::atomic<size_t> i = 0;
-        async::parallel_for( grid,
-                             [&i, processor] (const core::rect& ia)
-                             {
-                                 processor(i++, ia);
-                             } );
-    }
-    else
+        if ( execution == "async++" )
+        {
+            std::atomic<size_t> i = 0;
+            async::parallel_for( grid,
+                                 [&i, &image_a, &image_b, &found_peaks, &processor] (const core::rect& ia)
+                                 {
+                                     processor(image_a, image_b, found_peaks, i++, ia);
+                                 } );
+        }
+        else
 #endif
-    if ( execution == "pool" )
+        if ( execution == "pool" )
+        {
+            ThreadPool pool( thread_count );
+
+            size_t i = 0;
+            for ( const auto& ia : grid )
+            {
+                pool.enqueue( [i, ia, &image_a, &image_b, &found_peaks, &processor](){ processor(image_a, image_b, found_peaks, i, ia); } );
+                ++i;
+            }
+        }
+        else if ( execution == "bulk-pool" )
+        {
+            ThreadPool pool( thread_count );
+
+            // - split the grid into thread_count chunks
+            // - wrap each chunk into a processing for loop and push to thread
+
+            // ensure we don't miss grid locations due to rounding
+            size_t chunk_size = grid.size()/thread_count;
+            std::vector<size_t> chunk_sizes( thread_count, chunk_size );
+            chunk_sizes.back() = grid.size() - (thread_count-1)*chunk_size;
+
+            logger::debug("chunk sizes: {}", core::join(chunk_sizes, ", "));
+
+            size_t i = 0;
+            for ( const auto& chunk_size_ : chunk_sizes )
+            {
+                pool.enqueue(
+                    [i, chunk_size_, &grid, &image_a, &image_b, &found_peaks, &processor]() {
+                        for ( size_t j=i; j<i + chunk_size_; ++j )
+                            processor(image_a, image_b, found_peaks, j, grid[j]);
+                    } );
+                i += chunk_size_;
+            }
+        }
+        else if ( use_executor )
+        {
+            // each worker takes cache-sized chunks of the grid, in
+            // traversal order, and steals from other workers when idle
+            const auto traversal = core::grid_traversal_order( grid, order );
+            core::parallel_for(
+                *executor,
+                grid,
+                traversal,
+                [&image_a, &image_b, &found_peaks, &processor]( size_t i, const core::rect& ia ) {
+                    processor(image_a, image_b, found_peaks, i, ia);
+                } );
+        }
+
+        return found_peaks;
+    };
+
+    if ( !daemon_socket.empty() )
     {
-        logger::info("processing using thread pool");
-        ThreadPool pool( thread_count );
+        // loaders, correlator, FFT plans and the executor's threads
+        // are set up once and reused for every pair received
+        try {
+            create_executor();
+            core::piv_service service(
+                daemon_socket,
+                [&process_pair]( const auto& a, const auto& b ) { return process_pair( a, b ); } );
+
+            running_service = &service;
+            std::signal( SIGINT, stop_service );
+            std::signal( SIGTERM, stop_service );
+
+            logger::info("serving on {}", daemon_socket);
+            service.run();
+            running_service = nullptr;
+            logger::info("processed {} image pair(s)", service.requests());
+        }
+        catch ( std::exception& e )
+        {
+            logger::error("daemon failed: {}", e.what());
+            return 1;
+        }
+
+        return 0;
+    }
 
-        size_t i = 0;
-        for ( const auto& ia : grid )
+    // run as a pipeline: loading of pair N+1 and writing of pair N-1
+    // overlap with processing of pair N
+    const size_t pair_count = input_files.size()/2;
+    size_t ia_count = 0;
+
+    // optional preprocessing, applied as each pair is loaded
+    core::filter_chain<core::g_16> preprocess;
+    if ( background_radius > 0 )
+        preprocess.subtract_background( background_radius );
+    if ( highpass_sigma > 0 )
+        preprocess.high_pass( highpass_sigma );
+
+    // sequences are often given as overlapping pairs (a, b), (b, c),
+    // ...; the last image loaded is kept, shareable, so such an image
+    // is loaded and filtered once and both pairs read the same pixels
+    std::mutex last_loaded_mutex;
+    std::string last_loaded_path;
+    core::g16_image last_loaded;
+    auto load_image = [&]( const std::string& path ) -> core::g16_image
+    {
         {
-            pool.enqueue( [i, ia, &processor](){ processor(i, ia); } );
-            ++i;
+            std::unique_lock<std::mutex> lock( last_loaded_mutex );
+            if ( path == last_loaded_path )
+                return last_loaded;
         }
+
+        auto im = load_from_file( path );
+        preprocess( im );
+        im.share();
+
+        std::unique_lock<std::mutex> lock( last_loaded_mutex );
+        last_loaded_path = path;
+        last_loaded = im;
+        return im;
+    };
+
+    auto load_pair = [&input_files, &load_image]( size_t i ) -> image_pair_t
+    {
+        image_pair_t images{ load_image( input_files[2*i] ), load_image( input_files[2*i + 1] ) };
+        if ( images[0].size() != images[1].size() )
+            core::exception_builder<std::runtime_error>()
+                << "image sizes don't match: " << images[0].size() << ", " << images[1].size();
+
+        logger::debug("loaded images have size: {}", images[0].size());
+        return images;
+    };
+
+    core::vector_field_parameters parameters;
+    parameters.window_size = ia;
+    parameters.window_spacing = { static_cast<uint32_t>(size * overlap), static_cast<uint32_t>(size * overlap) };
+
+    // vector fields are written on a background thread; if output
+    // can't keep up the pipeline is held back and this is reported
+    std::unique_ptr<core::async_writer> writer;
+    try {
+        std::unique_ptr<core::vector_field_sink> sink;
+        if ( !hdf5_output.empty() )
+            sink = std::make_unique<core::hdf5_sink>( hdf5_output, parameters );
+        else if ( binary_output )
+            sink = std::make_unique<core::binary_sink>(
+                [&input_files]( const core::vector_field_frame& frame ) { return input_files[2*frame.index] + ".vec"; },
+                parameters );
+        else
+            sink = std::make_unique<core::text_sink>( std::cout );
+
+        writer = std::make_unique<core::async_writer>( std::move( sink ) );
     }
-    else if ( execution == "bulk-pool" )
+    catch ( std::exception& e )
+    {
+        logger::error("failed to open output: {}", e.what());
+        return 1;
+    }
+
+    auto write_field = [&input_files, pair_count, &ia_count, &writer]( size_t i, field_t&& found_peaks )
     {
-        logger::info("processing using thread pool with bulk split");
-        ThreadPool pool( thread_count );
+        ia_count += found_peaks.size();
 
-        // - split the grid into thread_count chunks
-        // - wrap each chunk into a processing for loop and push to thread
+        // separate multiple pairs with a comment line
+        std::string label;
+        if ( pair_count > 1 )
+            label = input_files[2*i] + ", " + input_files[2*i + 1];
 
-        // ensure we don't miss grid locations due to rounding
-        size_t chunk_size = grid.size()/thread_count;
-        std::vector<size_t> chunk_sizes( thread_count, chunk_size );
-        chunk_sizes.back() = grid.size() - (thread_count-1)*chunk_size;
+        writer->write( i, std::move( found_peaks ), std::move( label ) );
+    };
 
-        logger::debug("chunk sizes: {}", core::join(chunk_sizes, ", "));
+    logger::info("processing {} image pair(s) using {}", pair_count, realtime ? "realtime" : thread_count <= 1 ? "single thread" : execution);
 
-        size_t i = 0;
-        for ( const auto& chunk_size_ : chunk_sizes )
+    core::pipeline_stats stats;
+    try {
+        if ( realtime )
         {
-            pool.enqueue(
-                [i, chunk_size_, &grid, &processor]() {
-                    for ( size_t j=i; j<i + chunk_size_; ++j )
-                        processor(j, grid[j]);
+            // the pairs stand in for a live camera: they're held in
+            // memory and copied into preallocated frame slots at the
+            // frame rate, from a producer thread. Frames are processed
+            // in order on a thread pinned to CPU 0, with the executor's
+            // workers pinned to the remaining CPUs; if the deadline is
+            // at risk frames are processed with a coarser grid or
+            // without sub-pixel fitting, per window, or are dropped
+            create_executor();
+            std::vector<image_pair_t> source;
+            for ( size_t i=0; i<pair_count; ++i )
+            {
+                source.push_back( load_pair( i ) );
+                if ( source[i][0].size() != source[0][0].size() )
+                    core::exception_builder<std::runtime_error>()
+                        << "realtime processing requires images of a single size: " << input_files[2*i];
+            }
+
+            const auto full_grid = core::generate_cartesian_grid( source[0][0].size(), ia, overlap );
+            const auto coarse_grid =
+                core::generate_cartesian_grid( source[0][0].size(), ia, std::min( 1.0, 2*overlap ) );
+
+            core::realtime_options options;
+            options.deadline = std::chrono::microseconds( static_cast<int64_t>( realtime_deadline_ms*1000 ) );
+            options.cpu = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            // the slots are written by the producer so each needs
+            // pixels of its own rather than sharing those of source[0]
+            std::vector<image_pair_t> slots( 4, source[0] );
+            for ( auto& slot : slots )
+                for ( auto& im : slot )
+                    im.detach();
+
+            core::realtime_pipeline<image_pair_t, field_t> pipeline(
+                std::move( slots ),
+                [&]( image_pair_t& images, const core::realtime_context& ctx ) -> field_t {
+                    const auto& grid = ctx.quality() == core::realtime_quality::COARSE_GRID ? coarse_grid : full_grid;
+                    const bool subpixel = ctx.quality() == core::realtime_quality::FULL;
+                    field_t found_peaks( core::grid_shape( grid ) );
+                    mask_windows( images[0], images[1], grid, found_peaks );
+
+                    std::atomic<size_t> done{ 0 };
+                    executor->parallel_for(
+                        0, grid.size(),
+                        [&]( size_t i ) {
+                            // once the deadline has passed the remaining
+                            // windows are skipped, so latency stays bounded
+                            if ( ctx.time_left() <= std::chrono::steady_clock::duration::zero() )
+                            {
+                                found_peaks.flags()[i] = core::vector_flag::INVALID;
+                                return;
+                            }
+
+                            const double fraction = static_cast<double>( done++ )/grid.size();
+                            processor( images[0], images[1], found_peaks, i, grid[i], !ctx.behind( fraction ) && subpixel );
+                        } );
+
+                    return found_peaks;
+                },
+                [&]( const core::realtime_frame_info& info, field_t* found_peaks ) {
+                    // frames lost to overruns are never submitted, so
+                    // the pair is identified by the id given to submit()
+                    const size_t i = info.id;
+                    if ( !found_peaks )
+                    {
+                        logger::warn("dropped frame {}: {}", i, input_files[2*i]);
+                        return;
+                    }
+
+                    logger::debug("frame {}: {}, {}us",
+                                  i,
+                                  core::to_string( info.quality ),
+                                  std::chrono::duration<double, std::micro>( info.latency ).count());
+                    write_field( i, std::move( *found_peaks ) );
+                },
+                options );
+
+            const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>( 1.0/frame_rate ) );
+            auto next = start;
+            for ( size_t i=0; i<pair_count; ++i, next += period )
+            {
+                std::this_thread::sleep_until( next );
+                image_pair_t* frame = pipeline.try_acquire();
+                if ( !frame )
+                {
+                    logger::warn("overrun: no free slot for frame {}", i);
+                    continue;
+                }
+
+                for ( size_t j=0; j<2; ++j )
+                    std::copy( std::cbegin( source[i][j] ), std::cend( source[i][j] ), std::begin( (*frame)[j] ) );
+                pipeline.submit( i );
+            }
+            pipeline.close();
+
+            const auto rt = pipeline.stats();
+            using ms_t = std::chrono::duration<double, std::milli>;
+            logger::info("realtime: {} submitted, {} overrun(s), {} full, {} without sub-pixel fit, {} coarse, {} dropped, {} late",
+                         rt.submitted, rt.overruns,
+                         rt.quality_counts[0], rt.quality_counts[1], rt.quality_counts[2], rt.quality_counts[3],
+                         rt.late);
+            logger::info("realtime latency: p50 {}ms, p90 {}ms, p99 {}ms, max {}ms",
+                         fmt::format( "{:.3f}", ms_t{ rt.p50 }.count() ),
+                         fmt::format( "{:.3f}", ms_t{ rt.p90 }.count() ),
+                         fmt::format( "{:.3f}", ms_t{ rt.p99 }.count() ),
+                         fmt::format( "{:.3f}", ms_t{ rt.max }.count() ));
+
+            stats.count = rt.submitted;
+            stats.total_time = stats.process_time = std::chrono::steady_clock::now() - start;
+        }
+        else if ( process_count > 1 )
+        {
+            // worker processes each take a contiguous shard of the pairs
+            // and write vector fields into a shared, frame indexed
+            // file; completed frames are passed to the writer in order.
+            // The first pair is loaded up front to size the file
+            const auto start = std::chrono::steady_clock::now();
+            const auto first = load_pair( 0 );
+            const auto shape = core::grid_shape( core::generate_cartesian_grid( first[0].size(), ia, overlap ) );
+            if ( series_output.empty() )
+                series_output = input_files[0] + ".vfs";
+
+            core::vector_field_series::create( series_output, pair_count, shape, parameters );
+            core::vector_field_series results( series_output, core::mapped_file::mode::READ_WRITE );
+
+            size_t next_write = 0;
+            auto write_completed = [&]() {
+                for ( ; next_write < pair_count && results.written( next_write ); ++next_write )
+                    write_field( next_write, results.read( next_write ) );
+            };
+
+            size_t reported = 0;
+            core::sharded_batch_options options;
+            options.process_count = process_count;
+
+            std::unique_ptr<core::vector_field_series> series;
+            core::run_sharded(
+                pair_count,
+                [&series, &load_pair, &process_pair]( size_t i ) {
+                    const auto images = load_pair( i );
+                    series->write( i, process_pair( images[0], images[1] ) );
+                },
+                options,
+                [&]( size_t completed, size_t total ) {
+                    write_completed();
+                    if ( completed != reported )
+                        logger::info("completed {}/{} image pair(s)", completed, total);
+                    reported = completed;
+                },
+                [&series, &series_output, &create_executor]( size_t, size_t, size_t ) {
+                    // runs in each worker: threads aren't inherited
+                    create_executor();
+                    series = std::make_unique<core::vector_field_series>( series_output, core::mapped_file::mode::READ_WRITE );
                 } );
-            i += chunk_size_;
+
+            write_completed();
+            stats.count = pair_count;
+            stats.total_time = stats.process_time = std::chrono::steady_clock::now() - start;
         }
+        else if ( execution == "batch" )
+        {
+            create_executor();
+
+            // several pairs are processed at once, limited by the memory
+            // budget, and their grid chunks share the executor's
+            // workers; the first pair is loaded up front to size the
+            // limit
+            std::optional<image_pair_t> first{ load_pair( 0 ) };
+            core::batch_options options;
+            options.max_in_flight = core::batch_in_flight_limit(
+                memory_budget_mb*1024*1024,
+                2*(*first)[0].pixel_count()*sizeof(core::g_16),
+                executor->thread_count() );
+            logger::info("batch: up to {} image pair(s) in flight", options.max_in_flight);
+
+            auto batch_stats = core::run_batch(
+                *executor,
+                pair_count,
+                [&first, &load_pair]( size_t i ) -> image_pair_t {
+                    if ( i == 0 )
+                        return std::move( *std::exchange( first, std::nullopt ) );
+                    return load_pair( i );
+                },
+                [&process_pair]( size_t, image_pair_t&& images ) { return process_pair( images[0], images[1] ); },
+                write_field,
+                options );
+
+            stats.count = batch_stats.count;
+            stats.load_time = batch_stats.load_time;
+            stats.process_time = batch_stats.process_time;
+            stats.write_time = batch_stats.write_time;
+            stats.total_time = batch_stats.total_time;
+        }
+        else
+        {
+            create_executor();
+            stats = core::run_pipeline(
+                pair_count,
+                load_pair,
+                [&process_pair]( size_t, image_pair_t&& images ) { return process_pair( images[0], images[1] ); },
+                write_field );
+        }
+
+        writer->close();
+    }
+    catch ( std::exception& e )
+    {
+        logger::error("failed to process: {}", e.what());
+        return 1;
     }
 
-    const auto t2 = std::chrono::high_resolution_clock::now();
-    const std::chrono::duration<double, std::micro> total_us = t2 - t1;
+    using us_t = std::chrono::duration<double, std::micro>;
+    const us_t process_us = stats.process_time;
     logger::info(
         "processing time: {}us, {}us per interrogation area",
-        total_us,
-        total_us/found_peaks.size());
-
-    // dump output
-    for ( const auto& pv : found_peaks )
-        std::cout << pv.xy[0] << ", " << pv.xy[1] << ", " << pv.vxy[0] << ", " << pv.vxy[1] << ", " << pv.sn << "\n";
-
+        process_us,
+        process_us/std::max<size_t>(ia_count, 1));
+    logger::info(
+        "total time: {}us (load: {}us, write: {}us)",
+        us_t{ stats.total_time },
+        us_t{ stats.load_time },
+        us_t{ stats.write_time });
 
     return 0;
 };
-
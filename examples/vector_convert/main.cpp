@@ -0,0 +1,84 @@
+
+// std
+#include <iostream>
+
+// utils
+#include <cxxopts.hpp>
+
+// openpiv
+#include "core/log.h"
+#include "core/stream_utils.h"
+#include "io/vector_field_io.h"
+
+using namespace openpiv;
+namespace logger = openpiv::core::logger;
+
+int main( int argc, char* argv[] )
+{
+    // log to stderr, up to INFO
+    logger::Logger::instance().add_sink(
+        [](logger::Level l, const std::string& m) -> bool
+        {
+            if ( l > logger::Level::INFO )
+                return true;
+
+            std::cerr << m << "\n";
+            return true;
+        });
+
+    // get arguments
+    cxxopts::Options options(argv[0]);
+    options
+        .positional_help("[input files]")
+        .show_positional_help();
+
+    std::vector<std::string> input_files;
+
+    try
+    {
+        options
+            .add_options()
+            ("h, help", "help", cxxopts::value<bool>())
+            ("i, input", "binary vector field files", cxxopts::value<std::vector<std::string>>(input_files));
+
+        options.parse_positional({"input"});
+        auto result = options.parse(argc, argv);
+
+        if (result.count("help"))
+        {
+            std::cout << options.help({""}) << "\n";
+            return 0;
+        }
+
+        if (input_files.empty())
+        {
+            logger::error("require one or more input files");
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        logger::error("error parsing options: {}", e.what());
+        return 1;
+    }
+
+    // convert each file to text on stdout; separate multiple files
+    // with a comment line as examples/process does
+    for ( const auto& input_file : input_files )
+    {
+        try
+        {
+            if ( input_files.size() > 1 )
+                std::cout << "# " << input_file << "\n";
+
+            core::convert_vector_field_to_text( input_file, std::cout );
+        }
+        catch ( const std::exception& e )
+        {
+            logger::error("failed to convert {}: {}", input_file, e.what());
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -12,9 +12,11 @@
 // local
 #include "algos/fft_common.h"
 #include "core/enum_helper.h"
+#include "core/cplanar_image.h"
 #include "core/exception_builder.h"
 #include "core/image.h"
 #include "core/image_utils.h"
+#include "core/memory_resource.h"
 #include "core/pixel_types.h"
 #include "core/util.h"
 
@@ -62,8 +64,14 @@ namespace openpiv::algos {
                     return data;
             }
 
+            // the cache outlives any scoped_arena of the caller
+            const scoped_memory_resource heap{ std::pmr::new_delete_resource() };
             data_t data;
             size_t N{ maximal_size( size_ ).width() };
+            // rows start on a cache line and power-of-two widths are
+            // padded to avoid 4K aliasing between rows
+            data.output.set_layout( image_layout::aligned() );
+            data.temp.set_layout( image_layout::aligned() );
             data.output.resize( size_ );
             data.temp.resize( transpose(size_) );
             data.fft_buffer.resize( N );
@@ -97,25 +105,29 @@ namespace openpiv::algos {
                     << "image size is different from expected: " << input.size() << ", " << size_;
             }
 
-            // copy data, converting to complex
-            cache().output = input;
-            cache().temp.resize( input.size() );
-
-            // iterate over rows first
-            for ( uint32_t h = 0; h < cache().output.height(); ++h )
-                fft( cache().output.line(h), cache().output.width(), d );
-
-            // transpose output -> temp
-            transpose( cache().output, cache().temp );
-
-            // now do columns
-            for ( uint32_t h = 0; h < cache().temp.height(); ++h )
-                fft( cache().temp.line(h), cache().temp.width(), d );
+            // convert each row to complex as it is loaded; input may
+            // be a view onto a larger image
+            return transform_rows(
+                [&input]( size_t h, c_f* out ) { detail::load_line( input, h, out ); },
+                d );
+        }
 
-            // flip back: temp -> output
-            transpose( cache().temp, cache().output );
+        /// Perform a 2-D FFT of a planar complex image into \a output,
+        /// which is resized as required
+        void transform( const cplanar_image<double>& input,
+                        cplanar_image<double>& output,
+                        direction d = direction::FORWARD ) const
+        {
+            DECLARE_ENTRY_EXIT
+            if ( input.size() != size_ )
+            {
+                exception_builder< std::runtime_error >()
+                    << "image size is different from expected: " << input.size() << ", " << size_;
+            }
 
-            return cache().output;
+            output = transform_rows(
+                [&input]( size_t h, c_f* out ) { detail::load_line( input.real(), input.imag(), h, out ); },
+                d );
         }
 
         /// Perform a 2-D FFT of two real images; will produce two
@@ -140,13 +152,14 @@ namespace openpiv::algos {
                     << ", " << size_;
             }
 
-            // copy data to (real, imag), converting to complex
-            cache().output = join_from_channels(a, b);
-            cache().temp.resize( cache().output.size() );
+            cache().temp.resize( transpose(size_) );
 
-            // iterate over rows first
+            // iterate over rows first, loading each row as (real, imag)
             for ( uint32_t h = 0; h < cache().output.height(); ++h )
+            {
+                detail::load_line( a, b, h, cache().output.line(h) );
                 fft( cache().output.line(h), cache().output.width(), d );
+            }
 
             // transpose output -> temp
             transpose( cache().output, cache().temp );
@@ -182,12 +195,14 @@ namespace openpiv::algos {
                 }
             }
 
-            return { out_a, out_b };
+            return { std::move( out_a ), std::move( out_b ) };
         }
 
+        /// cross-correlate \a a and \a b; integral pixels are converted
+        /// as each window is loaded and produce a double result
         template < template <typename> class ImageT,
                    typename ContainedT,
-                   typename ValueT = typename ContainedT::value_t,
+                   typename ValueT = correlation_value_t<ContainedT>,
                    typename OutT = image<g<ValueT>>,
                    typename = typename std::enable_if_t< is_imagetype_v<ImageT<ContainedT>> >
                    >
@@ -207,7 +222,7 @@ namespace openpiv::algos {
 
         template < template <typename> class ImageT,
                    typename ContainedT,
-                   typename ValueT = typename ContainedT::value_t,
+                   typename ValueT = correlation_value_t<ContainedT>,
                    typename OutT = image<g<ValueT>>,
                    typename = typename std::enable_if_t<
                        is_imagetype_v<ImageT<ContainedT>> &&
@@ -242,6 +257,32 @@ namespace openpiv::algos {
         }
 
     private:
+        /// 2-D FFT of the rows produced by \a load(h, out)
+        template < typename LoadF >
+        const cf_image& transform_rows( LoadF&& load, direction d ) const
+        {
+            cache().temp.resize( transpose(size_) );
+
+            // iterate over rows first
+            for ( uint32_t h = 0; h < cache().output.height(); ++h )
+            {
+                load( h, cache().output.line(h) );
+                fft( cache().output.line(h), cache().output.width(), d );
+            }
+
+            // transpose output -> temp
+            transpose( cache().output, cache().temp );
+
+            // now do columns
+            for ( uint32_t h = 0; h < cache().temp.height(); ++h )
+                fft( cache().temp.line(h), cache().temp.width(), d );
+
+            // flip back: temp -> output
+            transpose( cache().temp, cache().output );
+
+            return cache().output;
+        }
+
         void fft_inner( c_f* in, c_f* out, const c_f* scaling, size_t n, size_t step ) const
         {
             DECLARE_ENTRY_EXIT
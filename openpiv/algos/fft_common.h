@@ -1,8 +1,13 @@
 
 #pragma once
 
+// std
+#include <cstdint>
+#include <type_traits>
+
 // local
 #include "core/enum_helper.h"
+#include "core/pixel_types.h"
 
 namespace openpiv::algos {
 
@@ -16,4 +21,45 @@ namespace openpiv::algos {
             { direction::REVERSE, "reverse" }
         } )
 
+    /// value type in which windows of \a PixelT are correlated:
+    /// floating point pixels keep their precision, integral pixels
+    /// (e.g. 8- or 16-bit camera frames) are converted to double as
+    /// each window is loaded for the first FFT pass, so full frames
+    /// needn't be converted up front
+    template < typename PixelT >
+    using correlation_value_t =
+        std::conditional_t< std::is_floating_point_v<typename PixelT::value_t>,
+                            typename PixelT::value_t,
+                            double >;
+
+    namespace detail {
+
+        /// convert row \a h of \a in to \a out, which must hold at
+        /// least in.width() elements; works equally on images and
+        /// strided image views so windows need not be extracted
+        /// before transforming
+        template < typename ImageT, typename OutT >
+        inline void load_line( const ImageT& in, size_t h, OutT* out )
+        {
+            const auto* line = in.line( h );
+            for ( uint32_t w=0; w<in.width(); ++w )
+                core::convert( line[w], out[w] );
+        }
+
+        /// load row \a h of \a a and \a b as the real and imaginary
+        /// parts of \a out
+        template < typename ImageT, typename T >
+        inline void load_line( const ImageT& a, const ImageT& b, size_t h, core::complex<T>* out )
+        {
+            const auto* line_a = a.line( h );
+            const auto* line_b = b.line( h );
+            for ( uint32_t w=0; w<a.width(); ++w )
+            {
+                out[w].real = line_a[w];
+                out[w].imag = line_b[w];
+            }
+        }
+
+    }
+
 }
@@ -17,9 +17,11 @@
 // local
 #include "algos/fft_common.h"
 #include "core/enum_helper.h"
+#include "core/cplanar_image.h"
 #include "core/exception_builder.h"
 #include "core/image.h"
 #include "core/image_utils.h"
+#include "core/memory_resource.h"
 #include "core/pixel_types.h"
 #include "core/util.h"
 
@@ -41,6 +43,7 @@ namespace openpiv::algos {
             cf_image output;
             std::vector< c_f > fft_buffer;
             cf_image temp;
+            gf_image real_input;
         };
 
         /// helpers to allow TLS for intermediate storage
@@ -63,8 +66,15 @@ namespace openpiv::algos {
                     return data;
             }
 
+            // the cache outlives any scoped_arena of the caller
+            const scoped_memory_resource heap{ std::pmr::new_delete_resource() };
             data_t data;
             size_t N{ maximal_size( size_ ).width() };
+            // rows start on a cache line and power-of-two widths are
+            // padded to avoid 4K aliasing between rows
+            data.output.set_layout( image_layout::aligned() );
+            data.temp.set_layout( image_layout::aligned() );
+            data.real_input.set_layout( image_layout::aligned() );
             data.output.resize( size_ );
             data.temp.resize( transpose(size_) );
             data.fft_buffer.resize( N );
@@ -96,30 +106,57 @@ namespace openpiv::algos {
                     << "image size is different from expected: " << input.size() << ", " << size_;
             }
 
-            using value_t = typename ContainedT::value_t;
-
-            // copy data, converting to complex
-            cache().temp = input;
             cache().output.resize( input.size() );
 
-            const pfft::shape_t shape = {size_.width(), size_.height()};
-            const auto [stride_x, stride_y] = cache().temp.stride();
-            const pfft::stride_t stride = {static_cast<long>(stride_x), static_cast<long>(stride_y)};
+            constexpr auto stride_lambda = [](auto& im) -> pfft::stride_t
+                {
+                    const auto [stride_x, stride_y] = im.stride();
+                    return {static_cast<long>(stride_x), static_cast<long>(stride_y)};
+                };
 
-            // can reinterpret core::complex to std::complex because core::complex is packed and
-            // std::complex is also packed and makes guarantees about accessibility through array
-            // access
-            pfft::c2c<value_t>(
-                shape,
-                stride,
-                stride,                  // input and output strides should be the same
-                { 0, 1 },                // axes
-                d == direction::FORWARD, // forward
-                reinterpret_cast<const std::complex<value_t>*>(cache().temp.data()),
-                reinterpret_cast<std::complex<value_t>*>(cache().output.data()),
-                1.0 );
+            // complex input (image or view) is read in place using its
+            // strides; anything else is converted to complex row by row
+            const c_f* in = nullptr;
+            pfft::stride_t in_stride;
+            if constexpr ( std::is_same_v<ContainedT, c_f> )
+            {
+                in = input.data();
+                in_stride = stride_lambda(input);
+            }
+            else
+            {
+                cache().temp.resize( input.size() );
+                for ( uint32_t h = 0; h < input.height(); ++h )
+                    detail::load_line( input, h, cache().temp.line(h) );
 
-            return cache().output;
+                in = cache().temp.data();
+                in_stride = stride_lambda(cache().temp);
+            }
+
+            return c2c<double>( in, in_stride, d );
+        }
+
+        /// Perform a 2-D FFT of a planar complex image into \a output,
+        /// which is resized as required; the planes are interleaved
+        /// row by row as PocketFFT requires
+        void transform( const cplanar_image<double>& input,
+                        cplanar_image<double>& output,
+                        direction d = direction::FORWARD ) const
+        {
+            DECLARE_ENTRY_EXIT
+            if ( input.size() != size_ )
+            {
+                exception_builder< std::runtime_error >()
+                    << "image size is different from expected: " << input.size() << ", " << size_;
+            }
+
+            cache().output.resize( input.size() );
+            cache().temp.resize( input.size() );
+            for ( uint32_t h = 0; h < input.height(); ++h )
+                detail::load_line( input.real(), input.imag(), h, cache().temp.line(h) );
+
+            const auto [stride_x, stride_y] = cache().temp.stride();
+            output = c2c<double>( cache().temp.data(), {static_cast<long>(stride_x), static_cast<long>(stride_y)}, d );
         }
 
         /// Perform a 2-D FFT of two real images; will produce two
@@ -144,8 +181,6 @@ namespace openpiv::algos {
                     << ", " << size_;
             }
 
-            using value_t = typename ContainedT::value_t;
-
             cache().output.resize( a.size() );
             cache().temp.resize( b.size() );
 
@@ -159,30 +194,43 @@ namespace openpiv::algos {
                 };
 
             const pfft::shape_t shape = {size_.width(), size_.height()};
-            const pfft::stride_t in_a_stride = stride_lambda(a);
-            const pfft::stride_t in_b_stride = stride_lambda(b);
-            const pfft::stride_t out_a_stride = stride_lambda(out_a);
-            const pfft::stride_t out_b_stride = stride_lambda(out_b);
 
-            pfft::r2c<value_t>(
-                shape,
-                in_a_stride,
-                out_a_stride,
-                { 0, 1 },                // axes
-                d == direction::FORWARD, // forward
-                reinterpret_cast<const value_t*>(a.data()),
-                reinterpret_cast<std::complex<value_t>*>(out_a.data()),
-                1.0 );
+            // double input (image or view) is read in place using its
+            // strides; other pixel types, e.g. 16-bit camera frames,
+            // are converted row by row into a single window buffer
+            auto r2c = [&]( const ImageT<ContainedT>& in, cf_image& out )
+                {
+                    const double* data = nullptr;
+                    pfft::stride_t in_stride;
+                    if constexpr ( std::is_same_v<typename ContainedT::value_t, double> )
+                    {
+                        data = reinterpret_cast<const double*>(in.data());
+                        in_stride = stride_lambda(in);
+                    }
+                    else
+                    {
+                        auto& buffer = cache().real_input;
+                        buffer.resize( in.size() );
+                        for ( uint32_t h = 0; h < in.height(); ++h )
+                            detail::load_line( in, h, buffer.line(h) );
+
+                        data = reinterpret_cast<const double*>(buffer.data());
+                        in_stride = stride_lambda(buffer);
+                    }
+
+                    pfft::r2c<double>(
+                        shape,
+                        in_stride,
+                        stride_lambda(out),
+                        { 0, 1 },                // axes
+                        d == direction::FORWARD, // forward
+                        data,
+                        reinterpret_cast<std::complex<double>*>(out.data()),
+                        1.0 );
+                };
 
-            pfft::r2c<value_t>(
-                shape,
-                in_b_stride,
-                out_b_stride,
-                { 0, 1 },                // axes
-                d == direction::FORWARD, // forward
-                reinterpret_cast<const value_t*>(b.data()),
-                reinterpret_cast<std::complex<value_t>*>(out_b.data()),
-                1.0 );
+            r2c( a, out_a );
+            r2c( b, out_b );
 
             return { out_a, out_b };
         }
@@ -233,9 +281,11 @@ namespace openpiv::algos {
             return out;
         }
 
+        /// cross-correlate \a a and \a b; integral pixels are converted
+        /// as each window is loaded and produce a double result
         template < template <typename> class ImageT,
                    typename ContainedT,
-                   typename ValueT = typename ContainedT::value_t,
+                   typename ValueT = correlation_value_t<ContainedT>,
                    typename OutT = image<g<ValueT>>,
                    typename = typename std::enable_if_t< is_imagetype_v<ImageT<ContainedT>> >
                    >
@@ -255,7 +305,7 @@ namespace openpiv::algos {
 
         template < template <typename> class ImageT,
                    typename ContainedT,
-                   typename ValueT = typename ContainedT::value_t,
+                   typename ValueT = correlation_value_t<ContainedT>,
                    typename OutT = image<g<ValueT>>,
                    typename = typename std::enable_if_t<
                        is_imagetype_v<ImageT<ContainedT>> &&
@@ -288,6 +338,30 @@ namespace openpiv::algos {
 
             return cache().output;
         }
+
+    private:
+        /// 2-D complex FFT of \a in into cache().output
+        template < typename value_t >
+        const cf_image& c2c( const c_f* in, const pfft::stride_t& in_stride, direction d ) const
+        {
+            const auto [stride_x, stride_y] = cache().output.stride();
+            const pfft::shape_t shape = {size_.width(), size_.height()};
+
+            // can reinterpret core::complex to std::complex because core::complex is packed and
+            // std::complex is also packed and makes guarantees about accessibility through array
+            // access
+            pfft::c2c<value_t>(
+                shape,
+                in_stride,
+                {static_cast<long>(stride_x), static_cast<long>(stride_y)},
+                { 0, 1 },                // axes
+                d == direction::FORWARD, // forward
+                reinterpret_cast<const std::complex<value_t>*>(in),
+                reinterpret_cast<std::complex<value_t>*>(cache().output.data()),
+                1.0 );
+
+            return cache().output;
+        }
     };
 
 }
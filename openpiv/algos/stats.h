@@ -20,15 +20,13 @@ namespace openpiv::algos {
     find_image_range( const ImageT<ContainedT>& im )
     {
         ContainedT min, max;
-        auto p = std::cbegin( im );
-        auto e = std::cend( im );
-        min = max = *p++;
-        while ( p != e )
-        {
-            min = *p < min ? *p : min;
-            max = *p > max ? *p : max;
-            ++p;
-        }
+        min = max = im[ {0, 0} ];
+        for ( const auto row : im.rows() )
+            for ( const auto& p : row )
+            {
+                min = p < min ? p : min;
+                max = p > max ? p : max;
+            }
 
         return std::make_tuple( min, max );
     }
@@ -0,0 +1,90 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+// local
+#include "core/memory_resource.h"
+
+namespace openpiv::core {
+
+    /// allocator returning storage aligned to \a Alignment bytes from
+    /// a polymorphic memory resource; the default of 64 matches the
+    /// cache line size and the widest common SIMD registers.
+    ///
+    /// A default constructed allocator uses the calling thread's
+    /// \sa thread_memory_resource. As for std::pmr::polymorphic_allocator
+    /// the resource is not propagated on copy, copy assignment or
+    /// move assignment: a container keeps the resource it was created
+    /// with, and a copy uses the resource current where it is made.
+    template < typename T, size_t Alignment = 64 >
+    class aligned_allocator
+    {
+        static_assert( (Alignment & (Alignment - 1)) == 0, "alignment must be a power of 2" );
+        static_assert( Alignment >= alignof(T), "alignment must be at least that of T" );
+
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+        static constexpr size_t alignment = Alignment;
+
+        template < typename U >
+        struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+        aligned_allocator() noexcept
+            : resource_( thread_memory_resource() )
+        {}
+
+        explicit aligned_allocator( std::pmr::memory_resource* resource ) noexcept
+            : resource_( resource )
+        {}
+
+        template < typename U >
+        aligned_allocator( const aligned_allocator<U, Alignment>& rhs ) noexcept
+            : resource_( rhs.resource() )
+        {}
+
+        T* allocate( size_t n )
+        {
+            if ( n > std::numeric_limits<size_t>::max()/sizeof(T) )
+                throw std::bad_array_new_length();
+
+            return static_cast<T*>( resource_->allocate( n*sizeof(T), Alignment ) );
+        }
+
+        void deallocate( T* p, size_t n ) noexcept
+        {
+            resource_->deallocate( p, n*sizeof(T), Alignment );
+        }
+
+        /// copies of a container use the current thread's resource
+        aligned_allocator select_on_container_copy_construction() const
+        {
+            return {};
+        }
+
+        std::pmr::memory_resource* resource() const { return resource_; }
+
+    private:
+        std::pmr::memory_resource* resource_;
+    };
+
+    template < typename T, typename U, size_t Alignment >
+    bool operator==( const aligned_allocator<T, Alignment>& lhs, const aligned_allocator<U, Alignment>& rhs ) noexcept
+    {
+        return lhs.resource() == rhs.resource() || lhs.resource()->is_equal( *rhs.resource() );
+    }
+
+    template < typename T, typename U, size_t Alignment >
+    bool operator!=( const aligned_allocator<T, Alignment>& lhs, const aligned_allocator<U, Alignment>& rhs ) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+// openpiv
+#include "core/executor.h"
+
+namespace openpiv::core {
+
+    /// options for \sa run_batch
+    struct batch_options
+    {
+        /// maximum number of items loaded at once; zero allows one
+        /// per thread, including the calling thread
+        size_t max_in_flight = 0;
+    };
+
+    /// timing information gathered from a batch run; load, process
+    /// and write times are summed over all threads
+    struct batch_stats
+    {
+        using duration_t = std::chrono::duration<double>;
+
+        size_t count = 0;
+        size_t in_flight = 0;           ///< number of items processed concurrently
+        duration_t load_time{};
+        duration_t process_time{};
+        duration_t write_time{};
+        duration_t total_time{};
+    };
+
+    /// \returns the number of items of \a bytes_per_item that may be
+    /// in flight within \a memory_budget bytes, between one and
+    /// \a thread_count + 1; a zero budget or item size imposes no
+    /// memory limit
+    inline size_t batch_in_flight_limit( size_t memory_budget, size_t bytes_per_item, size_t thread_count )
+    {
+        size_t limit = thread_count + 1;
+        if ( memory_budget > 0 && bytes_per_item > 0 )
+            limit = std::min( limit, memory_budget / bytes_per_item );
+
+        return std::max<size_t>( limit, 1 );
+    }
+
+    /// process the items [0, count) on \a executor with up to
+    /// \sa batch_options::max_in_flight items loaded at once:
+    ///
+    /// - load is called as `L load(size_t i)`
+    /// - process is called as `P process(size_t i, L&&)`
+    /// - write is called as `void write(size_t i, P&&)`
+    ///
+    /// Each in-flight item is handled by one task on \a executor which
+    /// loads, processes and releases items in turn. process is
+    /// expected to split its own work into blocks using the same
+    /// executor (e.g. \sa parallel_for over an interrogation grid);
+    /// blocks of all in-flight items then share the worker threads, so
+    /// many small items keep all cores busy through item-level
+    /// parallelism and a few large items through block-level
+    /// parallelism, while memory stays bounded by the in-flight limit.
+    ///
+    /// load and process are called concurrently for different items;
+    /// write is called for one item at a time, in item order. Results
+    /// waiting for an earlier item to complete are held until it is
+    /// written.
+    ///
+    /// If any function throws, remaining items are skipped and the
+    /// first exception is rethrown on the calling thread.
+    template < typename LoadF,
+               typename ProcessF,
+               typename WriteF,
+               typename LoadedT = std::invoke_result_t<LoadF, size_t>,
+               typename ProcessedT = std::invoke_result_t<ProcessF, size_t, LoadedT&&>,
+               typename = std::enable_if_t< std::is_invocable_v<WriteF, size_t, ProcessedT&&> >
+               >
+    batch_stats run_batch( work_stealing_executor& executor,
+                           size_t count,
+                           LoadF load,
+                           ProcessF process,
+                           WriteF write,
+                           const batch_options& options = {} )
+    {
+        using clock = std::chrono::steady_clock;
+
+        batch_stats stats;
+        stats.count = count;
+        stats.in_flight = std::min( count, options.max_in_flight > 0 ? options.max_in_flight : executor.thread_count() + 1 );
+        if ( count == 0 )
+            return stats;
+
+        std::atomic<size_t> next{ 0 };
+        std::atomic<bool> failed{ false };
+        std::atomic<clock::rep> load_ticks{ 0 };
+        std::atomic<clock::rep> process_ticks{ 0 };
+
+        // results are written in order; out of order results wait here
+        std::mutex write_mutex;
+        std::map<size_t, ProcessedT> pending;
+        size_t next_write = 0;
+
+        auto lane =
+            [&]( size_t )
+            {
+                for ( size_t i = next++; i < count && !failed; i = next++ )
+                {
+                    try
+                    {
+                        auto t = clock::now();
+                        auto loaded = load( i );
+                        auto t_loaded = clock::now();
+                        load_ticks += (t_loaded - t).count();
+
+                        // loaded is released when process returns
+                        auto result = process( i, std::move( loaded ) );
+                        process_ticks += (clock::now() - t_loaded).count();
+
+                        std::unique_lock<std::mutex> lock( write_mutex );
+                        pending.emplace( i, std::move( result ) );
+                        for ( auto it = pending.begin(); it != pending.end() && it->first == next_write; it = pending.begin() )
+                        {
+                            t = clock::now();
+                            write( it->first, std::move( it->second ) );
+                            stats.write_time += clock::now() - t;
+
+                            pending.erase( it );
+                            ++next_write;
+                        }
+                    }
+                    catch (...)
+                    {
+                        failed = true;
+                        throw;
+                    }
+                }
+            };
+
+        const auto start = clock::now();
+        executor.parallel_for( 0, stats.in_flight, lane, 1 );
+
+        stats.load_time = clock::duration( load_ticks.load() );
+        stats.process_time = clock::duration( process_ticks.load() );
+        stats.total_time = clock::now() - start;
+
+        return stats;
+    }
+
+}
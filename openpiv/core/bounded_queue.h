@@ -0,0 +1,110 @@
+#pragma once
+
+// std
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// openpiv
+#include "core/exception_builder.h"
+
+namespace openpiv::core {
+
+    /// simple blocking FIFO queue with a fixed capacity; used to join
+    /// the stages of a processing pipeline such that a fast producer
+    /// is held back by a slow consumer (backpressure).
+    ///
+    /// Once closed, push() will fail and pop() will drain any remaining
+    /// entries before returning an empty optional.
+    ///
+    /// This class is thread-safe
+    template <typename T>
+    class bounded_queue
+    {
+    public:
+        using value_type = T;
+
+        explicit bounded_queue( size_t capacity )
+            : capacity_( capacity )
+        {
+            if ( capacity_ == 0 )
+                exception_builder<std::runtime_error>() << "bounded_queue capacity must be non-zero";
+        }
+
+        bounded_queue( const bounded_queue& ) = delete;
+        bounded_queue& operator=( const bounded_queue& ) = delete;
+
+        /// push a value, blocking whilst the queue is full;
+        /// \returns false if the queue has been closed
+        bool push( T v )
+        {
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                not_full_.wait( lock, [this](){ return closed_ || entries_.size() < capacity_; } );
+                if ( closed_ )
+                    return false;
+
+                entries_.emplace_back( std::move(v) );
+            }
+            not_empty_.notify_one();
+
+            return true;
+        }
+
+        /// pop a value, blocking whilst the queue is empty; \returns
+        /// an empty optional if the queue is closed and drained
+        std::optional<T> pop()
+        {
+            std::optional<T> result;
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                not_empty_.wait( lock, [this](){ return closed_ || !entries_.empty(); } );
+                if ( entries_.empty() )
+                    return result;
+
+                result.emplace( std::move(entries_.front()) );
+                entries_.pop_front();
+            }
+            not_full_.notify_one();
+
+            return result;
+        }
+
+        /// close the queue, waking any blocked producers and consumers
+        void close()
+        {
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                closed_ = true;
+            }
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+        bool closed() const
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            return closed_;
+        }
+
+        size_t size() const
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            return entries_.size();
+        }
+
+        constexpr size_t capacity() const { return capacity_; }
+
+    private:
+        const size_t capacity_;
+        mutable std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        std::deque<T> entries_;
+        bool closed_ = false;
+    };
+
+}
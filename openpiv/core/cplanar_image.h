@@ -0,0 +1,281 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// local
+#include "core/exception_builder.h"
+#include "core/image.h"
+#include "core/image_expression.h"
+#include "core/image_layout.h"
+#include "core/image_type_traits.h"
+#include "core/pixel_types.h"
+#include "core/rect.h"
+#include "core/size.h"
+
+namespace openpiv::core {
+
+    /// complex image stored as separate, contiguous planes of real and
+    /// imaginary parts (structure of arrays) rather than as
+    /// interleaved \sa complex pixels.
+    ///
+    /// Pointwise complex arithmetic on planar data maps directly onto
+    /// SIMD lanes without the shuffles needed to separate interleaved
+    /// real and imaginary parts, and each part is itself an ordinary
+    /// image<g<T>>. cplanar_image takes part in image expressions as a
+    /// source of complex<T> values and may be assigned from any
+    /// complex expression, e.g.
+    ///
+    ///   cplanar_image<double> product = b * conj( a );
+    ///
+    /// By default planes use \sa image_layout::aligned() rows.
+    template < typename T >
+    class cplanar_image
+    {
+    public:
+        using value_t = T;
+        using pixel_t = complex<T>;
+        using plane_t = image<g<T>>;
+
+        cplanar_image() = default;
+        cplanar_image( const cplanar_image& ) = default;
+        cplanar_image( cplanar_image&& ) = default;
+        cplanar_image& operator=( const cplanar_image& ) = default;
+        cplanar_image& operator=( cplanar_image&& ) = default;
+
+        /// zero-filled image
+        explicit cplanar_image( const core::size& s, const image_layout& layout = image_layout::aligned() )
+            : real_( s, g<T>{}, layout )
+            , imag_( s, g<T>{}, layout )
+        {}
+
+        cplanar_image( uint32_t w, uint32_t h )
+            : cplanar_image( core::size{ w, h } )
+        {}
+
+        /// join existing real and imaginary planes, which must have the
+        /// same size
+        cplanar_image( plane_t real, plane_t imag )
+            : real_( std::move( real ) )
+            , imag_( std::move( imag ) )
+        {
+            if ( real_.size() != imag_.size() )
+                exception_builder<std::runtime_error>()
+                    << "real and imaginary planes must have matching dimensions: "
+                    << real_.size() << ", " << imag_.size();
+        }
+
+        /// conversion from interleaved complex images, views or
+        /// complex expressions
+        template < typename E,
+                   typename = typename std::enable_if_t<
+                       is_ie_inputtype_v<E> && std::is_same_v<typename is_ie_inputtype<E>::type, pixel_t> > >
+        explicit cplanar_image( const E& e )
+            : cplanar_image( e.size() )
+        {
+            *this = e;
+        }
+
+        /// evaluate \a e row by row into the planes; \a e may read the
+        /// pixel of this image being written
+        template < typename E,
+                   typename = typename std::enable_if_t<
+                       is_ie_inputtype_v<E> && std::is_same_v<typename is_ie_inputtype<E>::type, pixel_t> > >
+        cplanar_image& operator=( const E& e )
+        {
+            resize( e.size() );
+
+            const typename is_ie_inputtype<E>::node_type node{ e };
+            const size_t w = width();
+            for ( uint32_t y=0; y<height(); ++y )
+            {
+                g<T>* re = real_.line( y );
+                g<T>* im = imag_.line( y );
+                const auto src = node.row( y );
+#if defined(__clang__)
+                #pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+                #pragma GCC ivdep
+#endif
+                for ( size_t x=0; x<w; ++x )
+                {
+                    const pixel_t v = src[x];
+                    re[x].v = v.real;
+                    im[x].v = v.imag;
+                }
+            }
+
+            return *this;
+        }
+
+        /// resize both planes; this is destructive
+        void resize( const core::size& s )
+        {
+            real_.resize( s );
+            imag_.resize( s );
+        }
+
+        /// \returns an interleaved copy
+        image<pixel_t> interleaved() const
+        {
+            image<pixel_t> result{ size() };
+            for ( uint32_t y=0; y<height(); ++y )
+            {
+                pixel_t* out = result.line( y );
+                const g<T>* re = real_.line( y );
+                const g<T>* im = imag_.line( y );
+                for ( uint32_t x=0; x<width(); ++x )
+                    out[x] = pixel_t{ re[x].v, im[x].v };
+            }
+
+            return result;
+        }
+
+        /// planes
+        inline plane_t& real() { return real_; }
+        inline const plane_t& real() const { return real_; }
+        inline plane_t& imag() { return imag_; }
+        inline const plane_t& imag() const { return imag_; }
+
+        /// pixel value at \a xy
+        inline pixel_t operator[]( const point2<uint32_t>& xy ) const
+        {
+            return { real_[xy].v, imag_[xy].v };
+        }
+
+        /// pixel value by row-major index
+        inline pixel_t operator[]( size_t i ) const
+        {
+            return { real_[i].v, imag_[i].v };
+        }
+
+        /// set the pixel at \a xy
+        inline void set( const point2<uint32_t>& xy, const pixel_t& v )
+        {
+            real_[xy] = v.real;
+            imag_[xy] = v.imag;
+        }
+
+        /// geometry accessors
+        inline uint32_t width() const { return real_.width(); }
+        inline uint32_t height() const { return real_.height(); }
+        inline core::size size() const { return real_.size(); }
+        inline size_t pixel_count() const { return real_.pixel_count(); }
+        inline core::rect rect() const { return real_.rect(); }
+
+        inline bool operator==( const cplanar_image& rhs ) const
+        {
+            return real_ == rhs.real_ && imag_ == rhs.imag_;
+        }
+        inline bool operator!=( const cplanar_image& rhs ) const { return !operator==( rhs ); }
+
+    private:
+        plane_t real_;
+        plane_t imag_;
+    };
+
+    /// expression node reading complex values from the planes of a
+    /// \sa cplanar_image
+    template < typename T >
+    class cplanar_expression_node
+    {
+    public:
+        using type = complex<T>;
+
+        explicit cplanar_expression_node( const cplanar_image<T>& im )
+            : im_( im )
+        {}
+
+        inline complex<T> operator[]( size_t i ) const
+        {
+            return im_[i];
+        }
+
+        /// accessor for a single row
+        struct row_t
+        {
+            const g<T>* re;
+            const g<T>* im;
+            inline complex<T> operator[]( size_t x ) const { return { re[x].v, im[x].v }; }
+        };
+
+        inline row_t row( size_t y ) const
+        {
+            return { im_.real().line( y ), im_.imag().line( y ) };
+        }
+
+        inline core::size size() const
+        {
+            return im_.size();
+        }
+
+    private:
+        const cplanar_image<T>& im_;
+    };
+
+    template < typename T >
+    struct is_ie_inputtype<cplanar_image<T>> : std::true_type
+    {
+        using type = complex<T>;
+        using node_type = cplanar_expression_node<T>;
+    };
+
+    template < typename T >
+    struct is_cplanar_imagetype<cplanar_image<T>> : std::true_type
+    {};
+
+    // unary operations
+    template < typename T >
+    unary_image_expression<conjugate_op<complex<T>>, cplanar_expression_node<T>>
+    conj( const cplanar_image<T>& im )
+    {
+        return { cplanar_expression_node<T>{ im } };
+    }
+
+    template < typename T >
+    unary_image_expression<abs_op<complex<T>>, cplanar_expression_node<T>>
+    abs( const cplanar_image<T>& im )
+    {
+        return { cplanar_expression_node<T>{ im } };
+    }
+
+    template < typename T >
+    unary_image_expression<abs_sqr_op<complex<T>>, cplanar_expression_node<T>>
+    abs_sqr( const cplanar_image<T>& im )
+    {
+        return { cplanar_expression_node<T>{ im } };
+    }
+
+    /// split into (real, imag) images; see also cplanar_image::real()
+    /// and cplanar_image::imag(), which give access without copying
+    template < typename T >
+    std::tuple< image<g<T>>, image<g<T>> > split_to_channels( const cplanar_image<T>& c )
+    {
+        return { c.real(), c.imag() };
+    }
+
+    /// \returns b * conj(a), the pointwise step of an FFT based
+    /// cross-correlation of \a a and \a b; either may be planar or
+    /// interleaved
+    template < typename A, typename B >
+    cplanar_image<typename is_ie_inputtype<A>::type::value_t>
+    multiply_conjugate( const A& a, const B& b )
+    {
+        using T = typename is_ie_inputtype<A>::type::value_t;
+        using node_a = typename is_ie_inputtype<A>::node_type;
+        using node_b = typename is_ie_inputtype<B>::node_type;
+        using op_t = conjugate_op<complex<T>>;
+
+        return cplanar_image<T>{
+            image_expression<mult_op<complex<T>>, node_b, unary_image_expression<op_t, node_a>>{
+                node_b{ b }, unary_image_expression<op_t, node_a>{ node_a{ a } } } };
+    }
+
+    /// standard planar image types
+    using cplanar_f_image = cplanar_image<double>;
+
+}
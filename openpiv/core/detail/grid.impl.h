@@ -1,6 +1,12 @@
 
 #pragma once
 
+// std
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
 // openpiv
 #include "core/util.h"
 
@@ -60,4 +66,133 @@ namespace openpiv::core {
         return result;
     }
 
+    namespace detail {
+
+        /// sorted, distinct left and bottom window coordinates of
+        /// \a grid, i.e. its columns and rows
+        inline std::pair<std::vector<int32_t>, std::vector<int32_t>>
+        grid_positions( const std::vector<core::rect>& grid )
+        {
+            std::vector<int32_t> xs, ys;
+            for ( const auto& r : grid )
+            {
+                xs.push_back( r.left() );
+                ys.push_back( r.bottom() );
+            }
+            for ( auto* v : { &xs, &ys } )
+            {
+                std::sort( std::begin(*v), std::end(*v) );
+                v->erase( std::unique( std::begin(*v), std::end(*v) ), std::end(*v) );
+            }
+
+            return { std::move( xs ), std::move( ys ) };
+        }
+
+        /// interleave the bits of x and y: ...y1x1y0x0
+        inline uint64_t morton_key( uint32_t x, uint32_t y )
+        {
+            auto spread = []( uint64_t v ) {
+                v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+                v = (v | (v << 8))  & 0x00FF00FF00FF00FFULL;
+                v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+                v = (v | (v << 2))  & 0x3333333333333333ULL;
+                v = (v | (v << 1))  & 0x5555555555555555ULL;
+                return v;
+            };
+
+            return spread( x ) | (spread( y ) << 1);
+        }
+
+        /// distance along a Hilbert curve covering an n x n square,
+        /// n a power of two
+        inline uint64_t hilbert_key( uint64_t n, uint32_t x, uint32_t y )
+        {
+            uint64_t d = 0;
+            for ( uint64_t s = n/2; s > 0; s /= 2 )
+            {
+                const uint64_t rx = (x & s) > 0;
+                const uint64_t ry = (y & s) > 0;
+                d += s * s * ((3 * rx) ^ ry);
+
+                // rotate quadrant
+                if ( ry == 0 )
+                {
+                    if ( rx == 1 )
+                    {
+                        x = static_cast<uint32_t>(n - 1 - x);
+                        y = static_cast<uint32_t>(n - 1 - y);
+                    }
+                    std::swap( x, y );
+                }
+            }
+
+            return d;
+        }
+
+    }
+
+    inline
+    core::size
+    grid_shape( const std::vector<core::rect>& grid )
+    {
+        const auto [xs, ys] = detail::grid_positions( grid );
+        return { static_cast<uint32_t>(xs.size()), static_cast<uint32_t>(ys.size()) };
+    }
+
+    inline
+    std::vector<size_t>
+    grid_traversal_order( const std::vector<core::rect>& grid,
+                          grid_order order,
+                          uint32_t tile_size )
+    {
+        std::vector<size_t> result( grid.size() );
+        std::iota( std::begin(result), std::end(result), 0 );
+        if ( order == grid_order::ROW_MAJOR || grid.empty() )
+            return result;
+
+        if ( order == grid_order::SUPERTILE && tile_size == 0 )
+            core::exception_builder<std::runtime_error>() << "tile size must be non-zero";
+
+        // map window positions onto grid cell coordinates
+        const auto [xs, ys] = detail::grid_positions( grid );
+
+        uint64_t n = 1;
+        while ( n < std::max( xs.size(), ys.size() ) )
+            n *= 2;
+
+        std::vector<uint64_t> keys( grid.size() );
+        for ( size_t i=0; i<grid.size(); ++i )
+        {
+            const auto x = static_cast<uint32_t>(
+                std::lower_bound( std::begin(xs), std::end(xs), grid[i].left() ) - std::begin(xs) );
+            const auto y = static_cast<uint32_t>(
+                std::lower_bound( std::begin(ys), std::end(ys), grid[i].bottom() ) - std::begin(ys) );
+
+            switch ( order )
+            {
+            case grid_order::MORTON:
+                keys[i] = detail::morton_key( x, y );
+                break;
+            case grid_order::HILBERT:
+                keys[i] = detail::hilbert_key( n, x, y );
+                break;
+            case grid_order::SUPERTILE:
+            {
+                const uint64_t tiles_per_row = (xs.size() + tile_size - 1)/tile_size;
+                const uint64_t tile = (y/tile_size) * tiles_per_row + x/tile_size;
+                const uint64_t within = (y % tile_size) * tile_size + x % tile_size;
+                keys[i] = tile * tile_size * tile_size + within;
+                break;
+            }
+            default:
+                keys[i] = i;
+            }
+        }
+
+        std::stable_sort( std::begin(result), std::end(result),
+                          [&keys]( size_t a, size_t b ) { return keys[a] < keys[b]; } );
+
+        return result;
+    }
+
 }
@@ -111,8 +111,13 @@ template < template<typename> class ImageT,
            >
 ReturnT& apply( ImageT<ContainedT>& im, OpT op )
 {
-    for ( IndexT i=0; i<im.pixel_count(); ++i )
-        im[i] = op(i, im[i]);
+    IndexT i = 0;
+    for ( auto row : im.rows() )
+        for ( auto& p : row )
+        {
+            p = op(i, p);
+            ++i;
+        }
 
     return im;
 }
@@ -125,9 +130,8 @@ template < template<typename> class ImageT,
            >
 ReturnT& fill( ImageT<ContainedT>& im, const ContainedT& v )
 {
-    for ( uint32_t h=0; h<im.height(); ++h )
-        for ( uint32_t w=0; w<im.width(); ++w )
-            im[ {w, h} ] = v;
+    for ( auto row : im.rows() )
+        std::fill( std::begin(row), std::end(row), v );
 
     return im;
 }
@@ -142,9 +146,13 @@ template < typename GeneratorT,
            >
 ReturnT& fill( ImageT<ContainedT >& im, GeneratorT g )
 {
+    const auto rows = im.rows();
     for ( uint32_t h=0; h<im.height(); ++h )
+    {
+        const auto row = rows[h];
         for ( uint32_t w=0; w<im.width(); ++w )
-            im[ {w, h} ] = g( w, h );
+            row[w] = g( w, h );
+    }
 
     return im;
 }
@@ -156,12 +164,9 @@ template < template<typename> class ImageT,
 ReturnT pixel_sum_impl( const ImageT<ContainedT>& im )
 {
     ReturnT result = 0;
-    auto p = std::begin( im );
-    const auto e = std::end( im );
-    while ( p != e )
-    {
-        result += *p++;
-    }
+    for ( const auto row : im.rows() )
+        for ( const auto& p : row )
+            result += p;
 
     return result;
 }
@@ -201,23 +206,24 @@ ReturnT split_to_channels( const ImageT<rgba<T>>& rgba )
     ReturnImageT b_im( rgba.width(), rgba.height() );
     ReturnImageT a_im( rgba.width(), rgba.height() );
 
-    auto r = std::begin( r_im );
-    auto g = std::begin( g_im );
-    auto b = std::begin( b_im );
-    auto a = std::begin( a_im );
-
-    auto p = std::cbegin( rgba );
-    auto e = std::cend( rgba );
-    while ( p != e )
+    const auto src = rgba.rows();
+    for ( uint32_t h=0; h<rgba.height(); ++h )
     {
-        *r++ = p->r;
-        *g++ = p->g;
-        *b++ = p->b;
-        *a++ = p->a;
-        ++p;
+        const auto p = src[h];
+        const auto r = r_im.rows()[h];
+        const auto g = g_im.rows()[h];
+        const auto b = b_im.rows()[h];
+        const auto a = a_im.rows()[h];
+        for ( size_t w=0; w<p.size(); ++w )
+        {
+            r[w] = p[w].r;
+            g[w] = p[w].g;
+            b[w] = p[w].b;
+            a[w] = p[w].a;
+        }
     }
 
-    return std::make_tuple( r_im, g_im, b_im, a_im );
+    return std::make_tuple( std::move( r_im ), std::move( g_im ), std::move( b_im ), std::move( a_im ) );
 }
 
 /// join channels into an RGBA image
@@ -238,21 +244,21 @@ ReturnImageT join_from_channels( const ImageT<g<T>>& r_im,
 
     ReturnImageT rgba_im( r_im.width(), r_im.height() );
 
-    auto rgba = std::begin( rgba_im );
-
-    auto r = std::cbegin( r_im );
-    auto e = std::cend( r_im );
-    auto g = std::cbegin( g_im );
-    auto b = std::cbegin( b_im );
-    auto a = std::cbegin( a_im );
-
-    while ( r != e )
+    const auto dst = rgba_im.rows();
+    for ( uint32_t h=0; h<rgba_im.height(); ++h )
     {
-        rgba->r = *r++;
-        rgba->g = *g++;
-        rgba->b = *b++;
-        rgba->a = *a++;
-        ++rgba;
+        const auto rgba = dst[h];
+        const auto r = r_im.rows()[h];
+        const auto g = g_im.rows()[h];
+        const auto b = b_im.rows()[h];
+        const auto a = a_im.rows()[h];
+        for ( size_t w=0; w<rgba.size(); ++w )
+        {
+            rgba[w].r = r[w];
+            rgba[w].g = g[w];
+            rgba[w].b = b[w];
+            rgba[w].a = a[w];
+        }
     }
 
     return rgba_im;
@@ -270,19 +276,20 @@ ReturnT split_to_channels( const ImageT<complex<T>>& c )
     ReturnImageT real_im( c.width(), c.height() );
     ReturnImageT imag_im( c.width(), c.height() );
 
-    auto r = std::begin( real_im );
-    auto i = std::begin( imag_im );
-
-    auto p = std::cbegin( c );
-    auto e = std::cend( c );
-    while ( p != e )
+    const auto src = c.rows();
+    for ( uint32_t h=0; h<c.height(); ++h )
     {
-        *r++ = p->real;
-        *i++ = p->imag;
-        ++p;
+        const auto p = src[h];
+        const auto r = real_im.rows()[h];
+        const auto i = imag_im.rows()[h];
+        for ( size_t w=0; w<p.size(); ++w )
+        {
+            r[w] = p[w].real;
+            i[w] = p[w].imag;
+        }
     }
 
-    return std::make_tuple( real_im, imag_im );
+    return std::make_tuple( std::move( real_im ), std::move( imag_im ) );
 }
 
 /// join two images into a Complex image
@@ -296,22 +303,28 @@ ReturnImageT join_from_channels( const ImageT<g<T>>& real_im, const ImageT<g<T>>
     if ( real_im.size() != imag_im.size() )
         exception_builder<std::runtime_error>() << "source images must have matching dimensions";
 
-    ReturnImageT c_im( real_im.width(), real_im.height() );
-
-    auto c = std::begin( c_im );
+    // planar images hold the channels as they are
+    if constexpr ( is_cplanar_imagetype_v<ReturnImageT> )
+        return ReturnImageT{ image<g<T>>( real_im ), image<g<T>>( imag_im ) };
+    else
+    {
+        ReturnImageT c_im( real_im.width(), real_im.height() );
 
-    auto r = std::cbegin( real_im );
-    auto e = std::cend( real_im );
-    auto i = std::cbegin( imag_im );
+        const auto dst = c_im.rows();
+        for ( uint32_t h=0; h<c_im.height(); ++h )
+        {
+            const auto c = dst[h];
+            const auto r = real_im.rows()[h];
+            const auto i = imag_im.rows()[h];
+            for ( size_t w=0; w<c.size(); ++w )
+            {
+                c[w].real = r[w];
+                c[w].imag = i[w];
+            }
+        }
 
-    while ( r != e )
-    {
-        c->real = *r++;
-        c->imag = *i++;
-        ++c;
+        return c_im;
     }
-
-    return c_im;
 }
 
 /// transpose an image i.e. rows <-> columns; maps
@@ -58,8 +58,11 @@ public:
         return std::to_string(EnumHelper<E>::underlying_t(e));          \
     }                                                                   \
                                                                         \
-    template <typename E>                                               \
-    [[maybe_unused]] static E from_string(const std::string_view& s)    \
+    /* the return type keeps helpers for enums declared in the same */  \
+    /* namespace from redefining each other */                          \
+    template <typename T>                                               \
+    [[maybe_unused]] static std::enable_if_t< std::is_same_v<T, E>, T > \
+    from_string(const std::string_view& s)                              \
     {                                                                   \
         for (const auto& v : EnumHelper<E>::storage())                  \
             if ( v.s == s )                                             \
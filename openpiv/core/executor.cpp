@@ -0,0 +1,240 @@
+#include "core/executor.h"
+
+// std
+#include <algorithm>
+#include <exception>
+
+// platform
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace {
+
+    using namespace openpiv::core;
+
+    /// identifies the executor and queue owned by the current thread
+    thread_local const work_stealing_executor* current_executor = nullptr;
+    thread_local size_t current_index = 0;
+
+}
+
+namespace openpiv::core {
+
+    struct work_stealing_executor::job
+    {
+        const range_fn_t& f;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+
+        job( const range_fn_t& f_, size_t count )
+            : f( f_ )
+            , remaining( count )
+        {}
+    };
+
+    work_stealing_executor::work_stealing_executor( size_t thread_count, bool pin_threads )
+    {
+        for ( size_t i=0; i<thread_count; ++i )
+            queues_.emplace_back( std::make_unique<worker_queue>() );
+
+        for ( size_t i=0; i<thread_count; ++i )
+            workers_.emplace_back(
+                [this, i, pin_threads]() {
+                    if ( pin_threads )
+                        pin_current_thread( i + 1 );
+                    worker( i );
+                } );
+    }
+
+    work_stealing_executor::~work_stealing_executor()
+    {
+        {
+            std::unique_lock<std::mutex> lock( wake_mutex_ );
+            stop_ = true;
+        }
+        wake_condition_.notify_all();
+
+        for ( auto& worker : workers_ )
+            worker.join();
+    }
+
+    size_t work_stealing_executor::default_thread_count()
+    {
+        return std::max( 1u, std::thread::hardware_concurrency() ) - 1;
+    }
+
+    void work_stealing_executor::parallel_for_chunks( size_t begin, size_t end, range_fn_t f, size_t chunk_size )
+    {
+        if ( end <= begin )
+            return;
+
+        const size_t count = end - begin;
+        const size_t queue_count = queues_.size();
+        if ( chunk_size == 0 )
+            chunk_size = std::max<size_t>( 1, count / (4*(queue_count + 1)) );
+
+        // no workers: run inline
+        if ( queue_count == 0 )
+        {
+            for ( size_t b=begin; b<end; b+=chunk_size )
+                f( b, std::min(b + chunk_size, end) );
+
+            return;
+        }
+
+        const size_t chunk_count = (count + chunk_size - 1)/chunk_size;
+        job j{ f, chunk_count };
+
+        // hand each queue a contiguous block of chunks
+        pending_ += chunk_count;
+        for ( size_t q=0; q<queue_count; ++q )
+        {
+            const size_t first = (q*chunk_count)/queue_count;
+            const size_t last = ((q + 1)*chunk_count)/queue_count;
+
+            std::unique_lock<std::mutex> lock( queues_[q]->mutex );
+            for ( size_t c=first; c<last; ++c )
+            {
+                const size_t b = begin + c*chunk_size;
+                queues_[q]->chunks.push_back( { &j, b, std::min(b + chunk_size, end) } );
+            }
+        }
+
+        {
+            // synchronize with workers checking pending_
+            std::unique_lock<std::mutex> lock( wake_mutex_ );
+        }
+        wake_condition_.notify_all();
+
+        // help out until all chunks are taken, then wait for completion
+        const size_t preferred = current_executor == this ? current_index : queue_count;
+        while ( j.remaining > 0 )
+        {
+            if ( !try_run_one( preferred ) )
+            {
+                std::unique_lock<std::mutex> lock( j.mutex );
+                j.done.wait( lock, [&j](){ return j.remaining == 0; } );
+            }
+        }
+
+        // ensure the final chunk has released the job
+        {
+            std::unique_lock<std::mutex> lock( j.mutex );
+        }
+
+        if ( j.error )
+            std::rethrow_exception( j.error );
+    }
+
+    void work_stealing_executor::worker( size_t index )
+    {
+        current_executor = this;
+        current_index = index;
+
+        while ( true )
+        {
+            if ( try_run_one( index ) )
+                continue;
+
+            std::unique_lock<std::mutex> lock( wake_mutex_ );
+            wake_condition_.wait( lock, [this](){ return stop_ || pending_ > 0; } );
+            if ( stop_ && pending_ == 0 )
+                return;
+        }
+    }
+
+    bool work_stealing_executor::try_run_one( size_t preferred )
+    {
+        chunk c;
+        const size_t queue_count = queues_.size();
+        bool found = preferred < queue_count && try_pop( preferred, false, c );
+        for ( size_t i=1; !found && i<=queue_count; ++i )
+            found = try_pop( (preferred + i) % queue_count, true, c );
+
+        if ( found )
+            run( c );
+
+        return found;
+    }
+
+    bool work_stealing_executor::try_pop( size_t index, bool steal, chunk& c )
+    {
+        auto& queue = *queues_[index];
+        std::unique_lock<std::mutex> lock( queue.mutex );
+        if ( queue.chunks.empty() )
+            return false;
+
+        if ( steal )
+        {
+            c = queue.chunks.back();
+            queue.chunks.pop_back();
+        }
+        else
+        {
+            c = queue.chunks.front();
+            queue.chunks.pop_front();
+        }
+        --pending_;
+
+        return true;
+    }
+
+    void work_stealing_executor::run( chunk& c )
+    {
+        job& j = *c.owner;
+        if ( !j.failed )
+        {
+            try
+            {
+                j.f( c.begin, c.end );
+            }
+            catch (...)
+            {
+                std::unique_lock<std::mutex> lock( j.mutex );
+                if ( !j.error )
+                    j.error = std::current_exception();
+                j.failed = true;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock( j.mutex );
+        if ( --j.remaining == 0 )
+            j.done.notify_all();
+    }
+
+    bool pin_current_thread( size_t cpu )
+    {
+#if defined(__linux__)
+        const size_t cpu_count = std::max( 1u, std::thread::hardware_concurrency() );
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        CPU_SET( cpu % cpu_count, &set );
+        return pthread_setaffinity_np( pthread_self(), sizeof(set), &set ) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    size_t grid_chunk_size( const std::vector<core::rect>& grid,
+                            size_t thread_count,
+                            size_t bytes_per_pixel,
+                            size_t cache_bytes )
+    {
+        if ( grid.empty() )
+            return 1;
+
+        // two frames are read per window
+        const size_t window_bytes = std::max<size_t>( 1, 2 * grid.front().area() * bytes_per_pixel );
+        const size_t by_cache = std::max<size_t>( 1, cache_bytes / window_bytes );
+        const size_t by_balance = std::max<size_t>( 1, grid.size() / (4*(thread_count + 1)) );
+
+        return std::min( by_cache, by_balance );
+    }
+
+}
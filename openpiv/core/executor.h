@@ -0,0 +1,172 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// openpiv
+#include "core/exception_builder.h"
+#include "core/rect.h"
+
+namespace openpiv::core {
+
+    /// work-stealing executor: a fixed set of worker threads, each
+    /// with its own deque of work. A parallel_for splits its range
+    /// into chunks and hands each worker a contiguous block of
+    /// chunks; a worker takes chunks from the front of its own deque
+    /// and, once empty, steals from the back of another worker's
+    /// deque.
+    ///
+    /// Scheduling contract: each chunk is a contiguous sub-range of
+    /// [begin, end) executed in order by a single thread, and each
+    /// worker starts on a contiguous block of chunks. Work that is
+    /// spatially coherent in index space (e.g. a grid in a
+    /// \sa grid_order traversal) therefore stays coherent per worker;
+    /// only stolen chunks break this, and they are taken from the far
+    /// end of a block. This avoids contention on a single shared queue and
+    /// keeps all workers busy when the cost of each item varies.
+    ///
+    /// The calling thread also executes chunks whilst waiting, so
+    /// an executor with zero threads runs everything inline and
+    /// parallel_for may be nested.
+    ///
+    /// This class is thread-safe
+    class work_stealing_executor
+    {
+    public:
+        /// function called for each chunk as f(begin, end)
+        using range_fn_t = std::function<void(size_t, size_t)>;
+
+        /// if \a pin_threads is set, worker i is pinned to CPU i + 1
+        /// leaving CPU 0 for the calling thread; see \sa pin_current_thread
+        explicit work_stealing_executor( size_t thread_count = default_thread_count(), bool pin_threads = false );
+        ~work_stealing_executor();
+
+        work_stealing_executor( const work_stealing_executor& ) = delete;
+        work_stealing_executor& operator=( const work_stealing_executor& ) = delete;
+
+        /// number of worker threads, excluding the calling thread
+        size_t thread_count() const { return workers_.size(); }
+
+        /// call \a f for each chunk of [begin, end) of at most
+        /// \a chunk_size items; blocks until all chunks are complete.
+        /// If \a chunk_size is zero, a size is chosen to give several
+        /// chunks per worker.
+        ///
+        /// If \a f throws, remaining chunks are skipped and the first
+        /// exception is rethrown.
+        void parallel_for_chunks( size_t begin, size_t end, range_fn_t f, size_t chunk_size = 0 );
+
+        /// call \a f(i) for each i in [begin, end); see \sa parallel_for_chunks
+        template <typename F>
+        void parallel_for( size_t begin, size_t end, F&& f, size_t chunk_size = 0 )
+        {
+            parallel_for_chunks(
+                begin,
+                end,
+                [&f]( size_t b, size_t e ) {
+                    for ( size_t i=b; i<e; ++i )
+                        f(i);
+                },
+                chunk_size );
+        }
+
+        /// one fewer than the number of hardware threads as the
+        /// calling thread also does work
+        static size_t default_thread_count();
+
+    private:
+        struct job;
+        struct chunk
+        {
+            job* owner = nullptr;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        struct worker_queue
+        {
+            std::mutex mutex;
+            std::deque<chunk> chunks;
+        };
+
+        void worker( size_t index );
+        bool try_run_one( size_t preferred );
+        bool try_pop( size_t index, bool steal, chunk& c );
+        static void run( chunk& c );
+
+        std::vector<std::unique_ptr<worker_queue>> queues_;
+        std::vector<std::thread> workers_;
+        std::atomic<size_t> pending_{ 0 };
+        std::mutex wake_mutex_;
+        std::condition_variable wake_condition_;
+        bool stop_ = false;
+    };
+
+    /// pin the calling thread to CPU \a cpu, modulo the number of
+    /// hardware threads; \returns false if pinning is unsupported or
+    /// fails
+    bool pin_current_thread( size_t cpu );
+
+    /// choose the number of grid windows per chunk such that the
+    /// pixels of a chunk (both frames) fit into \a cache_bytes, while
+    /// still leaving several chunks per worker to balance load
+    size_t grid_chunk_size( const std::vector<core::rect>& grid,
+                            size_t thread_count,
+                            size_t bytes_per_pixel = sizeof(double),
+                            size_t cache_bytes = 256*1024 );
+
+    /// call \a f(i, grid[i]) for each window in \a grid using
+    /// \a executor; chunks are contiguous ranges of grid indices
+    template <typename F>
+    void parallel_for( work_stealing_executor& executor,
+                       const std::vector<core::rect>& grid,
+                       F&& f,
+                       size_t chunk_size = 0 )
+    {
+        if ( chunk_size == 0 )
+            chunk_size = grid_chunk_size( grid, executor.thread_count() );
+
+        executor.parallel_for(
+            0,
+            grid.size(),
+            [&f, &grid]( size_t i ) { f( i, grid[i] ); },
+            chunk_size );
+    }
+
+    /// call \a f(i, grid[i]) for each window in \a grid, visiting
+    /// windows in the sequence given by \a order (a permutation of
+    /// grid indices, see \sa grid_traversal_order); chunks are
+    /// contiguous ranges of \a order so each worker processes a
+    /// spatially compact block of windows. \a i is the original grid
+    /// index so results may be stored in row-major order.
+    template <typename F>
+    void parallel_for( work_stealing_executor& executor,
+                       const std::vector<core::rect>& grid,
+                       const std::vector<size_t>& order,
+                       F&& f,
+                       size_t chunk_size = 0 )
+    {
+        if ( order.size() != grid.size() )
+            core::exception_builder<std::runtime_error>()
+                << "traversal order size (" << order.size()
+                << ") doesn't match grid size (" << grid.size() << ")";
+
+        if ( chunk_size == 0 )
+            chunk_size = grid_chunk_size( grid, executor.thread_count() );
+
+        executor.parallel_for(
+            0,
+            order.size(),
+            [&f, &grid, &order]( size_t i ) { f( order[i], grid[order[i]] ); },
+            chunk_size );
+    }
+
+}
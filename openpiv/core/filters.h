@@ -0,0 +1,517 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// local
+#include "core/exception_builder.h"
+#include "core/executor.h"
+#include "core/image.h"
+#include "core/image_evaluate.h"
+#include "core/image_type_traits.h"
+#include "core/pixel_types.h"
+
+namespace openpiv::core {
+
+    /// Preprocessing filters for greyscale images and image_views:
+    /// separable convolution (e.g. Gaussian smoothing), running
+    /// minimum/maximum and the background removal filters built from
+    /// them.
+    ///
+    /// Each filter writes to an image<T>, which may also be the input;
+    /// integral results are rounded and saturated. Filters are
+    /// separable and work a whole row at a time so the inner loops
+    /// vectorise; if an executor is given, large images are split
+    /// into bands of rows (or columns) processed in parallel.
+    /// \sa filter_chain combines filters into a single stage, e.g. for
+    /// the load stage of a pipeline.
+
+    namespace detail {
+
+        template < template <typename> class ImageT, typename T >
+        using enable_filter_t =
+            std::enable_if_t< is_imagetype_v<ImageT<T>> && is_real_mono_pixeltype_v<T> >;
+
+        /// convert a filtered value to a pixel value of type T
+        template < typename T >
+        inline typename T::value_t filter_store( double v )
+        {
+            using value_t = typename T::value_t;
+            if constexpr ( std::is_integral_v<value_t> )
+                return static_cast<value_t>(
+                    std::floor( std::clamp<double>( v, T::min(), T::max() ) + 0.5 ) );
+            else
+                return static_cast<value_t>( v );
+        }
+
+        /// call \a f(first, last) over bands of [0, n), where each item
+        /// covers \a item_pixels pixels, split across \a executor if
+        /// there's enough work
+        template < typename F >
+        void for_each_band( size_t n, size_t item_pixels, work_stealing_executor* executor, F&& f )
+        {
+            const size_t chunk_pixels = default_evaluate_chunk_pixels;
+            if ( !executor || executor->thread_count() == 0 || n*item_pixels <= chunk_pixels || n < 2 )
+            {
+                f( 0, n );
+                return;
+            }
+
+            executor->parallel_for_chunks( 0, n, f, std::max<size_t>( 1, chunk_pixels / std::max<size_t>( 1, item_pixels ) ) );
+        }
+
+        inline void check_kernel( const std::vector<double>& k, const char* name )
+        {
+            if ( k.empty() || k.size() % 2 == 0 )
+                exception_builder<std::invalid_argument>()
+                    << "convolve_separable: " << name << " kernel must have odd length: " << k.size();
+        }
+
+        /// \returns the rows of \a in convolved with \a kx, with
+        /// replicated edges; each row is padded then accumulated one
+        /// tap at a time
+        template < typename ImageT >
+        std::vector<double> convolve_rows( const ImageT& in,
+                                           const std::vector<double>& kx,
+                                           work_stealing_executor* executor )
+        {
+            check_kernel( kx, "x" );
+
+            const size_t w = in.width();
+            const size_t h = in.height();
+            const size_t rx = kx.size() / 2;
+
+            std::vector<double> rows( w * h );
+            if ( rows.empty() )
+                return rows;
+
+            for_each_band( h, w, executor, [&]( size_t first, size_t last ) {
+                std::vector<double> padded( w + 2*rx );
+                for ( size_t y=first; y<last; ++y )
+                {
+                    const auto* src = in.line( y );
+                    double* p = padded.data() + rx;
+                    for ( size_t x=0; x<w; ++x )
+                        p[x] = static_cast<double>( src[x].v );
+                    std::fill( padded.begin(), padded.begin() + rx, p[0] );
+                    std::fill( padded.end() - rx, padded.end(), p[w - 1] );
+
+                    double* dst = rows.data() + y*w;
+                    std::fill( dst, dst + w, 0.0 );
+                    for ( size_t k=0; k<kx.size(); ++k )
+                    {
+                        const double c = kx[k];
+                        const double* s = padded.data() + k;
+                        for ( size_t x=0; x<w; ++x )
+                            dst[x] += c * s[x];
+                    }
+                }
+            } );
+
+            return rows;
+        }
+
+        /// convolve the columns of \a rows, \a w x \a h values, with
+        /// \a ky, accumulating whole rows; \a store(y, values) writes
+        /// each result row
+        template < typename StoreF >
+        void convolve_columns( const std::vector<double>& rows,
+                               size_t w,
+                               size_t h,
+                               const std::vector<double>& ky,
+                               work_stealing_executor* executor,
+                               StoreF&& store )
+        {
+            check_kernel( ky, "y" );
+            const size_t ry = ky.size() / 2;
+
+            for_each_band( h, w, executor, [&]( size_t first, size_t last ) {
+                std::vector<double> sum( w );
+                for ( size_t y=first; y<last; ++y )
+                {
+                    std::fill( sum.begin(), sum.end(), 0.0 );
+                    for ( size_t k=0; k<ky.size(); ++k )
+                    {
+                        const size_t r = static_cast<size_t>(
+                            std::clamp<int64_t>( static_cast<int64_t>( y + k ) - static_cast<int64_t>( ry ), 0, h - 1 ) );
+                        const double c = ky[k];
+                        const double* s = rows.data() + r*w;
+                        for ( size_t x=0; x<w; ++x )
+                            sum[x] += c * s[x];
+                    }
+                    store( y, sum.data() );
+                }
+            } );
+        }
+
+        struct min_filter_op
+        {
+            template < typename V > static constexpr V identity() { return std::numeric_limits<V>::max(); }
+            template < typename V > V operator()( V a, V b ) const { return b < a ? b : a; }
+        };
+
+        struct max_filter_op
+        {
+            template < typename V > static constexpr V identity() { return std::numeric_limits<V>::lowest(); }
+            template < typename V > V operator()( V a, V b ) const { return b > a ? b : a; }
+        };
+
+        /// running min/max of width 2r + 1 over the n values \a src
+        /// into \a out using the van Herk/Gil-Werman algorithm: three
+        /// comparisons per value whatever the window size. Values
+        /// outside [0, n) are ignored, as for replicated edges.
+        /// \a g and \a hh are working storage
+        template < typename Op, typename V >
+        void van_herk( const V* src, size_t n, size_t r, V* out, std::vector<V>& g, std::vector<V>& hh )
+        {
+            const Op op;
+            const size_t k = 2*r + 1;
+            const size_t m = ((n + 2*r + k - 1) / k) * k;
+            g.resize( m );
+            hh.resize( m );
+
+            auto p = [src, n, r]( size_t i ) {
+                return i >= r && i < r + n ? src[i - r] : Op::template identity<V>();
+            };
+
+            for ( size_t b=0; b<m; b+=k )
+            {
+                g[b] = p( b );
+                for ( size_t i=b + 1; i<b + k; ++i )
+                    g[i] = op( g[i - 1], p( i ) );
+
+                hh[b + k - 1] = p( b + k - 1 );
+                for ( size_t i=b + k - 1; i-- > b; )
+                    hh[i] = op( hh[i + 1], p( i ) );
+            }
+
+            for ( size_t x=0; x<n; ++x )
+                out[x] = op( hh[x], g[x + k - 1] );
+        }
+
+        /// running min/max of \a in with window (2rx + 1) x (2ry + 1);
+        /// rows are filtered one at a time, columns a band of columns
+        /// at a time so each step of the column pass is a vectorisable
+        /// loop along a row
+        template < typename Op, typename ImageT, typename T >
+        void running_filter( const ImageT& in, image<T>& out, uint32_t rx, uint32_t ry, work_stealing_executor* executor )
+        {
+            using value_t = typename T::value_t;
+            const size_t w = in.width();
+            const size_t h = in.height();
+
+            if ( w == 0 || h == 0 )
+            {
+                out.resize( in.size() );
+                return;
+            }
+
+            std::vector<value_t> rows( w * h );
+            for_each_band( h, w, executor, [&]( size_t first, size_t last ) {
+                std::vector<value_t> src( w ), g, hh;
+                for ( size_t y=first; y<last; ++y )
+                {
+                    const auto* line = in.line( y );
+                    for ( size_t x=0; x<w; ++x )
+                        src[x] = line[x].v;
+                    van_herk<Op>( src.data(), w, rx, rows.data() + y*w, g, hh );
+                }
+            } );
+
+            out.resize( in.size() );
+            out.detach();
+            const Op op;
+            const size_t k = 2*size_t{ ry } + 1;
+            const size_t m = ((h + 2*ry + k - 1) / k) * k;
+            for_each_band( w, h, executor, [&]( size_t first, size_t last ) {
+                const size_t n = last - first;
+                std::vector<value_t> identity( n, Op::template identity<value_t>() );
+                std::vector<value_t> g( m * n ), hh( m * n );
+                auto p = [&]( size_t i ) {
+                    return i >= ry && i < ry + h ? rows.data() + (i - ry)*w + first : identity.data();
+                };
+
+                for ( size_t b=0; b<m; b+=k )
+                {
+                    std::copy( p( b ), p( b ) + n, g.data() + b*n );
+                    for ( size_t i=b + 1; i<b + k; ++i )
+                    {
+                        const value_t* prev = g.data() + (i - 1)*n;
+                        const value_t* s = p( i );
+                        value_t* dst = g.data() + i*n;
+                        for ( size_t x=0; x<n; ++x )
+                            dst[x] = op( prev[x], s[x] );
+                    }
+
+                    std::copy( p( b + k - 1 ), p( b + k - 1 ) + n, hh.data() + (b + k - 1)*n );
+                    for ( size_t i=b + k - 1; i-- > b; )
+                    {
+                        const value_t* next = hh.data() + (i + 1)*n;
+                        const value_t* s = p( i );
+                        value_t* dst = hh.data() + i*n;
+                        for ( size_t x=0; x<n; ++x )
+                            dst[x] = op( next[x], s[x] );
+                    }
+                }
+
+                for ( size_t y=0; y<h; ++y )
+                {
+                    const value_t* a = hh.data() + y*n;
+                    const value_t* b = g.data() + (y + k - 1)*n;
+                    T* dst = out.line( y ) + first;
+                    for ( size_t x=0; x<n; ++x )
+                        dst[x] = op( a[x], b[x] );
+                }
+            } );
+        }
+
+        /// out = f(y, x, v) for each pixel value v of \a in
+        template < typename ImageT, typename T, typename F >
+        void combine_rows( const ImageT& in, image<T>& out, F&& f )
+        {
+            for ( size_t y=0; y<in.height(); ++y )
+            {
+                const auto* src = in.line( y );
+                T* dst = out.line( y );
+                for ( size_t x=0; x<in.width(); ++x )
+                    dst[x] = f( y, x, src[x].v );
+            }
+        }
+    }
+
+    /// normalised Gaussian kernel with standard deviation \a sigma and
+    /// 2 * \a radius + 1 taps; by default radius is ceil(3 * sigma)
+    inline std::vector<double> gaussian_kernel( double sigma, uint32_t radius = 0 )
+    {
+        if ( !(sigma > 0) )
+            exception_builder<std::invalid_argument>() << "gaussian_kernel: sigma must be positive: " << sigma;
+
+        if ( radius == 0 )
+            radius = static_cast<uint32_t>( std::ceil( 3*sigma ) );
+
+        std::vector<double> result( 2*radius + 1 );
+        double total = 0;
+        for ( size_t i=0; i<result.size(); ++i )
+        {
+            const double x = static_cast<double>( i ) - radius;
+            result[i] = std::exp( -x*x/(2*sigma*sigma) );
+            total += result[i];
+        }
+        for ( auto& v : result )
+            v /= total;
+
+        return result;
+    }
+
+    /// convolve \a in with \a kx along rows and \a ky along columns
+    /// into \a out, replicating edge pixels; kernels must have odd
+    /// length and are centred. \a out may be \a in
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void convolve_separable( const ImageT<T>& in,
+                             image<T>& out,
+                             const std::vector<double>& kx,
+                             const std::vector<double>& ky,
+                             work_stealing_executor* executor = nullptr )
+    {
+        detail::check_kernel( ky, "y" );
+        const auto rows = detail::convolve_rows( in, kx, executor );
+
+        // in has been read, so out may now be resized
+        out.resize( in.size() );
+        out.detach();
+        detail::convolve_columns(
+            rows, in.width(), in.height(), ky, executor,
+            [&out]( size_t y, const double* sum ) {
+                T* dst = out.line( y );
+                for ( size_t x=0; x<out.width(); ++x )
+                    dst[x] = detail::filter_store<T>( sum[x] );
+            } );
+    }
+
+    /// Gaussian smoothing with standard deviation \a sigma; see
+    /// \sa convolve_separable
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void gaussian_blur( const ImageT<T>& in, image<T>& out, double sigma, work_stealing_executor* executor = nullptr )
+    {
+        const auto k = gaussian_kernel( sigma );
+        convolve_separable( in, out, k, k, executor );
+    }
+
+    /// minimum over a (2 * \a rx + 1) x (2 * \a ry + 1) window centred
+    /// on each pixel, clipped to the image; \a out may be \a in
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void min_filter( const ImageT<T>& in, image<T>& out, uint32_t rx, uint32_t ry, work_stealing_executor* executor = nullptr )
+    {
+        detail::running_filter<detail::min_filter_op>( in, out, rx, ry, executor );
+    }
+
+    /// maximum over a window; see \sa min_filter
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void max_filter( const ImageT<T>& in, image<T>& out, uint32_t rx, uint32_t ry, work_stealing_executor* executor = nullptr )
+    {
+        detail::running_filter<detail::max_filter_op>( in, out, rx, ry, executor );
+    }
+
+    /// high-pass filter: \a in less its Gaussian smoothing with
+    /// standard deviation \a sigma, removing slowly varying background
+    /// intensity; integral results are clipped at the pixel minimum.
+    /// \a out may be \a in
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void high_pass( const ImageT<T>& in, image<T>& out, double sigma, work_stealing_executor* executor = nullptr )
+    {
+        const auto k = gaussian_kernel( sigma );
+        const size_t w = in.width();
+        std::vector<double> blurred( w * in.height() );
+        detail::convolve_columns(
+            detail::convolve_rows( in, k, executor ), w, in.height(), k, executor,
+            [&blurred, w]( size_t y, const double* sum ) { std::copy( sum, sum + w, blurred.data() + y*w ); } );
+
+        out.resize( in.size() );
+        detail::combine_rows( in, out, [&blurred, w]( size_t y, size_t x, auto v ) {
+            return detail::filter_store<T>( v - blurred[y*w + x] );
+        } );
+    }
+
+    /// background removal: \a in less its minimum over a
+    /// (2 * \a radius + 1) square window, see \sa min_filter.
+    /// \a out may be \a in
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void subtract_background( const ImageT<T>& in, image<T>& out, uint32_t radius, work_stealing_executor* executor = nullptr )
+    {
+        image<T> background;
+        min_filter( in, background, radius, radius, executor );
+
+        out.resize( in.size() );
+        detail::combine_rows( in, out, [&background]( size_t y, size_t x, auto v ) {
+            return static_cast<decltype(v)>( v - background[ {static_cast<uint32_t>( x ), static_cast<uint32_t>( y )} ].v );
+        } );
+    }
+
+    /// local contrast normalisation: each pixel is mapped from the
+    /// [min, max] of its (2 * \a radius + 1) square window to [0, 1]
+    /// for floating point pixels or [0, T::max()] for integral
+    /// pixels; flat windows map to 0. \a out may be \a in
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void normalise_local( const ImageT<T>& in, image<T>& out, uint32_t radius, work_stealing_executor* executor = nullptr )
+    {
+        image<T> lo, hi;
+        min_filter( in, lo, radius, radius, executor );
+        max_filter( in, hi, radius, radius, executor );
+
+        const double scale = std::is_integral_v<typename T::value_t> ? static_cast<double>( T::max() ) : 1.0;
+        out.resize( in.size() );
+        detail::combine_rows( in, out, [&lo, &hi, scale]( size_t y, size_t x, auto v ) {
+            const point2<uint32_t> xy{ static_cast<uint32_t>( x ), static_cast<uint32_t>( y ) };
+            const double range = static_cast<double>( hi[xy].v ) - lo[xy].v;
+            return detail::filter_store<T>( range > 0 ? scale * (v - lo[xy].v) / range : 0.0 );
+        } );
+    }
+
+    /// set pixels below \a t to zero; \a out may be \a in
+    template < template <typename> class ImageT,
+               typename T,
+               typename = detail::enable_filter_t<ImageT, T> >
+    void threshold( const ImageT<T>& in, image<T>& out, T t )
+    {
+        out.resize( in.size() );
+        detail::combine_rows( in, out, [t]( size_t, size_t, auto v ) {
+            return v < t.v ? decltype(v){} : v;
+        } );
+    }
+
+    /// a sequence of filters applied in place to each image of a
+    /// stream, e.g.
+    ///
+    ///   filter_chain<g_16> preprocess;
+    ///   preprocess.subtract_background( 7 ).gaussian_blur( 0.8 );
+    ///   ...
+    ///   preprocess( frame, executor );
+    ///
+    /// A chain may be applied from several threads at once.
+    template < typename T >
+    class filter_chain
+    {
+        static_assert( is_real_mono_pixeltype_v<T>, "filter_chain requires greyscale pixels" );
+
+    public:
+        using step_t = std::function<void( image<T>&, work_stealing_executor* )>;
+
+        filter_chain& gaussian_blur( double sigma )
+        {
+            gaussian_kernel( sigma );
+            return add( [sigma]( image<T>& im, work_stealing_executor* e ) { core::gaussian_blur( im, im, sigma, e ); } );
+        }
+
+        filter_chain& high_pass( double sigma )
+        {
+            gaussian_kernel( sigma );
+            return add( [sigma]( image<T>& im, work_stealing_executor* e ) { core::high_pass( im, im, sigma, e ); } );
+        }
+
+        filter_chain& subtract_background( uint32_t radius )
+        {
+            return add( [radius]( image<T>& im, work_stealing_executor* e ) { core::subtract_background( im, im, radius, e ); } );
+        }
+
+        filter_chain& normalise_local( uint32_t radius )
+        {
+            return add( [radius]( image<T>& im, work_stealing_executor* e ) { core::normalise_local( im, im, radius, e ); } );
+        }
+
+        filter_chain& threshold( T t )
+        {
+            return add( [t]( image<T>& im, work_stealing_executor* ) { core::threshold( im, im, t ); } );
+        }
+
+        /// append a custom step
+        filter_chain& add( step_t step )
+        {
+            steps_.push_back( std::move( step ) );
+            return *this;
+        }
+
+        inline bool empty() const { return steps_.empty(); }
+        inline size_t size() const { return steps_.size(); }
+
+        /// apply each filter in turn to \a im
+        image<T>& operator()( image<T>& im, work_stealing_executor* executor = nullptr ) const
+        {
+            for ( const auto& step : steps_ )
+                step( im, executor );
+
+            return im;
+        }
+
+        image<T> operator()( image<T>&& im, work_stealing_executor* executor = nullptr ) const
+        {
+            operator()( im, executor );
+            return std::move( im );
+        }
+
+    private:
+        std::vector<step_t> steps_;
+    };
+
+}
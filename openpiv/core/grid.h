@@ -6,11 +6,37 @@
 #include <vector>
 
 // openpiv
+#include "core/enum_helper.h"
 #include "core/rect.h"
 #include "core/size.h"
 
 namespace openpiv::core {
 
+    /// traversal order of the windows of a grid
+    ///
+    /// - ROW_MAJOR: as generated, row by row
+    /// - MORTON: Z-order curve over the grid cells
+    /// - HILBERT: Hilbert curve over the grid cells
+    /// - SUPERTILE: row-major blocks of NxN cells, row-major within a block
+    ///
+    /// With overlapping windows, MORTON, HILBERT and SUPERTILE keep
+    /// neighbouring windows - which share image rows - close together
+    /// in the traversal, so a contiguous range of the traversal touches
+    /// a compact region of the image.
+    enum class grid_order {
+        ROW_MAJOR,
+        MORTON,
+        HILBERT,
+        SUPERTILE
+    };
+
+    DECLARE_ENUM_HELPER( grid_order, {
+            { grid_order::ROW_MAJOR, "row-major" },
+            { grid_order::MORTON,    "morton" },
+            { grid_order::HILBERT,   "hilbert" },
+            { grid_order::SUPERTILE, "supertile" }
+        } )
+
     /// generate a centred cartesian grid of rectangles with
     /// dimensions \a size and a specified \a offset
     ///
@@ -43,6 +69,27 @@ namespace openpiv::core {
                              const core::size& interrogation_size,
                              std::array< uint32_t, 2 > offsets );
 
+    /// \returns the number of distinct window columns and rows of a
+    /// cartesian \a grid i.e. the shape of the resulting vector field
+    core::size
+    grid_shape( const std::vector<core::rect>& grid );
+
+    /// \returns the indices of \a grid in the traversal order given by
+    /// \a order; \a grid is expected to be a cartesian grid as produced
+    /// by \sa generate_cartesian_grid. \a tile_size is the number of
+    /// cells along each side of a block for grid_order::SUPERTILE.
+    ///
+    /// The grid itself is not modified so results can be stored by
+    /// the original index while processing in traversal order:
+    ///
+    /// auto order = grid_traversal_order( grid, grid_order::HILBERT );
+    /// for ( auto i : order )
+    ///     result[i] = process( grid[i] );
+    std::vector<size_t>
+    grid_traversal_order( const std::vector<core::rect>& grid,
+                          grid_order order,
+                          uint32_t tile_size = 4 );
+
 } // end of namespace
 
 
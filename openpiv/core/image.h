@@ -2,9 +2,12 @@
 #pragma once
 
 // std
+#include <algorithm>
 #include <cstdint>
 #include <exception>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <tuple>
 #include <typeinfo>
 #include <type_traits>
@@ -12,19 +15,107 @@
 #include <vector>
 
 // local
+#include "core/aligned_allocator.h"
 #include "core/image_expression.h"
+#include "core/image_layout.h"
+#include "core/memory_resource.h"
 #include "core/image_type_traits.h"
 #include "core/pixel_types.h"
 #include "core/point.h"
 #include "core/rect.h"
+#include "core/row_span.h"
 #include "core/size.h"
 #include "core/util.h"
 #include "core/exception_builder.h"
 
 namespace openpiv::core {
 
-/// basic 2-dimensional image; data is stored as a
-/// contiguous array of type T
+/// iterates over the pixels of an image in row-major order, skipping
+/// any padding at the end of each row
+template < typename T >
+class pitched_iterator
+{
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    pitched_iterator() = default;
+    pitched_iterator( T* p, size_t width, size_t pitch )
+        : p_( p )
+        , row_end_( p + width )
+        , width_( width )
+        , padding_( pitch - width )
+    {}
+
+    /// allow conversion from iterator to const_iterator
+    template < typename U,
+               typename = typename std::enable_if_t< std::is_same_v<const U, T> > >
+    pitched_iterator( const pitched_iterator<U>& rhs )
+        : p_( rhs.p_ )
+        , row_end_( rhs.row_end_ )
+        , width_( rhs.width_ )
+        , padding_( rhs.padding_ )
+    {}
+
+    pitched_iterator& operator++()
+    {
+        if ( ++p_ == row_end_ )
+        {
+            p_ += padding_;
+            row_end_ = p_ + width_;
+        }
+        return *this;
+    }
+    pitched_iterator operator++(int) { pitched_iterator result = *this; operator++(); return result; }
+
+    pitched_iterator& operator--()
+    {
+        if ( p_ == row_end_ - width_ )
+        {
+            p_ -= padding_;
+            row_end_ = p_;
+        }
+        --p_;
+        return *this;
+    }
+    pitched_iterator operator--(int) { pitched_iterator result = *this; operator--(); return result; }
+
+    bool operator==( const pitched_iterator& rhs ) const { return p_ == rhs.p_; }
+    bool operator!=( const pitched_iterator& rhs ) const { return p_ != rhs.p_; }
+
+    T& operator*() const { return *p_; }
+    T* operator->() const { return p_; }
+
+private:
+    template < typename U > friend class pitched_iterator;
+
+    T* p_ = nullptr;
+    T* row_end_ = nullptr;
+    size_t width_ = 0;
+    size_t padding_ = 0;
+};
+
+/// basic 2-dimensional image; data is stored row by row in a single
+/// allocation aligned to image_layout::max_alignment bytes. By default
+/// rows are packed; an \sa image_layout may align and pad each row,
+/// in which case rows are stride() bytes apart and only line() and
+/// data() together with stride() give direct access to the pixels.
+///
+/// Storage comes from the thread's \sa thread_memory_resource at
+/// construction, or copy construction; assignment keeps the storage's
+/// resource. Alternatively an image may refer to externally owned
+/// pixels, e.g. a mapped file (see \sa map_image), which are used in
+/// place until the image is resized; copies always own their pixels.
+///
+/// Copies are deep unless the image has been made shareable with
+/// \sa share: copies of a shareable image share its reference-counted
+/// pixel buffer, copy-on-write, so handing a frame to another stage or
+/// keeping it in a cache costs a pointer copy. Any non-const access to
+/// the pixels first gives the image a buffer of its own (see
+/// \sa detach), copying only if the buffer is still shared.
 template < typename T >
 class image
 {
@@ -32,17 +123,30 @@ public:
     using type = T;
     using pixel_t = T;
     using index_t = size_t;
-    using data_t = typename std::vector<T>;
+    using data_t = typename std::vector<T, aligned_allocator<T>>;
 
-    using iterator = typename data_t::iterator;
-    using const_iterator = typename data_t::const_iterator;
-    using reverse_iterator = typename data_t::reverse_iterator;
-    using const_reverse_iterator = typename data_t::const_reverse_iterator;
+    using iterator = pitched_iterator<T>;
+    using const_iterator = pitched_iterator<const T>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     // ctor
     image() = default;
-    image( const image& ) = default;
-    image( image&& ) = default;
+    image( const image& rhs )
+    {
+        assign_pixels( rhs );
+    }
+    image( image&& rhs )
+        : r_( rhs.r_ )
+        , layout_( rhs.layout_ )
+        , pitch_( rhs.pitch_ )
+        , data_( std::move( rhs.data_ ) )
+        , external_( std::move( rhs.external_ ) )
+        , shared_( std::move( rhs.shared_ ) )
+        , pixels_( rhs.pixels_ )
+    {
+        rhs.pixels_ = rhs.data_.data();
+    }
 
     /// empty image
     image( uint32_t w, uint32_t h )
@@ -69,6 +173,35 @@ public:
         , data_( r.area(), value )
     {}
 
+    /// image with default value and a specific row layout; storage
+    /// is allocated from \a resource
+    image( const core::size& s,
+           T value,
+           const image_layout& layout,
+           std::pmr::memory_resource* resource = thread_memory_resource() )
+        : r_( rect::from_size(s) )
+        , layout_( layout )
+        , pitch_( layout.pitch( s.width(), sizeof(T) ) )
+        , data_( pitch_ * s.height(), value, typename data_t::allocator_type( resource ) )
+    {}
+
+    /// wrap externally owned pixels of an image of size \a s, with
+    /// rows \a pitch pixels apart, without copying; \a owner is kept
+    /// alive for as long as the image refers to \a data, or may be
+    /// null if the caller otherwise guarantees the lifetime of \a data
+    image( const core::size& s, size_t pitch, T* data, std::shared_ptr<void> owner )
+        : r_( rect::from_size(s) )
+        , pitch_( pitch )
+        , external_( owner ? std::move( owner ) : std::shared_ptr<void>( static_cast<void*>(data), [](void*){} ) )
+        , pixels_( data )
+    {
+        if ( pitch_ < s.width() )
+            exception_builder<std::invalid_argument>()
+                << "pitch (" << pitch_ << ") must be at least the image width (" << s.width() << ")";
+        if ( !pixels_ && s.area() > 0 )
+            exception_builder<std::invalid_argument>() << "external image data must not be null";
+    }
+
     /// conversion from another similar image; expensive!
     template < template<typename> class ImageT,
                typename ContainedT,
@@ -105,23 +238,91 @@ public:
             return;
 
         r_ = core::rect( r_.bottomLeft(), s );
-        data_.resize( pixel_count() );
+        pitch_ = layout_.pitch( s.width(), sizeof(T) );
+        data_.resize( pitch_ * s.height() );
+        external_.reset();
+        shared_.reset();
+        own_pixels();
+    }
+
+    /// change the row layout; this is destructive as for resize
+    void set_layout( const image_layout& layout )
+    {
+        if ( layout == layout_ )
+            return;
+
+        layout_ = layout;
+        pitch_ = layout_.pitch( width(), sizeof(T) );
+        data_.resize( pitch_ * height() );
+        external_.reset();
+        shared_.reset();
+        own_pixels();
+    }
+
+    /// row layout of this image
+    inline const image_layout& layout() const { return layout_; }
+
+    /// memory resource providing the storage of this image; see
+    /// \sa scoped_arena
+    inline std::pmr::memory_resource* resource() const { return data_.get_allocator().resource(); }
+
+    /// \returns false if the pixels are owned externally
+    inline bool owns_data() const { return !external_; }
+
+    /// make copies of this image share its pixels until either is
+    /// written to; this moves the pixels into a reference-counted
+    /// buffer without copying them. Images with externally owned
+    /// pixels are unchanged.
+    ///
+    /// A shared buffer keeps the memory resource it was allocated
+    /// from, so images allocated within a \sa scoped_arena must not be
+    /// shared beyond it. Pointers to pixels obtained before sharing
+    /// must not be used to write afterwards.
+    image& share()
+    {
+        if ( !external_ && !shared_ )
+        {
+            shared_ = std::make_shared<data_t>( std::move( data_ ) );
+            pixels_ = shared_->data();
+        }
+
+        return *this;
+    }
+
+    /// \returns true if the pixels are in a shareable buffer
+    inline bool is_shared() const { return !!shared_; }
+
+    /// give a shareable image pixels of its own, copying them only if
+    /// the buffer is in use by another image; the non-const accessors
+    /// do this implicitly. Call this before writing to an image from
+    /// several threads
+    inline void detach()
+    {
+        if ( shared_ )
+            unshare();
     }
 
 
     /// assignment
     image& operator=(const image& rhs)
     {
-        r_ = rhs.r_;
-        data_ = rhs.data_;
+        if ( this != &rhs )
+            assign_pixels( rhs );
+
         return *this;
     }
 
     /// move assignment
     image& operator=(image&& rhs)
     {
-        data_ = std::move(rhs.data_);
-        r_    = std::move(rhs.r_);
+        data_     = std::move(rhs.data_);
+        r_        = std::move(rhs.r_);
+        layout_   = rhs.layout_;
+        pitch_    = rhs.pitch_;
+        external_ = std::move(rhs.external_);
+        shared_   = std::move(rhs.shared_);
+        pixels_   = external_ || shared_ ? rhs.pixels_ : data_.data();
+        rhs.pixels_ = rhs.data_.data();
 
         return *this;
     }
@@ -138,8 +339,13 @@ public:
         resize( p.size() );
 
         // no alternative but to iterate
-        for ( index_t i=0; i<p.pixel_count(); ++i )
-            convert( p[i], data_[i] );
+        auto dst = rows().begin();
+        for ( const auto& src : p.rows() )
+        {
+            const auto d = *dst++;
+            for ( size_t w=0; w<src.size(); ++w )
+                convert( src[w], d[w] );
+        }
 
         return *this;
     }
@@ -149,55 +355,74 @@ public:
     image& operator=(const E& e)
     {
         resize( e.size() );
-        for ( index_t i=0; i<pixel_count(); ++i )
-            data_[i] = e[i];
+        evaluate_rows( *this, e, 0, height() );
 
         return *this;
     }
 
+    /// in-place arithmetic with an image, image_view, expression or
+    /// value of the same pixel type, in a single pass and without a
+    /// temporary; see \sa compound_assign for the aliasing contract
+    template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+    image& operator+=(const R& rhs) { return compound_assign<plus_op>( *this, rhs ); }
+    template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+    image& operator-=(const R& rhs) { return compound_assign<minus_op>( *this, rhs ); }
+    template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+    image& operator*=(const R& rhs) { return compound_assign<mult_op>( *this, rhs ); }
+    template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+    image& operator/=(const R& rhs) { return compound_assign<div_op>( *this, rhs ); }
+
     /// equality
     inline bool operator==(const image& rhs) const
     {
-        return
-            r_ == rhs.r_ &&
-            data_ == rhs.data_;
+        if ( r_ != rhs.r_ )
+            return false;
+        // row padding isn't part of the image so only packed rows
+        // can be compared as a whole
+        if ( pitch_ == width() && rhs.pitch_ == width() && storage() && rhs.storage() )
+            return *storage() == *rhs.storage();
+
+        for ( uint32_t h=0; h<height(); ++h )
+            if ( !std::equal( line(h), line(h) + width(), rhs.line(h) ) )
+                return false;
+
+        return true;
     }
     inline bool operator!=(const image& rhs) const { return !operator==(rhs); }
 
-    /// pixel accessor
-    inline T& operator[](size_t i) { return data_[i]; }
-    inline const T& operator[](size_t i) const { return const_cast<image*>(this)->operator[](i); }
+    /// pixel accessor; \a i is the index of the pixel in row-major
+    /// order, excluding any row padding
+    inline T& operator[](size_t i) { detach(); return pixels_[offset(i)]; }
+    inline const T& operator[](size_t i) const { return pixels_[offset(i)]; }
 
     /// pixel accessor by point
-    inline T& operator[]( const point2<uint32_t>& xy ) { return data_[xy[1]*r_.width() + xy[0]]; }
-    inline const T& operator[]( const point2<uint32_t>& xy ) const
-    {
-        return const_cast<image*>(this)->operator[](xy);
-    }
+    inline T& operator[]( const point2<uint32_t>& xy ) { detach(); return pixels_[xy[1]*pitch_ + xy[0]]; }
+    inline const T& operator[]( const point2<uint32_t>& xy ) const { return pixels_[xy[1]*pitch_ + xy[0]]; }
 
-    /// raw data accessor
-    inline T* data() { return &data_[0]; }
-    inline const T* data() const { return const_cast<image*>(this)->data(); }
+    /// raw data accessor; rows are std::get<1>(stride()) bytes apart
+    inline T* data() { detach(); return pixels_; }
+    inline const T* data() const { return pixels_; }
 
     /// raw data by line
-    inline T* line( size_t i )
-    {
-        if (i>r_.height())
-            exception_builder<std::range_error>() << "line out of range (" << i << ", max is: " << r_.height() << ")";
+    inline T* line( size_t i ) { detach(); return pixels_ + line_offset(i); }
+    inline const T* line( size_t i ) const { return pixels_ + line_offset(i); }
 
-        return &data_[i*r_.width()];
-    }
-    inline const T* line( size_t i ) const { return const_cast<image*>(this)->line(i); }
+    /// distance between the starts of successive rows, in pixels
+    inline size_t pitch() const { return pitch_; }
+
+    /// rows of the image as a range of contiguous \sa row_span
+    inline row_range<T> rows() { detach(); return { pixels_, width(), pitch_, height() }; }
+    inline row_range<const T> rows() const { return { pixels_, width(), pitch_, height() }; }
 
     /// iterators
-    iterator begin() { return std::begin( data_ ); }
-    iterator end() { return std::end( data_ ); }
-    const_iterator begin() const { return std::begin( data_ ); }
-    const_iterator end() const { return std::end( data_ ); }
-    reverse_iterator rbegin() { return std::rbegin( data_ ); }
-    reverse_iterator rend() { return std::rend( data_ ); }
-    const_reverse_iterator rbegin() const { return std::rbegin( data_ ); }
-    const_reverse_iterator rend() const { return std::rend( data_ ); }
+    iterator begin() { detach(); return { pixels_, width(), pitch_ }; }
+    iterator end() { detach(); return { pixels_ + height()*pitch_, width(), pitch_ }; }
+    const_iterator begin() const { return { pixels_, width(), pitch_ }; }
+    const_iterator end() const { return { pixels_ + height()*pitch_, width(), pitch_ }; }
+    reverse_iterator rbegin() { return reverse_iterator( end() ); }
+    reverse_iterator rend() { return reverse_iterator( begin() ); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+    const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
 
     /// geometry accessors
     inline constexpr uint32_t width() const { return r_.width(); }
@@ -209,19 +434,117 @@ public:
     // distance between pixels in x and y directions
     inline constexpr std::tuple<size_t, size_t> stride() const
     {
-        return { sizeof(pixel_t), width() * sizeof(pixel_t) };
+        return { sizeof(pixel_t), pitch_ * sizeof(pixel_t) };
     }
 
     /// swap
     void swap( image& rhs )
     {
         std::swap( r_, rhs.r_ );
+        std::swap( layout_, rhs.layout_ );
+        std::swap( pitch_, rhs.pitch_ );
         std::swap( data_, rhs.data_ );
+        std::swap( external_, rhs.external_ );
+        std::swap( shared_, rhs.shared_ );
+        std::swap( pixels_, rhs.pixels_ );
+        own_pixels();
+        rhs.own_pixels();
     }
 
 private:
+    /// point at data_ unless the pixels are owned externally or
+    /// shared; storage may move whenever data_ is modified
+    void own_pixels()
+    {
+        if ( !external_ && !shared_ )
+            pixels_ = data_.data();
+    }
+
+    /// the vector holding the pixels, if not owned externally
+    const data_t* storage() const
+    {
+        if ( external_ )
+            return nullptr;
+
+        return shared_ ? shared_.get() : &data_;
+    }
+
+    /// leave the shared buffer, taking it over if no other image uses
+    /// it; kept out of line so that the accessors stay cheap to inline
+    void unshare()
+    {
+        if ( shared_.use_count() == 1 )
+            data_ = std::move( *shared_ );
+        else
+            data_.assign( shared_->begin(), shared_->end() );
+
+        shared_.reset();
+        own_pixels();
+    }
+
+    /// copy the geometry and pixels of \a rhs: a shared buffer is
+    /// shared, anything else copied into storage of our own;
+    /// externally owned pixels are copied to rows of our layout
+    void assign_pixels( const image& rhs )
+    {
+        r_ = rhs.r_;
+        layout_ = rhs.layout_;
+        external_.reset();
+        if ( rhs.shared_ )
+        {
+            pitch_ = rhs.pitch_;
+            shared_ = rhs.shared_;
+            pixels_ = shared_->data();
+            data_ = data_t( data_.get_allocator() );
+            return;
+        }
+
+        shared_.reset();
+        if ( rhs.owns_data() )
+        {
+            pitch_ = rhs.pitch_;
+            data_ = rhs.data_;
+            own_pixels();
+            return;
+        }
+
+        pitch_ = layout_.pitch( width(), sizeof(T) );
+        data_.resize( pitch_ * height() );
+        own_pixels();
+        for ( uint32_t h=0; h<height(); ++h )
+            std::copy( rhs.line(h), rhs.line(h) + width(), line(h) );
+    }
+
+    /// offset of pixel \a i in row-major order, excluding padding
+    inline size_t offset( size_t i ) const
+    {
+        if ( pitch_ == width() )
+            return i;
+
+        return (i / width())*pitch_ + i % width();
+    }
+
+    inline size_t line_offset( size_t i ) const
+    {
+        if ( i >= r_.height() )
+            line_out_of_range( i );
+
+        return i*pitch_;
+    }
+
+    // kept out of line so that line() stays cheap to inline
+    void line_out_of_range( size_t i ) const
+    {
+        exception_builder<std::range_error>() << "line out of range (" << i << ", height is: " << r_.height() << ")";
+    }
+
     core::rect r_;
+    image_layout layout_;
+    size_t pitch_ = r_.width();
     data_t data_;
+    std::shared_ptr<void> external_;    ///< owner of external pixels, if any
+    std::shared_ptr<data_t> shared_;    ///< shareable pixels, if any; see share()
+    T* pixels_ = data_.data();          ///< first pixel, in data_ or external
 };
 
 
@@ -0,0 +1,122 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+// local
+#include "core/exception_builder.h"
+#include "core/executor.h"
+#include "core/image.h"
+#include "core/image_expression.h"
+#include "core/image_view.h"
+
+namespace openpiv::core {
+
+    /// images with fewer pixels than this are evaluated on the calling
+    /// thread; it is also the minimum number of pixels in each chunk
+    /// handed to an executor
+    constexpr size_t default_evaluate_chunk_pixels = 1 << 16;
+
+    namespace detail {
+        /// call \a rows(first, last) for bands of rows of \a out,
+        /// split across \a executor if \a out is large enough
+        template < typename ImageT, typename RowsT >
+        void for_each_row_band( const ImageT& out, work_stealing_executor& executor, size_t chunk_pixels, RowsT&& rows )
+        {
+            const size_t height = out.height();
+            if ( executor.thread_count() == 0 || out.pixel_count() <= chunk_pixels || height < 2 )
+            {
+                rows( 0, height );
+                return;
+            }
+
+            const size_t rows_per_chunk = std::max<size_t>( 1, chunk_pixels / std::max<size_t>( 1, out.width() ) );
+            executor.parallel_for_chunks( 0, height, rows, rows_per_chunk );
+        }
+
+        /// give the image written through \a out pixels of its own
+        /// before its rows are written from several threads
+        template < typename T >
+        void detach( image<T>& out ) { out.detach(); }
+        template < typename T >
+        void detach( image_view<T>& out ) { out.underlying().detach(); }
+
+        template < typename ImageT, typename E >
+        void evaluate_parallel( ImageT& out, const E& e, work_stealing_executor& executor, size_t chunk_pixels )
+        {
+            detach( out );
+            for_each_row_band(
+                out, executor, chunk_pixels,
+                [&out, &e]( size_t first, size_t last ) { evaluate_rows( out, e, first, last ); } );
+        }
+    }
+
+    /// assign expression \a e to \a out, as for image::operator=, with
+    /// the rows of large images split across \a executor; each chunk
+    /// is a contiguous band of at least \a chunk_pixels pixels.
+    ///
+    /// Frame-level operations such as background subtraction are
+    /// limited by memory bandwidth, which a single core can't saturate.
+    template < typename T,
+               typename E,
+               typename = typename std::enable_if_t< is_imageexpression_v<E> > >
+    image<T>& evaluate( image<T>& out,
+                        const E& e,
+                        work_stealing_executor& executor,
+                        size_t chunk_pixels = default_evaluate_chunk_pixels )
+    {
+        out.resize( e.size() );
+        detail::evaluate_parallel( out, e, executor, chunk_pixels );
+        return out;
+    }
+
+    /// assign expression \a e to the pixels of \a out, which must be
+    /// the same size as \a e; see \sa evaluate
+    template < typename T,
+               typename E,
+               typename = typename std::enable_if_t< is_imageexpression_v<E> > >
+    image_view<T>& evaluate( image_view<T>& out,
+                             const E& e,
+                             work_stealing_executor& executor,
+                             size_t chunk_pixels = default_evaluate_chunk_pixels )
+    {
+        if ( out.size() != e.size() )
+            exception_builder<std::runtime_error>()
+                << "evaluate: expression size (" << e.size() << ") doesn't match view (" << out.size() << ")";
+
+        detail::evaluate_parallel( out, e, executor, chunk_pixels );
+        return out;
+    }
+
+    /// update \a out in place as out = Op(out, rhs), as for the
+    /// compound assignment operators of image and image_view, with the
+    /// rows of large images split across \a executor; e.g.
+    ///
+    ///   evaluate_in_place<plus_op>( sum, frame, executor );
+    template < template <typename> class Op,
+               typename ImageT,
+               typename R,
+               typename = typename std::enable_if_t<
+                   is_imagetype_v<ImageT> && is_compound_operand_v<R, typename ImageT::pixel_t> > >
+    ImageT& evaluate_in_place( ImageT& out,
+                               const R& rhs,
+                               work_stealing_executor& executor,
+                               size_t chunk_pixels = default_evaluate_chunk_pixels )
+    {
+        using T = typename ImageT::pixel_t;
+        return compound_assign<Op>(
+            out,
+            rhs,
+            [&out, &executor, chunk_pixels]( const auto& e ) {
+                detail::detach( out );
+                detail::for_each_row_band(
+                    out, executor, chunk_pixels,
+                    [&out, &e]( size_t first, size_t last ) {
+                        detail::compound_rows<Op<T>>( out, e, first, last );
+                    } );
+            } );
+    }
+
+}
@@ -2,10 +2,14 @@
 #pragma once
 
 // std
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
 // local
+#include "core/exception_builder.h"
 #include "core/pixel_types.h"
 #include "core/image_type_traits.h"
 #include "core/size.h"
@@ -42,6 +46,18 @@ public:
         return t_;
     }
 
+    /// accessor for a single row
+    struct row_t
+    {
+        T t;
+        inline constexpr T operator[](size_t) const { return t; }
+    };
+
+    inline constexpr row_t row(size_t) const
+    {
+        return { t_ };
+    }
+
     inline constexpr core::size size() const
     {
         return size_;
@@ -60,7 +76,7 @@ template <template <typename> class ImageT,
 class image_interface_expression_node
 {
 public:
-    using type = T;
+    using type = ContainedT;
 
     image_interface_expression_node() = default;
     image_interface_expression_node(const image_interface_expression_node&) = default;
@@ -74,6 +90,12 @@ public:
         return im_[i];
     }
 
+    /// pointer to the pixels of row \a y
+    inline const ContainedT* row(size_t y) const
+    {
+        return im_.line(y);
+    }
+
     inline constexpr core::size size() const
     {
         return im_.size();
@@ -115,6 +137,26 @@ public:
         return Op::apply(le()[index], re()[index]);
     }
 
+    /// accessor for a single row; this allows an expression to be
+    /// evaluated row by row without per-pixel index arithmetic
+    template <typename LeftRow, typename RightRow>
+    struct row_t
+    {
+        LeftRow l;
+        RightRow r;
+        inline auto operator[](size_t x) const -> decltype( Op::apply(l[x], r[x]) )
+        {
+            return Op::apply(l[x], r[x]);
+        }
+    };
+
+    inline auto row(size_t y) const
+    {
+        using LR = decltype(le_.row(y));
+        using RR = decltype(re_.row(y));
+        return row_t<LR, RR>{ le_.row(y), re_.row(y) };
+    }
+
     inline constexpr core::size size() const
     {
         return le_.size();
@@ -155,6 +197,22 @@ public:
         return Op::apply(expr()[index]);
     }
 
+    /// accessor for a single row
+    template <typename Row>
+    struct row_t
+    {
+        Row r;
+        inline auto operator[](size_t x) const -> decltype( Op::apply(r[x]) )
+        {
+            return Op::apply(r[x]);
+        }
+    };
+
+    inline auto row(size_t y) const
+    {
+        return row_t<decltype(expr_.row(y))>{ expr_.row(y) };
+    }
+
     inline constexpr core::size size() const
     {
         return expr_.size();
@@ -283,6 +341,32 @@ struct mod_op
 };
 
 
+/// evaluate rows [\a first, \a last) of expression \a e into \a out,
+/// which must already be the size of \a e.
+///
+/// Each row is a simple loop over contiguous memory; the only
+/// aliasing allowed between \a out and the leaves of \a e is at the
+/// same pixel (e.g. im = im * conj(im)), so the loop carries no
+/// dependencies and the compiler is told it may vectorize it.
+template <typename ImageT, typename E>
+void evaluate_rows(ImageT& out, const E& e, size_t first, size_t last)
+{
+    using T = typename ImageT::pixel_t;
+    const size_t width = out.width();
+    for ( size_t y=first; y<last; ++y )
+    {
+        T* l = out.line( y );
+        const auto src = e.row( y );
+#if defined(__clang__)
+        #pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+        #pragma GCC ivdep
+#endif
+        for ( size_t x=0; x<width; ++x )
+            l[x] = src[x];
+    }
+}
+
 ///
 template <typename T>
 struct is_imageexpression : std::false_type
@@ -355,6 +439,113 @@ struct is_ie_inputtype<unary_image_expression<OP, T>> : std::true_type
 template <typename T>
 inline constexpr bool is_ie_inputtype_v = is_ie_inputtype<T>::value;
 
+namespace detail {
+
+/// apply \a Op in place to rows [\a first, \a last) of \a out with
+/// the corresponding pixels of \a e
+template <typename Op, typename ImageT, typename E>
+void compound_rows(ImageT& out, const E& e, size_t first, size_t last)
+{
+    using T = typename ImageT::pixel_t;
+    const size_t width = out.width();
+    for ( size_t y=first; y<last; ++y )
+    {
+        T* l = out.line( y );
+        const auto src = e.row( y );
+#if defined(__clang__)
+        #pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+        #pragma GCC ivdep
+#endif
+        for ( size_t x=0; x<width; ++x )
+            l[x] = Op::apply( l[x], src[x] );
+    }
+}
+
+/// \returns true if the pixels of \a src overlap those of \a dst
+/// other than at the same position, i.e. updating \a dst in place
+/// may change pixels of \a src yet to be read
+template <typename DstT, typename SrcT>
+bool overlaps_shifted(const DstT& dst, const SrcT& src)
+{
+    using T = typename DstT::pixel_t;
+    if ( dst.pixel_count() == 0 || src.pixel_count() == 0 )
+        return false;
+
+    const T* d0 = dst.line( 0 );
+    const T* s0 = src.line( 0 );
+    if ( d0 == s0 && dst.pitch() == src.pitch() )
+        return false;
+
+    const T* d1 = dst.line( dst.height() - 1 ) + dst.width();
+    const T* s1 = src.line( src.height() - 1 ) + src.width();
+    const std::less<const T*> less;
+    return less( s0, d1 ) && less( d0, s1 );
+}
+
+}
+
+/// update \a dst in place as dst = Op(dst, rhs), where \a rhs is an
+/// image, image_view or expression of the same size as \a dst or a
+/// value broadcast to every pixel; \a run is called with the
+/// expression node for \a rhs and must apply
+/// detail::compound_rows<Op> to every row of \a dst, allowing the
+/// caller to choose how rows are scheduled.
+///
+/// Aliasing: \a rhs may read the pixel of \a dst being updated (e.g.
+/// im += im * 2). An image or image_view \a rhs which overlaps
+/// \a dst at another position is copied first. An expression
+/// containing such an overlapping leaf gives unspecified results.
+template <template <typename> class Op, typename ImageT, typename R, typename RunT>
+ImageT& compound_assign(ImageT& dst, const R& rhs, RunT&& run)
+{
+    using T = typename ImageT::pixel_t;
+    if constexpr ( is_ie_inputtype_v<R> )
+    {
+        static_assert( std::is_same_v<typename is_ie_inputtype<R>::type, T>,
+                       "compound assignment requires matching pixel types" );
+
+        if ( rhs.size() != dst.size() )
+            exception_builder<std::runtime_error>()
+                << "compound assignment: sizes don't match: " << dst.size() << ", " << rhs.size();
+
+        if constexpr ( is_imagetype_v<R> )
+        {
+            if ( detail::overlaps_shifted( dst, rhs ) )
+            {
+                const image<T> copy{ rhs };
+                run( image_interface_expression_node<image, T>{ copy } );
+                return dst;
+            }
+        }
+
+        run( typename is_ie_inputtype<R>::node_type{ rhs } );
+    }
+    else
+    {
+        run( const_image_expression_node<T>{ T( rhs ), dst.size() } );
+    }
+
+    return dst;
+}
+
+/// as above, evaluating on the calling thread
+template <template <typename> class Op, typename ImageT, typename R>
+ImageT& compound_assign(ImageT& dst, const R& rhs)
+{
+    using T = typename ImageT::pixel_t;
+    return compound_assign<Op>(
+        dst,
+        rhs,
+        [&dst]( const auto& e ) { detail::compound_rows<Op<T>>( dst, e, 0, dst.height() ); } );
+}
+
+/// \a R may be the right hand side of a compound assignment to an
+/// image of \a T
+template <typename R, typename T>
+inline constexpr bool is_compound_operand_v =
+    is_ie_inputtype_v<R> || (std::is_convertible_v<R, T> && !is_imagetype_v<R>);
+
 ///
 template <
     typename LE,
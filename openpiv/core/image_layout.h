@@ -0,0 +1,87 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// local
+#include "core/aligned_allocator.h"
+#include "core/exception_builder.h"
+
+namespace openpiv::core {
+
+    /// Describes how the rows of an image are laid out in memory.
+    ///
+    /// By default rows are packed, i.e. the row pitch equals the
+    /// width. Aligned rows start on a multiple of \a row_alignment
+    /// bytes so that SIMD kernels can use aligned loads on every row;
+    /// \a row_padding adds a further fixed number of bytes per row.
+    /// When the pitch of a row is a multiple of 4KiB, as for many
+    /// power-of-two widths, loads and stores to the same column of
+    /// successive rows alias in the CPU's store buffer; with
+    /// \a avoid_4k_aliasing a cache line is added to such rows.
+    ///
+    /// Image storage is always aligned to
+    /// \sa image_layout::max_alignment bytes.
+    struct image_layout
+    {
+        static constexpr size_t max_alignment = aligned_allocator<uint8_t>::alignment;
+
+        size_t row_alignment = 0;       ///< bytes, power of 2; 0 for packed rows
+        size_t row_padding = 0;         ///< bytes added to each row
+        bool avoid_4k_aliasing = false;
+
+        /// rows stored back to back
+        static constexpr image_layout packed() { return {}; }
+
+        /// rows aligned to \a alignment bytes, avoiding 4K aliasing
+        static constexpr image_layout aligned( size_t alignment = max_alignment )
+        {
+            return { alignment, 0, true };
+        }
+
+        /// \returns true if rows are stored back to back
+        constexpr bool is_packed() const
+        {
+            return row_alignment == 0 && row_padding == 0 && !avoid_4k_aliasing;
+        }
+
+        /// \returns the row pitch, in pixels of \a pixel_size bytes,
+        /// for an image of width \a width
+        size_t pitch( uint32_t width, size_t pixel_size ) const
+        {
+            if ( is_packed() )
+                return width;
+
+            if ( row_alignment > max_alignment || (row_alignment & (row_alignment - 1)) != 0 )
+                exception_builder<std::invalid_argument>()
+                    << "row alignment must be a power of 2 no larger than " << max_alignment << ": " << row_alignment;
+            if ( row_alignment % pixel_size != 0 || row_padding % pixel_size != 0 )
+                exception_builder<std::invalid_argument>()
+                    << "row alignment (" << row_alignment << ") and padding (" << row_padding
+                    << ") must be multiples of the pixel size (" << pixel_size << ")";
+
+            size_t bytes = width * pixel_size;
+            if ( row_alignment )
+                bytes = (bytes + row_alignment - 1) & ~(row_alignment - 1);
+            bytes += row_padding;
+
+            constexpr size_t page = 4096;
+            if ( avoid_4k_aliasing && bytes > 0 && bytes % page == 0 )
+                bytes += max_alignment % pixel_size == 0 ? max_alignment : pixel_size;
+
+            return bytes / pixel_size;
+        }
+
+        constexpr bool operator==( const image_layout& rhs ) const
+        {
+            return
+                row_alignment == rhs.row_alignment &&
+                row_padding == rhs.row_padding &&
+                avoid_4k_aliasing == rhs.avoid_4k_aliasing;
+        }
+        constexpr bool operator!=( const image_layout& rhs ) const { return !operator==(rhs); }
+    };
+
+}
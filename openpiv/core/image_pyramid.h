@@ -0,0 +1,286 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// local
+#include "core/enum_helper.h"
+#include "core/exception_builder.h"
+#include "core/image.h"
+#include "core/image_type_traits.h"
+#include "core/image_view.h"
+#include "core/pixel_types.h"
+#include "core/rect.h"
+#include "core/size.h"
+
+namespace openpiv::core {
+
+    /// smoothing applied before each 2x decimation of an \sa image_pyramid
+    enum class pyramid_filter {
+        BOX,       ///< mean of each 2x2 block
+        GAUSSIAN   ///< separable 5-tap binomial, [1 4 6 4 1]/16, edges replicated
+    };
+
+    DECLARE_ENUM_HELPER( pyramid_filter, {
+            { pyramid_filter::BOX,      "box" },
+            { pyramid_filter::GAUSSIAN, "gaussian" }
+        } )
+
+    namespace detail {
+
+        /// integral pixels are filtered exactly in integer arithmetic,
+        /// floating point pixels in their own type
+        template < typename V >
+        using pyramid_accumulator_t =
+            std::conditional_t< std::is_integral_v<V>,
+                                std::conditional_t< (sizeof(V) <= 2), int32_t, int64_t >,
+                                V >;
+
+        /// separable kernels; taps of output pixel x are at input pixels
+        /// 2x + first, ..., 2x + first + N - 1 and the weights sum to
+        /// 2^shift
+        struct box_kernel
+        {
+            static constexpr std::array<int32_t, 2> weights{ 1, 1 };
+            static constexpr int32_t first = 0;
+            static constexpr uint32_t shift = 1;
+        };
+
+        struct gaussian_kernel
+        {
+            static constexpr std::array<int32_t, 5> weights{ 1, 4, 6, 4, 1 };
+            static constexpr int32_t first = -2;
+            static constexpr uint32_t shift = 4;
+        };
+
+        /// working storage for \sa downsample, reused between calls
+        template < typename AccT >
+        struct pyramid_buffers
+        {
+            std::vector<AccT> row;       ///< source row with replicated edges
+            std::vector<AccT> filtered;  ///< horizontally filtered, decimated rows
+        };
+
+        /// filter and decimate \a in into \a out: each row is filtered
+        /// horizontally and decimated into \a buffers, then columns of
+        /// the filtered rows are combined a whole output row at a time
+        template < typename KernelT, typename ImageT, typename T, typename AccT >
+        void downsample( const ImageT& in, image<T>& out, pyramid_buffers<AccT>& buffers )
+        {
+            using value_t = typename T::value_t;
+            constexpr size_t N = KernelT::weights.size();
+            constexpr int32_t pad = static_cast<int32_t>( N );
+
+            const int32_t in_w = in.width();
+            const int32_t in_h = in.height();
+            const uint32_t w = in_w / 2;
+            const uint32_t h = in_h / 2;
+            out.resize( { w, h } );
+            if ( w == 0 || h == 0 )
+                return;
+
+            buffers.row.resize( in_w + 2*pad );
+            buffers.filtered.resize( static_cast<size_t>( in_h ) * w );
+
+            // horizontal pass
+            for ( int32_t y=0; y<in_h; ++y )
+            {
+                const T* src = in.line( y );
+                AccT* row = buffers.row.data() + pad;
+                for ( int32_t x=0; x<in_w; ++x )
+                    row[x] = static_cast<AccT>( static_cast<value_t>( src[x] ) );
+                std::fill( row - pad, row, row[0] );
+                std::fill( row + in_w, row + in_w + pad, row[in_w - 1] );
+
+                const AccT* taps = row + KernelT::first;
+                AccT* dst = buffers.filtered.data() + static_cast<size_t>( y ) * w;
+#if defined(__clang__)
+                #pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+                #pragma GCC ivdep
+#endif
+                for ( uint32_t x=0; x<w; ++x )
+                {
+                    AccT sum{};
+                    for ( size_t k=0; k<N; ++k )
+                        sum += KernelT::weights[k] * taps[2*x + k];
+                    dst[x] = sum;
+                }
+            }
+
+            // vertical pass, normalising by the product of both passes
+            constexpr uint32_t shift = 2*KernelT::shift;
+            for ( uint32_t y=0; y<h; ++y )
+            {
+                std::array<const AccT*, N> rows;
+                for ( size_t k=0; k<N; ++k )
+                {
+                    const int32_t r = std::clamp<int32_t>( static_cast<int32_t>( 2*y + k ) + KernelT::first, 0, in_h - 1 );
+                    rows[k] = buffers.filtered.data() + static_cast<size_t>( r ) * w;
+                }
+
+                T* dst = out.line( y );
+#if defined(__clang__)
+                #pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+                #pragma GCC ivdep
+#endif
+                for ( uint32_t x=0; x<w; ++x )
+                {
+                    AccT sum{};
+                    for ( size_t k=0; k<N; ++k )
+                        sum += KernelT::weights[k] * rows[k][x];
+
+                    if constexpr ( std::is_integral_v<AccT> )
+                        dst[x] = static_cast<value_t>( (sum + (AccT{ 1 } << (shift - 1))) >> shift );
+                    else
+                        dst[x] = static_cast<value_t>( sum * (AccT{ 1 } / (1 << shift)) );
+                }
+            }
+        }
+
+        template < typename ImageT, typename T, typename AccT >
+        void downsample( const ImageT& in, image<T>& out, pyramid_filter filter, pyramid_buffers<AccT>& buffers )
+        {
+            if ( filter == pyramid_filter::BOX )
+                downsample<box_kernel>( in, out, buffers );
+            else
+                downsample<gaussian_kernel>( in, out, buffers );
+        }
+    }
+
+    /// \returns \a in smoothed with \a filter and decimated by 2 in each
+    /// direction; odd trailing rows and columns only contribute to the
+    /// smoothing. Integral pixels are rounded to nearest.
+    template < template <typename> class ImageT,
+               typename T,
+               typename = typename std::enable_if_t<
+                   is_imagetype_v<ImageT<T>> && is_real_mono_pixeltype_v<T> > >
+    image<T> downsample( const ImageT<T>& in, pyramid_filter filter = pyramid_filter::GAUSSIAN )
+    {
+        detail::pyramid_buffers< detail::pyramid_accumulator_t<typename T::value_t> > buffers;
+        image<T> result;
+        detail::downsample( in, result, filter, buffers );
+
+        return result;
+    }
+
+    /// multi-resolution representation of an image: level 0 is the
+    /// image itself and each further level is the previous one
+    /// smoothed and decimated by 2, see \sa downsample. A pixel at
+    /// (x, y) of level i covers pixels from (x, y)*scale(i) of level 0.
+    ///
+    /// Levels are built on first access, so a coarse-to-fine search
+    /// only pays for the levels it uses; level() may be called from
+    /// several threads. \sa reset moves the pyramid on to a new image
+    /// reusing the storage of each level, so a pyramid may be kept per
+    /// camera stream without allocating per frame.
+    ///
+    /// Level 0 refers to the source image, which must outlive the
+    /// pyramid or be replaced with \sa reset.
+    template < typename T >
+    class image_pyramid
+    {
+        static_assert( is_real_mono_pixeltype_v<T>, "image_pyramid requires greyscale pixels" );
+
+    public:
+        using pixel_t = T;
+
+        /// pyramid of \a levels levels, including \a base; throws if
+        /// \a base is too small to halve levels - 1 times
+        image_pyramid( const image<T>& base, size_t levels, pyramid_filter filter = pyramid_filter::GAUSSIAN )
+            : levels_( levels > 0 ? levels - 1 : 0 )
+            , filter_( filter )
+        {
+            if ( levels == 0 )
+                exception_builder<std::invalid_argument>() << "image_pyramid: at least one level is required";
+
+            // coarser levels use the row layout of the source
+            for ( auto& level : levels_ )
+                level.set_layout( base.layout() );
+
+            reset( base );
+        }
+
+        image_pyramid( const image_pyramid& ) = delete;
+        image_pyramid& operator=( const image_pyramid& ) = delete;
+
+        /// move on to \a base; levels are rebuilt on next access into
+        /// their existing storage. This must not be called concurrently
+        /// with level()
+        void reset( const image<T>& base )
+        {
+            if ( levels() > max_levels( base.size() ) )
+                exception_builder<std::invalid_argument>()
+                    << "image_pyramid: " << base.size() << " image supports at most "
+                    << max_levels( base.size() ) << " levels, " << levels() << " requested";
+
+            base_ = &base;
+            built_.store( 1, std::memory_order_release );
+        }
+
+        /// number of levels, including the source image
+        inline size_t levels() const { return levels_.size() + 1; }
+        inline pyramid_filter filter() const { return filter_; }
+
+        /// level \a i, building it and any finer levels if required
+        const image<T>& level( size_t i ) const
+        {
+            if ( i == 0 )
+                return *base_;
+            if ( i >= levels() )
+                exception_builder<std::out_of_range>() << "image_pyramid: level " << i << " of " << levels();
+
+            if ( i >= built_.load( std::memory_order_acquire ) )
+            {
+                std::lock_guard<std::mutex> lock( mutex_ );
+                for ( size_t l = built_.load( std::memory_order_relaxed ); l <= i; ++l )
+                {
+                    detail::downsample( l == 1 ? *base_ : levels_[l - 2], levels_[l - 1], filter_, buffers_ );
+                    built_.store( l + 1, std::memory_order_release );
+                }
+            }
+
+            return levels_[i - 1];
+        }
+
+        inline const image<T>& operator[]( size_t i ) const { return level( i ); }
+
+        /// view onto \a r, in the coordinates of level \a i
+        const image_view<T> view( size_t i, const core::rect& r ) const
+        {
+            return create_image_view( level( i ), r );
+        }
+
+        /// number of level 0 pixels, along each side, covered by a
+        /// pixel of level \a i
+        static constexpr uint32_t scale( size_t i ) { return 1u << i; }
+
+        /// the maximum number of levels for an image of size \a s,
+        /// i.e. halving until a dimension would become zero
+        static size_t max_levels( const core::size& s )
+        {
+            size_t result = 0;
+            for ( uint32_t d = std::min( s.width(), s.height() ); d > 0; d /= 2 )
+                ++result;
+
+            return result;
+        }
+
+    private:
+        const image<T>* base_ = nullptr;
+        mutable std::vector<image<T>> levels_;         ///< levels 1..n
+        pyramid_filter filter_;
+        mutable std::atomic<size_t> built_{ 1 };       ///< levels [0, built_) are current
+        mutable std::mutex mutex_;
+        mutable detail::pyramid_buffers< detail::pyramid_accumulator_t<typename T::value_t> > buffers_;
+    };
+
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+// local
+#include "core/exception_builder.h"
+#include "core/image_expression.h"
+#include "core/pixel_types.h"
+#include "core/point.h"
+#include "core/size.h"
+
+namespace openpiv::core {
+
+    /// Reductions over images, image_views and image expressions.
+    ///
+    /// Each is evaluated in a single pass, row by row, directly from
+    /// the expression: e.g. mean( (a - b)*(a - b) ) never creates an
+    /// image for the difference or its square. Reductions are defined
+    /// for greyscale pixel types; sums accumulate in int64_t for
+    /// integral pixels and in double otherwise.
+
+    namespace detail {
+
+        /// wrap an image, image_view or expression as an expression node
+        template < typename E,
+                   typename NodeT = typename is_ie_inputtype<E>::node_type >
+        NodeT as_expression( const E& e )
+        {
+            return NodeT{ e };
+        }
+
+        template < typename E >
+        using reduce_pixel_t = std::decay_t< decltype( std::declval<const E&>().row(0)[0] ) >;
+
+        template < typename PixelT >
+        using reduce_accumulator_t =
+            std::conditional_t< std::is_integral_v<typename PixelT::value_t>, int64_t, double >;
+
+        template < typename E >
+        using enable_reduce_t =
+            std::enable_if_t< is_ie_inputtype_v<E> &&
+                              is_real_mono_pixeltype_v< reduce_pixel_t<typename is_ie_inputtype<E>::node_type> > >;
+
+        template < typename E >
+        void require_not_empty( const E& e, const char* what )
+        {
+            if ( e.size().area() == 0 )
+                exception_builder<std::runtime_error>() << what << ": expression is empty";
+        }
+
+        template < typename E, typename Acc >
+        Acc sum( const E& e )
+        {
+            const auto [width, height] = e.size().components();
+            Acc result{};
+            for ( size_t y=0; y<height; ++y )
+            {
+                const auto src = e.row( y );
+                Acc row_sum{};
+                for ( size_t x=0; x<width; ++x )
+                    row_sum += static_cast<Acc>( src[x] );
+                result += row_sum;
+            }
+
+            return result;
+        }
+    }
+
+    /// sum of all pixels of \a e
+    template < typename E,
+               typename = detail::enable_reduce_t<E> >
+    auto sum( const E& e )
+    {
+        const auto node = detail::as_expression( e );
+        using acc_t = detail::reduce_accumulator_t< detail::reduce_pixel_t<decltype(node)> >;
+        return detail::sum<decltype(node), acc_t>( node );
+    }
+
+    /// mean of all pixels of \a e; throws if \a e is empty
+    template < typename E,
+               typename = detail::enable_reduce_t<E> >
+    double mean( const E& e )
+    {
+        detail::require_not_empty( e, "mean" );
+        return static_cast<double>( sum( e ) ) / e.size().area();
+    }
+
+    /// population variance of the pixels of \a e; throws if \a e is
+    /// empty. Values are shifted by the first pixel before
+    /// accumulation, avoiding the cancellation of the naive
+    /// sum-of-squares formula when the variance is small relative to
+    /// the mean.
+    template < typename E,
+               typename = detail::enable_reduce_t<E> >
+    double variance( const E& e )
+    {
+        detail::require_not_empty( e, "variance" );
+
+        const auto node = detail::as_expression( e );
+        const auto [width, height] = node.size().components();
+        const double shift = static_cast<double>( node.row( 0 )[0] );
+
+        double total = 0, total_sqr = 0;
+        for ( size_t y=0; y<height; ++y )
+        {
+            const auto src = node.row( y );
+            for ( size_t x=0; x<width; ++x )
+            {
+                const double v = static_cast<double>( src[x] ) - shift;
+                total += v;
+                total_sqr += v*v;
+            }
+        }
+
+        const double n = node.size().area();
+        return ( total_sqr - total*total/n ) / n;
+    }
+
+    /// sum of the products of corresponding pixels of \a a and \a b;
+    /// throws if the sizes differ
+    template < typename LE,
+               typename RE,
+               typename = detail::enable_reduce_t<LE>,
+               typename = detail::enable_reduce_t<RE> >
+    auto dot( const LE& a, const RE& b )
+    {
+        if ( a.size() != b.size() )
+            exception_builder<std::runtime_error>()
+                << "dot: sizes don't match: " << a.size() << ", " << b.size();
+
+        const auto l = detail::as_expression( a );
+        const auto r = detail::as_expression( b );
+        using acc_t = detail::reduce_accumulator_t< detail::reduce_pixel_t<decltype(l)> >;
+
+        const auto [width, height] = l.size().components();
+        acc_t result{};
+        for ( size_t y=0; y<height; ++y )
+        {
+            const auto lrow = l.row( y );
+            const auto rrow = r.row( y );
+            acc_t row_sum{};
+            for ( size_t x=0; x<width; ++x )
+                row_sum += static_cast<acc_t>( lrow[x] ) * static_cast<acc_t>( rrow[x] );
+            result += row_sum;
+        }
+
+        return result;
+    }
+
+    /// minimum and maximum pixel values of \a e; throws if \a e is empty
+    template < typename E,
+               typename = detail::enable_reduce_t<E> >
+    auto minmax( const E& e )
+    {
+        detail::require_not_empty( e, "minmax" );
+
+        const auto node = detail::as_expression( e );
+        using pixel_t = detail::reduce_pixel_t<decltype(node)>;
+        using value_t = typename pixel_t::value_t;
+
+        const auto [width, height] = node.size().components();
+        value_t min, max;
+        min = max = static_cast<value_t>( node.row( 0 )[0] );
+        for ( size_t y=0; y<height; ++y )
+        {
+            const auto src = node.row( y );
+            for ( size_t x=0; x<width; ++x )
+            {
+                const value_t v = static_cast<value_t>( src[x] );
+                min = v < min ? v : min;
+                max = v > max ? v : max;
+            }
+        }
+
+        return std::make_tuple( pixel_t{ min }, pixel_t{ max } );
+    }
+
+    /// location, in the local coordinates of \a e, of the first pixel
+    /// in row-major order with the largest value; throws if \a e is
+    /// empty
+    template < typename E,
+               typename = detail::enable_reduce_t<E> >
+    point2<uint32_t> argmax( const E& e )
+    {
+        detail::require_not_empty( e, "argmax" );
+
+        const auto node = detail::as_expression( e );
+        using value_t = typename detail::reduce_pixel_t<decltype(node)>::value_t;
+
+        const auto [width, height] = node.size().components();
+        value_t max = static_cast<value_t>( node.row( 0 )[0] );
+        point2<uint32_t> result{ 0, 0 };
+        for ( uint32_t y=0; y<height; ++y )
+        {
+            const auto src = node.row( y );
+            for ( uint32_t x=0; x<width; ++x )
+            {
+                const value_t v = static_cast<value_t>( src[x] );
+                if ( v > max )
+                {
+                    max = v;
+                    result = { x, y };
+                }
+            }
+        }
+
+        return result;
+    }
+
+}
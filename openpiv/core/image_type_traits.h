@@ -9,6 +9,7 @@ namespace openpiv::core {
 // forwards
 template < typename ContainedT > class image_view;
 template < typename ContainedT > class image;
+template < typename T > class cplanar_image;
 
 template <typename T>
 struct is_imagetype : std::false_type
@@ -25,4 +26,12 @@ struct is_imagetype<image_view<ContainedT>> : std::true_type
 template <typename T>
 inline constexpr bool is_imagetype_v = is_imagetype<T>::value;
 
+/// planar complex images; these are specialized in cplanar_image.h
+template <typename T>
+struct is_cplanar_imagetype : std::false_type
+{};
+
+template <typename T>
+inline constexpr bool is_cplanar_imagetype_v = is_cplanar_imagetype<T>::value;
+
 }
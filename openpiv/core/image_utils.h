@@ -190,7 +190,8 @@ ReturnT& swap_quadrants( ImageT<ContainedT>& in );
 
 
 /// extract a new image from existing image; similar to forming an
-/// image_view but actually copying the data
+/// image_view but actually copying the data. Extracting the whole of
+/// a shareable image (see \sa image::share) shares its pixels
 template < template<typename> class ImageT,
            typename  ContainedT >
 image<ContainedT> extract( const ImageT<ContainedT>& im, core::rect r );
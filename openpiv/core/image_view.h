@@ -78,27 +78,37 @@ namespace openpiv::core {
         }
         inline bool operator!=(const image_view& rhs) const { return !operator==(rhs); }
 
-        inline T& operator[](size_t i)
-        {
-            if ( i > r_.area() )
-                core::exception_builder<std::out_of_range>() << "index outside of allowed area: " << i << " > " << r_.area();
-
-            const rect::point_t iv_location{ i % r_.width(), i / r_.width() };
-            return im_->operator[]({
-                    r_.left() + iv_location[0],
-                    r_.bottom() + iv_location[1]
-                });
-        }
-        inline const T& operator[](size_t i) const { return const_cast<image_view<T>*>(this)->operator[](i); }
-
-        inline T& operator[]( const point2<uint32_t>& xy )
-        {
-            return this->operator[](xy[1]*r_.width() + xy[0]);
-        }
-        inline const T& operator[]( const point2<uint32_t>& xy ) const { return const_cast<image_view<T>*>(this)->operator[](xy); }
+        /// in-place arithmetic with an image, image_view, expression or
+        /// value of the same pixel type, in a single pass and without a
+        /// temporary; see \sa compound_assign for the aliasing contract
+        template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+        image_view& operator+=(const R& rhs) { return compound_assign<plus_op>( *this, rhs ); }
+        template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+        image_view& operator-=(const R& rhs) { return compound_assign<minus_op>( *this, rhs ); }
+        template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+        image_view& operator*=(const R& rhs) { return compound_assign<mult_op>( *this, rhs ); }
+        template <typename R, typename = typename std::enable_if_t< is_compound_operand_v<R, T> > >
+        image_view& operator/=(const R& rhs) { return compound_assign<div_op>( *this, rhs ); }
+
+        /// pixel accessor; \a i is the index of the pixel in row-major
+        /// order. This requires a division per access; to visit every
+        /// pixel prefer \sa rows or the iterators
+        inline T& operator[](size_t i) { return (*this)[ to_point( i ) ]; }
+        inline const T& operator[](size_t i) const { return (*this)[ to_point( i ) ]; }
+
+        inline T& operator[]( const point2<uint32_t>& xy ) { return im_->operator[]( to_image( xy ) ); }
+        inline const T& operator[]( const point2<uint32_t>& xy ) const { return im_->operator[]( to_image( xy ) ); }
 
         inline const T* line(size_t i) const { return im_->line(r_.bottom() + i) + r_.left(); }
         inline T* line(size_t i) { return im_->line(r_.bottom() + i) + r_.left(); }
+
+        /// pointer to the first pixel of the view; together with
+        /// \sa stride this describes the viewed pixels in place, so
+        /// rows are not contiguous unless the view spans the full
+        /// width of the underlying image
+        inline const T* data() const { return line(0); }
+        inline T* data() { return line(0); }
+
         inline uint32_t width() const { return r_.width(); }
         inline uint32_t height() const { return r_.height(); }
         inline core::size size() const { return r_.size(); }
@@ -112,75 +122,28 @@ namespace openpiv::core {
             };
         }
 
-        class iterator
+        /// iterators; these visit the pixels in row-major order,
+        /// skipping the parts of the underlying image outside the view
+        using iterator = pitched_iterator<T>;
+        using const_iterator = pitched_iterator<const T>;
+
+        iterator begin() { return pixel_count() ? iterator{ data(), width(), pitch() } : iterator{}; }
+        iterator end() { return pixel_count() ? iterator{ data() + height()*pitch(), width(), pitch() } : iterator{}; }
+        const_iterator begin() const { return pixel_count() ? const_iterator{ data(), width(), pitch() } : const_iterator{}; }
+        const_iterator end() const { return pixel_count() ? const_iterator{ data() + height()*pitch(), width(), pitch() } : const_iterator{}; }
+
+        /// rows of the view as a range of contiguous \sa row_span
+        inline row_range<T> rows()
         {
-        public:
-            using iterator_category = std::bidirectional_iterator_tag;
-            using value_type = pixel_t;
-            using difference_type = typename image<T>::data_t::difference_type;
-            using pointer = pixel_t*;
-            using reference = pixel_t&;
-
-            explicit iterator( image_view& iv, index_t i = 0 ) : iv_( iv ), i_( i ) {}
-            iterator& operator++() { ++i_; return *this; }
-            iterator operator++(int) { iterator result = *this; operator++(); return result; }
-            iterator& operator--() { --i_; return *this; }
-            iterator operator--(int) { iterator result = *this; operator--(); return result; }
-            bool operator==(const iterator& rhs) const { return iv_ == rhs.iv_ && i_ == rhs.i_; }
-            bool operator!=(const iterator& rhs) const { return !operator==(rhs); }
-
-            pixel_t& operator*()
-            {
-                if ( i_ < 0 || i_ >= iv_.pixel_count() )
-                    core::exception_builder< std::out_of_range >()
-                        << "attempting to dereference out of range iterator: "
-                        << i_ << ", " << iv_.pixel_count();
-
-                return iv_[ {i_ % iv_.width(), i_ / iv_.width()} ];
-            }
-
-        private:
-            image_view& iv_;
-            index_t i_ = {};
-        };
-
-        class const_iterator
+            return pixel_count() ? row_range<T>{ data(), width(), pitch(), height() } : row_range<T>{};
+        }
+        inline row_range<const T> rows() const
         {
-        public:
-            using iterator_category = std::bidirectional_iterator_tag;
-            using value_type = pixel_t;
-            using difference_type = typename image<T>::data_t::difference_type;
-            using pointer = pixel_t*;
-            using reference = pixel_t&;
-
-            explicit const_iterator( const image_view& iv, index_t i = 0 ) : iv_( iv ), i_( i ) {}
-            const_iterator& operator++() { ++i_; return *this; }
-            const_iterator operator++(int) { const_iterator result = *this; operator++(); return result; }
-            const_iterator& operator--() { --i_; return *this; }
-            const_iterator operator--(int) { const_iterator result = *this; operator--(); return result; }
-            bool operator==(const const_iterator& rhs) const { return iv_ == rhs.iv_ && i_ == rhs.i_; }
-            bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
-
-            const pixel_t& operator*()
-            {
-                if ( i_ < 0 || i_ >= iv_.pixel_count() )
-                    core::exception_builder< std::out_of_range >()
-                        << "attempting to dereference out of range iterator: "
-                        << i_ << ", " << iv_.pixel_count();
-
-                return iv_[ {i_ % iv_.width(), i_ / iv_.width()} ];
-            }
-
-        private:
-            const image_view& iv_;
-            index_t i_ = {};
-        };
-
-        /// iterators
-        iterator begin() { return iterator( *this ); }
-        iterator end() { return iterator( *this, pixel_count() ); }
-        const_iterator begin() const { return const_iterator( *this ); }
-        const_iterator end() const { return const_iterator( *this, pixel_count() ); }
+            return pixel_count() ? row_range<const T>{ data(), width(), pitch(), height() } : row_range<const T>{};
+        }
+
+        /// distance between the starts of successive rows, in pixels
+        inline size_t pitch() const { return im_->pitch(); }
 
         std::tuple<size_t, size_t> stride() const
         {
@@ -193,6 +156,25 @@ namespace openpiv::core {
         const image<T>& underlying() const { return *im_; }
 
     private:
+        /// local point of pixel \a i in row-major order
+        point2<uint32_t> to_point( size_t i ) const
+        {
+            if ( i > r_.area() )
+                core::exception_builder<std::out_of_range>() << "index outside of allowed area: " << i << " > " << r_.area();
+
+            return { static_cast<uint32_t>(i % r_.width()), static_cast<uint32_t>(i / r_.width()) };
+        }
+
+        /// point of the underlying image for local point \a xy
+        point2<uint32_t> to_image( const point2<uint32_t>& xy ) const
+        {
+            if ( xy[1]*r_.width() + xy[0] > r_.area() )
+                core::exception_builder<std::out_of_range>()
+                    << "index outside of allowed area: " << xy << " > " << r_.size();
+
+            return { r_.left() + xy[0], r_.bottom() + xy[1] };
+        }
+
         image_view( image<T>& im, const core::rect& r )
             : im_(&im)
             , r_(r)
@@ -0,0 +1,158 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// local
+#include "core/exception_builder.h"
+#include "core/image_type_traits.h"
+#include "core/pixel_types.h"
+#include "core/rect.h"
+#include "core/size.h"
+
+namespace openpiv::core {
+
+    namespace detail {
+
+        /// sums of 8 and 16-bit pixels, and their squares, are exact in
+        /// 64-bit integers; anything else is accumulated as double
+        template < typename V >
+        using integral_accumulator_t =
+            std::conditional_t< std::is_integral_v<V> && (sizeof(V) <= 2), int64_t, double >;
+
+    }
+
+    /// summed-area tables of the pixel values of an image and of their
+    /// squares, giving the sum, mean, variance and energy of any
+    /// rectangle in constant time, e.g. to normalise or mask
+    /// interrogation windows without visiting their pixels.
+    ///
+    /// The tables hold (width + 1) x (height + 1) values: entry (x, y)
+    /// is the sum over pixels [0, x) x [0, y), so the first row and
+    /// column are zero. \sa reset rebuilds the tables for a new frame
+    /// reusing their storage.
+    template < typename T >
+    class integral_image
+    {
+        static_assert( is_real_mono_pixeltype_v<T>, "integral_image requires greyscale pixels" );
+
+    public:
+        using pixel_t = T;
+        using value_t = detail::integral_accumulator_t<typename T::value_t>;
+
+        integral_image() = default;
+
+        template < template <typename> class ImageT,
+                   typename = typename std::enable_if_t< is_imagetype_v<ImageT<T>> > >
+        explicit integral_image( const ImageT<T>& im )
+        {
+            reset( im );
+        }
+
+        /// rebuild the tables from \a im in a single pass: each row is
+        /// prefix-summed, then the row above is added a whole row at a
+        /// time
+        template < template <typename> class ImageT,
+                   typename = typename std::enable_if_t< is_imagetype_v<ImageT<T>> > >
+        void reset( const ImageT<T>& im )
+        {
+            size_ = im.size();
+            stride_ = size_t{ size_.width() } + 1;
+            sum_.assign( stride_ * (size_.height() + 1), value_t{} );
+            sum_sqr_.assign( sum_.size(), value_t{} );
+
+            const size_t w = size_.width();
+            for ( size_t y=0; y<size_.height(); ++y )
+            {
+                const auto* src = im.line( y );
+                const value_t* above = sum_.data() + y*stride_ + 1;
+                const value_t* above_sqr = sum_sqr_.data() + y*stride_ + 1;
+                value_t* row = sum_.data() + (y + 1)*stride_ + 1;
+                value_t* row_sqr = sum_sqr_.data() + (y + 1)*stride_ + 1;
+
+                value_t s{}, ss{};
+                for ( size_t x=0; x<w; ++x )
+                {
+                    const auto v = static_cast<value_t>( src[x].v );
+                    s += v;
+                    ss += v*v;
+                    row[x] = s;
+                    row_sqr[x] = ss;
+                }
+
+#if defined(__clang__)
+                #pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+                #pragma GCC ivdep
+#endif
+                for ( size_t x=0; x<w; ++x )
+                {
+                    row[x] += above[x];
+                    row_sqr[x] += above_sqr[x];
+                }
+            }
+        }
+
+        /// size of the source image
+        inline const core::size& size() const { return size_; }
+
+        /// true if \a r lies within the source image
+        inline bool contains( const core::rect& r ) const
+        {
+            return r.left() >= 0 && r.bottom() >= 0 &&
+                static_cast<int64_t>( r.right() ) <= size_.width() &&
+                static_cast<int64_t>( r.top() ) <= size_.height();
+        }
+
+        /// sum of the pixels in \a r; throws std::out_of_range if
+        /// \a r doesn't lie within the image
+        inline value_t sum( const core::rect& r ) const { return lookup( sum_, r ); }
+
+        /// sum of the squared pixels in \a r, i.e. its energy
+        inline value_t sum_sqr( const core::rect& r ) const { return lookup( sum_sqr_, r ); }
+
+        /// mean pixel value in \a r; 0 for an empty rect
+        double mean( const core::rect& r ) const
+        {
+            return r.area() ? static_cast<double>( sum( r ) ) / r.area() : 0.0;
+        }
+
+        /// population variance of the pixels in \a r
+        double variance( const core::rect& r ) const
+        {
+            if ( r.area() == 0 )
+                return 0.0;
+
+            const double n = r.area();
+            const double m = static_cast<double>( sum( r ) ) / n;
+            return std::max( 0.0, static_cast<double>( sum_sqr( r ) ) / n - m*m );
+        }
+
+        inline double stddev( const core::rect& r ) const { return std::sqrt( variance( r ) ); }
+
+    private:
+        value_t lookup( const std::vector<value_t>& table, const core::rect& r ) const
+        {
+            if ( !contains( r ) )
+                exception_builder<std::out_of_range>()
+                    << "integral_image: " << r << " is not within " << size_;
+
+            const size_t b = static_cast<size_t>( r.bottom() ) * stride_;
+            const size_t t = static_cast<size_t>( r.top() ) * stride_;
+            const size_t l = r.left();
+            const size_t rt = r.right();
+            return table[t + rt] - table[b + rt] - table[t + l] + table[b + l];
+        }
+
+        core::size size_;
+        size_t stride_ = 0;
+        std::vector<value_t> sum_;
+        std::vector<value_t> sum_sqr_;
+    };
+
+}
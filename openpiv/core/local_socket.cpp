@@ -0,0 +1,228 @@
+#include "core/local_socket.h"
+
+// std
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+// platform
+#if !defined(_WIN32)
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#  include <cerrno>
+#endif
+
+// local
+#include "core/exception_builder.h"
+
+namespace openpiv::core {
+
+#if defined(_WIN32)
+
+    bool has_local_socket()
+    {
+        return false;
+    }
+
+    local_socket local_socket::connect( const std::string& )
+    {
+        throw std::runtime_error( "local sockets are not supported on this platform" );
+    }
+
+    local_socket local_socket::listen( const std::string&, int )
+    {
+        throw std::runtime_error( "local sockets are not supported on this platform" );
+    }
+
+    local_socket local_socket::accept()
+    {
+        return {};
+    }
+
+    bool local_socket::wait_readable( std::chrono::milliseconds ) const
+    {
+        return false;
+    }
+
+    void local_socket::send_all( const void*, size_t )
+    {}
+
+    bool local_socket::receive_all( void*, size_t )
+    {
+        return false;
+    }
+
+    void local_socket::close()
+    {}
+
+#else
+
+    namespace {
+
+        sockaddr_un make_address( const std::string& path )
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if ( path.size() >= sizeof(address.sun_path) )
+                exception_builder<std::runtime_error>() << "socket path is too long: " << path;
+
+            std::memcpy( address.sun_path, path.c_str(), path.size() + 1 );
+            return address;
+        }
+
+        int make_socket()
+        {
+            const int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+            if ( fd < 0 )
+                exception_builder<std::runtime_error>() << "failed to create socket: " << std::strerror( errno );
+
+            return fd;
+        }
+
+    }
+
+    bool has_local_socket()
+    {
+        return true;
+    }
+
+    local_socket local_socket::connect( const std::string& path )
+    {
+        const auto address = make_address( path );
+        local_socket result( make_socket() );
+        if ( ::connect( result.fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address) ) != 0 )
+            exception_builder<std::runtime_error>() << "failed to connect to " << path << ": " << std::strerror( errno );
+
+        return result;
+    }
+
+    local_socket local_socket::listen( const std::string& path, int backlog )
+    {
+        const auto address = make_address( path );
+        ::unlink( path.c_str() );
+
+        local_socket result( make_socket() );
+        if ( ::bind( result.fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address) ) != 0 )
+            exception_builder<std::runtime_error>() << "failed to bind to " << path << ": " << std::strerror( errno );
+        result.path_ = path;
+
+        if ( ::listen( result.fd_, backlog ) != 0 )
+            exception_builder<std::runtime_error>() << "failed to listen on " << path << ": " << std::strerror( errno );
+
+        return result;
+    }
+
+    local_socket local_socket::accept()
+    {
+        int fd = -1;
+        do
+        {
+            fd = ::accept( fd_, nullptr, nullptr );
+        } while ( fd < 0 && errno == EINTR );
+
+        if ( fd < 0 )
+            exception_builder<std::runtime_error>() << "failed to accept connection: " << std::strerror( errno );
+
+        return local_socket( fd );
+    }
+
+    bool local_socket::wait_readable( std::chrono::milliseconds timeout ) const
+    {
+        pollfd p{ fd_, POLLIN, 0 };
+        const int result = ::poll( &p, 1, static_cast<int>(timeout.count()) );
+        if ( result < 0 && errno != EINTR )
+            exception_builder<std::runtime_error>() << "failed to poll socket: " << std::strerror( errno );
+
+        return result > 0;
+    }
+
+    void local_socket::send_all( const void* data, size_t size )
+    {
+        const auto* p = static_cast<const char*>( data );
+        while ( size > 0 )
+        {
+            // report a closed peer as an error rather than SIGPIPE
+            const ssize_t sent = ::send( fd_, p, size, MSG_NOSIGNAL );
+            if ( sent < 0 )
+            {
+                if ( errno == EINTR )
+                    continue;
+                exception_builder<std::runtime_error>() << "failed to send: " << std::strerror( errno );
+            }
+
+            p += sent;
+            size -= static_cast<size_t>(sent);
+        }
+    }
+
+    bool local_socket::receive_all( void* data, size_t size )
+    {
+        auto* p = static_cast<char*>( data );
+        size_t received = 0;
+        while ( received < size )
+        {
+            const ssize_t r = ::recv( fd_, p + received, size - received, 0 );
+            if ( r < 0 )
+            {
+                if ( errno == EINTR )
+                    continue;
+                exception_builder<std::runtime_error>() << "failed to receive: " << std::strerror( errno );
+            }
+
+            if ( r == 0 )
+            {
+                if ( received == 0 )
+                    return false;
+                exception_builder<std::runtime_error>() << "connection closed after " << received << " of " << size << " bytes";
+            }
+
+            received += static_cast<size_t>(r);
+        }
+
+        return true;
+    }
+
+    void local_socket::close()
+    {
+        if ( fd_ >= 0 )
+            ::close( fd_ );
+        if ( !path_.empty() )
+            ::unlink( path_.c_str() );
+
+        fd_ = -1;
+        path_.clear();
+    }
+
+#endif
+
+    local_socket::local_socket( int fd, std::string path )
+        : fd_( fd )
+        , path_( std::move( path ) )
+    {}
+
+    local_socket::local_socket( local_socket&& rhs )
+    {
+        swap( rhs );
+    }
+
+    local_socket& local_socket::operator=( local_socket&& rhs )
+    {
+        local_socket tmp( std::move( rhs ) );
+        swap( tmp );
+        return *this;
+    }
+
+    local_socket::~local_socket()
+    {
+        close();
+    }
+
+    void local_socket::swap( local_socket& rhs )
+    {
+        std::swap( fd_, rhs.fd_ );
+        std::swap( path_, rhs.path_ );
+    }
+
+}
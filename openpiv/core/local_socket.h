@@ -0,0 +1,61 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace openpiv::core {
+
+    /// \returns true if \sa local_socket is supported on this platform
+    bool has_local_socket();
+
+    /// a connected or listening Unix domain stream socket
+    ///
+    /// This class is move-only and not thread-safe.
+    class local_socket
+    {
+    public:
+        local_socket() = default;
+
+        /// connect to the listening socket at \a path; throws
+        /// std::runtime_error on failure
+        static local_socket connect( const std::string& path );
+
+        /// listen at \a path, replacing any stale socket file; the
+        /// file is removed when the socket is closed
+        static local_socket listen( const std::string& path, int backlog = 4 );
+
+        local_socket( local_socket&& rhs );
+        local_socket& operator=( local_socket&& rhs );
+        local_socket( const local_socket& ) = delete;
+        local_socket& operator=( const local_socket& ) = delete;
+        ~local_socket();
+
+        /// accept a connection on a listening socket
+        local_socket accept();
+
+        /// \returns true if data (or a connection, or end of stream)
+        /// is available within \a timeout
+        bool wait_readable( std::chrono::milliseconds timeout ) const;
+
+        /// send all \a size bytes of \a data
+        void send_all( const void* data, size_t size );
+
+        /// receive exactly \a size bytes into \a data; \returns false
+        /// if the peer closed the connection before sending anything,
+        /// throws std::runtime_error if it closed part way through
+        bool receive_all( void* data, size_t size );
+
+        bool is_open() const { return fd_ >= 0; }
+        void close();
+        void swap( local_socket& rhs );
+
+    private:
+        explicit local_socket( int fd, std::string path = {} );
+
+        int fd_ = -1;
+        std::string path_;      ///< socket file to remove on close
+    };
+
+}
@@ -167,6 +167,22 @@ namespace openpiv::core::logger {
             max_entries = s;
         }
 
+        /// fork() support: the logging thread isn't copied into a
+        /// child process, so logging is disabled in the child. Call
+        /// prepare_fork() just before fork() and fork_completed() just
+        /// after it, in both parent and child
+        void prepare_fork()
+        {
+            entry_mutex.lock();
+        }
+
+        void fork_completed(bool child)
+        {
+            if (child)
+                stop = true;
+            entry_mutex.unlock();
+        }
+
         void wait_until_written(size_t entry_id) const
         {
             using namespace std::chrono_literals;
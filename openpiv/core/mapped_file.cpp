@@ -0,0 +1,196 @@
+#include "core/mapped_file.h"
+
+// std
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+// platform
+#if defined(_WIN32)
+#  define NOMINMAX
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <cerrno>
+#endif
+
+// local
+#include "core/exception_builder.h"
+
+namespace openpiv::core {
+
+#if defined(_WIN32)
+
+    mapped_file::mapped_file( const std::string& path, mode m )
+    {
+        const DWORD access = m == mode::READ_WRITE ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+        HANDLE file = CreateFileA( path.c_str(), access, FILE_SHARE_READ, nullptr,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if ( file == INVALID_HANDLE_VALUE )
+            exception_builder<std::runtime_error>() << "failed to open " << path;
+        handle_ = reinterpret_cast<intptr_t>(file);
+
+        LARGE_INTEGER size;
+        if ( !GetFileSizeEx( file, &size ) )
+        {
+            close();
+            exception_builder<std::runtime_error>() << "failed to get size of " << path;
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if ( size_ == 0 )
+            return;
+
+        const DWORD protect = m == mode::READ_WRITE ? PAGE_READWRITE : (m == mode::COPY_ON_WRITE ? PAGE_WRITECOPY : PAGE_READONLY);
+        HANDLE mapping = CreateFileMappingA( file, nullptr, protect, 0, 0, nullptr );
+        if ( !mapping )
+        {
+            close();
+            exception_builder<std::runtime_error>() << "failed to map " << path;
+        }
+        mapping_ = reinterpret_cast<intptr_t>(mapping);
+
+        const DWORD view_access = m == mode::READ_WRITE ? FILE_MAP_WRITE : (m == mode::COPY_ON_WRITE ? FILE_MAP_COPY : FILE_MAP_READ);
+        data_ = MapViewOfFile( mapping, view_access, 0, 0, 0 );
+        if ( !data_ )
+        {
+            close();
+            exception_builder<std::runtime_error>() << "failed to map " << path;
+        }
+    }
+
+    mapped_file mapped_file::create( const std::string& path, size_t size )
+    {
+        HANDLE file = CreateFileA( path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                                   CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if ( file == INVALID_HANDLE_VALUE )
+            exception_builder<std::runtime_error>() << "failed to create " << path;
+
+        LARGE_INTEGER li;
+        li.QuadPart = static_cast<LONGLONG>(size);
+        if ( !SetFilePointerEx( file, li, nullptr, FILE_BEGIN ) || !SetEndOfFile( file ) )
+        {
+            CloseHandle( file );
+            exception_builder<std::runtime_error>() << "failed to resize " << path << " to " << size << " bytes";
+        }
+        CloseHandle( file );
+
+        return mapped_file( path, mode::READ_WRITE );
+    }
+
+    void mapped_file::flush()
+    {
+        if ( data_ )
+            FlushViewOfFile( data_, 0 );
+    }
+
+    void mapped_file::close()
+    {
+        if ( data_ )
+            UnmapViewOfFile( data_ );
+        if ( mapping_ != invalid_handle )
+            CloseHandle( reinterpret_cast<HANDLE>(mapping_) );
+        if ( handle_ != invalid_handle )
+            CloseHandle( reinterpret_cast<HANDLE>(handle_) );
+
+        data_ = nullptr;
+        size_ = 0;
+        mapping_ = invalid_handle;
+        handle_ = invalid_handle;
+    }
+
+#else
+
+    mapped_file::mapped_file( const std::string& path, mode m )
+    {
+        const int fd = ::open( path.c_str(), m == mode::READ_WRITE ? O_RDWR : O_RDONLY );
+        if ( fd < 0 )
+            exception_builder<std::runtime_error>() << "failed to open " << path << ": " << std::strerror( errno );
+        handle_ = fd;
+
+        struct stat st;
+        if ( ::fstat( fd, &st ) != 0 )
+        {
+            close();
+            exception_builder<std::runtime_error>() << "failed to get size of " << path << ": " << std::strerror( errno );
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if ( size_ == 0 )
+            return;
+
+        const int protect = m == mode::READ_ONLY ? PROT_READ : (PROT_READ | PROT_WRITE);
+        const int flags = m == mode::READ_WRITE ? MAP_SHARED : MAP_PRIVATE;
+        void* p = ::mmap( nullptr, size_, protect, flags, fd, 0 );
+        if ( p == MAP_FAILED )
+        {
+            close();
+            exception_builder<std::runtime_error>() << "failed to map " << path << ": " << std::strerror( errno );
+        }
+        data_ = p;
+    }
+
+    mapped_file mapped_file::create( const std::string& path, size_t size )
+    {
+        const int fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if ( fd < 0 )
+            exception_builder<std::runtime_error>() << "failed to create " << path << ": " << std::strerror( errno );
+
+        if ( ::ftruncate( fd, static_cast<off_t>(size) ) != 0 )
+        {
+            ::close( fd );
+            exception_builder<std::runtime_error>() << "failed to resize " << path << " to " << size << " bytes: " << std::strerror( errno );
+        }
+        ::close( fd );
+
+        return mapped_file( path, mode::READ_WRITE );
+    }
+
+    void mapped_file::flush()
+    {
+        if ( data_ )
+            ::msync( data_, size_, MS_SYNC );
+    }
+
+    void mapped_file::close()
+    {
+        if ( data_ )
+            ::munmap( data_, size_ );
+        if ( handle_ != invalid_handle )
+            ::close( static_cast<int>(handle_) );
+
+        data_ = nullptr;
+        size_ = 0;
+        handle_ = invalid_handle;
+    }
+
+#endif
+
+    mapped_file::mapped_file( mapped_file&& rhs )
+    {
+        swap( rhs );
+    }
+
+    mapped_file& mapped_file::operator=( mapped_file&& rhs )
+    {
+        mapped_file tmp( std::move( rhs ) );
+        swap( tmp );
+        return *this;
+    }
+
+    mapped_file::~mapped_file()
+    {
+        close();
+    }
+
+    void mapped_file::swap( mapped_file& rhs )
+    {
+        std::swap( data_, rhs.data_ );
+        std::swap( size_, rhs.size_ );
+        std::swap( handle_, rhs.handle_ );
+        std::swap( mapping_, rhs.mapping_ );
+    }
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace openpiv::core {
+
+    /// a file mapped into memory; the mapping is released when the
+    /// object is destroyed or closed.
+    ///
+    /// This class is move-only and not thread-safe, although
+    /// distinct threads may access distinct regions of the mapped
+    /// data concurrently.
+    class mapped_file
+    {
+    public:
+        enum class mode {
+            READ_ONLY,      ///< map an existing file read-only
+            COPY_ON_WRITE,  ///< map an existing file; writes are private to this mapping
+            READ_WRITE      ///< map an existing file; writes go to the file
+        };
+
+        mapped_file() = default;
+
+        /// map the existing file at \a path; throws std::runtime_error
+        /// on failure
+        explicit mapped_file( const std::string& path, mode m = mode::READ_ONLY );
+
+        /// create (or truncate) the file at \a path to \a size bytes and
+        /// map it read-write
+        static mapped_file create( const std::string& path, size_t size );
+
+        mapped_file( mapped_file&& rhs );
+        mapped_file& operator=( mapped_file&& rhs );
+        mapped_file( const mapped_file& ) = delete;
+        mapped_file& operator=( const mapped_file& ) = delete;
+        ~mapped_file();
+
+        /// access to the mapped bytes
+        inline uint8_t* data() { return static_cast<uint8_t*>(data_); }
+        inline const uint8_t* data() const { return static_cast<const uint8_t*>(data_); }
+        inline size_t size() const { return size_; }
+        inline bool is_open() const { return data_ != nullptr || handle_ != invalid_handle; }
+
+        /// write modified pages back to the file; only meaningful
+        /// for mode::READ_WRITE
+        void flush();
+
+        /// release the mapping and the file
+        void close();
+
+        /// swap
+        void swap( mapped_file& rhs );
+
+    private:
+        static constexpr intptr_t invalid_handle = -1;
+
+        void* data_ = nullptr;
+        size_t size_ = 0;
+        intptr_t handle_ = invalid_handle;   ///< file descriptor or HANDLE
+        intptr_t mapping_ = invalid_handle;  ///< mapping HANDLE; unused on POSIX
+    };
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// local
+#include "core/exception_builder.h"
+#include "core/image.h"
+#include "core/mapped_file.h"
+#include "core/size.h"
+
+namespace openpiv::core {
+
+    /// \returns an image of size \a s whose pixels are read in place
+    /// from \a file, without copying, starting \a offset bytes into
+    /// the file with rows \a pitch pixels apart (0 for packed rows);
+    /// the image keeps the mapping alive.
+    ///
+    /// Pixels are used as stored, i.e. in host byte order: this suits
+    /// raw frames and 8-bit binary PGM data, but not 16-bit PGM data
+    /// which is big-endian. Frames of a stack in a single file are
+    /// mapped by sharing \a file and varying \a offset. If \a file is
+    /// mapped mapped_file::mode::READ_ONLY pixels must not be written;
+    /// use mapped_file::mode::COPY_ON_WRITE for private changes.
+    ///
+    /// Throws std::runtime_error if the region lies outside the file
+    /// or \a offset isn't aligned for the pixel's value type
+    template < typename T >
+    image<T> map_image( std::shared_ptr<mapped_file> file,
+                        const core::size& s,
+                        size_t offset = 0,
+                        size_t pitch = 0 )
+    {
+        if ( s.area() == 0 )
+            return image<T>{ s };
+
+        if ( pitch == 0 )
+            pitch = s.width();
+        if ( pitch < s.width() )
+            exception_builder<std::runtime_error>()
+                << "map_image: pitch (" << pitch << ") is less than the image width (" << s.width() << ")";
+
+        constexpr size_t alignment = alignof(typename T::value_t);
+        if ( offset % alignment != 0 )
+            exception_builder<std::runtime_error>()
+                << "map_image: offset (" << offset << ") is not a multiple of the pixel alignment (" << alignment << ")";
+
+        const size_t bytes = ((s.height() - 1)*pitch + s.width())*sizeof(T);
+        if ( !file || !file->data() || offset + bytes > file->size() )
+            exception_builder<std::runtime_error>()
+                << "map_image: " << s << " image at offset " << offset << " requires " << offset + bytes
+                << " bytes, file has " << (file ? file->size() : 0);
+
+        T* data = reinterpret_cast<T*>( file->data() + offset );
+        return image<T>{ s, pitch, data, std::move( file ) };
+    }
+
+    /// map the file at \a path with mode \a m and return the image at
+    /// \a offset; see \sa map_image
+    template < typename T >
+    image<T> map_image( const std::string& path,
+                        const core::size& s,
+                        size_t offset = 0,
+                        size_t pitch = 0,
+                        mapped_file::mode m = mapped_file::mode::READ_ONLY )
+    {
+        return map_image<T>( std::make_shared<mapped_file>( path, m ), s, offset, pitch );
+    }
+
+}
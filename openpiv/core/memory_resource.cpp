@@ -0,0 +1,153 @@
+#include "core/memory_resource.h"
+
+// std
+#include <algorithm>
+#include <optional>
+
+// local
+#include "core/image_layout.h"
+
+namespace {
+
+    using namespace openpiv::core;
+
+    /// forwards to the heap, counting bytes in use
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        size_t allocated() const { return allocated_; }
+
+    private:
+        void* do_allocate( size_t bytes, size_t alignment ) override
+        {
+            void* p = std::pmr::new_delete_resource()->allocate( bytes, alignment );
+            allocated_ += bytes;
+            return p;
+        }
+
+        void do_deallocate( void* p, size_t bytes, size_t alignment ) override
+        {
+            std::pmr::new_delete_resource()->deallocate( p, bytes, alignment );
+            allocated_ -= bytes;
+        }
+
+        bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override
+        {
+            return this == &other;
+        }
+
+        size_t allocated_ = 0;
+    };
+
+    /// monotonic arena over a single buffer that grows to fit the
+    /// largest scope seen
+    class thread_arena
+    {
+    public:
+        static constexpr size_t initial_capacity = 1 << 20;
+        static constexpr size_t alignment = image_layout::max_alignment;
+
+        thread_arena()
+        {
+            reset( initial_capacity );
+        }
+
+        ~thread_arena()
+        {
+            arena_.reset();
+            std::pmr::new_delete_resource()->deallocate( buffer_, capacity_, alignment );
+        }
+
+        std::pmr::memory_resource* resource() { return &*arena_; }
+
+        /// reclaim everything allocated; if the buffer overflowed it is
+        /// enlarged to hold everything allocated since the last release
+        void release()
+        {
+            const size_t overflow = overflow_.allocated();
+            if ( overflow > 0 )
+            {
+                reset( std::max( 2*capacity_, capacity_ + 2*overflow ) );
+                ++stats_.grown;
+            }
+            else
+                arena_->release();
+
+            ++stats_.releases;
+        }
+
+        arena_stats stats() const
+        {
+            auto result = stats_;
+            result.capacity = capacity_;
+            return result;
+        }
+
+    private:
+        void reset( size_t capacity )
+        {
+            arena_.reset();
+            if ( buffer_ )
+                std::pmr::new_delete_resource()->deallocate( buffer_, capacity_, alignment );
+
+            capacity_ = capacity;
+            buffer_ = static_cast<std::byte*>( std::pmr::new_delete_resource()->allocate( capacity_, alignment ) );
+            arena_.emplace( buffer_, capacity_, &overflow_ );
+        }
+
+        std::byte* buffer_ = nullptr;
+        size_t capacity_ = 0;
+        counting_resource overflow_;
+        std::optional<std::pmr::monotonic_buffer_resource> arena_;
+        arena_stats stats_;
+    };
+
+    thread_local std::pmr::memory_resource* current_resource = nullptr;
+    thread_local size_t arena_depth = 0;
+
+    thread_arena& arena()
+    {
+        thread_local thread_arena arena_;
+        return arena_;
+    }
+
+}
+
+namespace openpiv::core {
+
+    std::pmr::memory_resource* thread_memory_resource()
+    {
+        return current_resource ? current_resource : std::pmr::new_delete_resource();
+    }
+
+    scoped_memory_resource::scoped_memory_resource( std::pmr::memory_resource* resource )
+        : previous_( current_resource )
+    {
+        current_resource = resource;
+    }
+
+    scoped_memory_resource::~scoped_memory_resource()
+    {
+        current_resource = previous_;
+    }
+
+    scoped_arena::scoped_arena()
+        : previous_( current_resource )
+    {
+        current_resource = arena().resource();
+        ++arena_depth;
+    }
+
+    scoped_arena::~scoped_arena()
+    {
+        current_resource = previous_;
+        if ( --arena_depth == 0 )
+            arena().release();
+    }
+
+    arena_stats scoped_arena::stats()
+    {
+        return arena().stats();
+    }
+
+}
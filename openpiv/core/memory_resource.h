@@ -0,0 +1,70 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <memory_resource>
+
+namespace openpiv::core {
+
+    /// \returns the memory resource used by the calling thread for new
+    /// allocations of image storage; this is
+    /// std::pmr::new_delete_resource() unless changed by a
+    /// \sa scoped_memory_resource or \sa scoped_arena
+    std::pmr::memory_resource* thread_memory_resource();
+
+    /// Use \a resource for image storage allocated by the calling
+    /// thread for the lifetime of this object; scopes may be nested.
+    ///
+    /// This is useful to ensure that long-lived images, e.g. caches
+    /// created lazily, don't use a \sa scoped_arena
+    class scoped_memory_resource
+    {
+    public:
+        explicit scoped_memory_resource( std::pmr::memory_resource* resource );
+        ~scoped_memory_resource();
+
+        scoped_memory_resource( const scoped_memory_resource& ) = delete;
+        scoped_memory_resource& operator=( const scoped_memory_resource& ) = delete;
+
+    private:
+        std::pmr::memory_resource* previous_;
+    };
+
+    /// statistics for the calling thread's arena
+    struct arena_stats
+    {
+        size_t capacity = 0;    ///< bytes available without further allocation
+        size_t releases = 0;    ///< number of times the arena was released
+        size_t grown = 0;       ///< number of times the capacity was increased
+    };
+
+    /// Allocate image storage from a per-thread monotonic arena for the
+    /// lifetime of this object.
+    ///
+    /// Allocation is a pointer increment and freeing is a no-op; all
+    /// memory is reclaimed at once when the outermost scoped_arena of
+    /// a thread is destroyed. The arena is a single buffer which, if
+    /// a scope needs more, is enlarged at the end of that scope so that
+    /// after warm-up a scope makes no calls to the system allocator.
+    ///
+    /// Images created within the scope must not outlive it: use this
+    /// for temporaries whose lifetime is e.g. a single interrogation
+    /// window. Copies of such images made outside the scope allocate
+    /// from the resource in use where the copy is made.
+    class scoped_arena
+    {
+    public:
+        scoped_arena();
+        ~scoped_arena();
+
+        scoped_arena( const scoped_arena& ) = delete;
+        scoped_arena& operator=( const scoped_arena& ) = delete;
+
+        /// statistics for the calling thread's arena
+        static arena_stats stats();
+
+    private:
+        std::pmr::memory_resource* previous_;
+    };
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// openpiv
+#include "core/exception_builder.h"
+
+namespace openpiv::core {
+
+    /// bounded multi-producer, multi-consumer lock-free queue
+    ///
+    /// Each slot carries a sequence number which tells producers and
+    /// consumers whether the slot is free for the current lap of the
+    /// ring; a push or pop claims a position with a single
+    /// compare-and-swap and never blocks. Capacity is rounded up to
+    /// a power of two.
+    ///
+    /// Blocking, if required, is left to the caller e.g. retry with
+    /// backoff; see \sa bounded_queue for a blocking, closable queue.
+    ///
+    /// This class is thread-safe
+    template < typename T >
+    class mpmc_queue
+    {
+    public:
+        explicit mpmc_queue( size_t capacity )
+        {
+            if ( capacity == 0 )
+                core::exception_builder<std::runtime_error>() << "mpmc_queue capacity must be non-zero";
+
+            size_t n = 2;
+            while ( n < capacity )
+                n *= 2;
+
+            cells_ = std::make_unique<cell[]>( n );
+            mask_ = n - 1;
+            for ( size_t i=0; i<n; ++i )
+                cells_[i].sequence.store( i, std::memory_order_relaxed );
+        }
+
+        mpmc_queue( const mpmc_queue& ) = delete;
+        mpmc_queue& operator=( const mpmc_queue& ) = delete;
+
+        /// try to push \a v; \returns false, leaving \a v untouched,
+        /// if the queue is full
+        bool try_push( T&& v )
+        {
+            size_t pos = enqueue_pos_.load( std::memory_order_relaxed );
+            cell* c = nullptr;
+            while ( true )
+            {
+                c = &cells_[pos & mask_];
+                const size_t sequence = c->sequence.load( std::memory_order_acquire );
+                const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                if ( diff == 0 )
+                {
+                    if ( enqueue_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                        break;
+                }
+                else if ( diff < 0 )
+                    return false;
+                else
+                    pos = enqueue_pos_.load( std::memory_order_relaxed );
+            }
+
+            c->data = std::move( v );
+            c->sequence.store( pos + 1, std::memory_order_release );
+            return true;
+        }
+
+        /// try to pop a value; \returns nothing if the queue is empty
+        std::optional<T> try_pop()
+        {
+            size_t pos = dequeue_pos_.load( std::memory_order_relaxed );
+            cell* c = nullptr;
+            while ( true )
+            {
+                c = &cells_[pos & mask_];
+                const size_t sequence = c->sequence.load( std::memory_order_acquire );
+                const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                if ( diff == 0 )
+                {
+                    if ( dequeue_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                        break;
+                }
+                else if ( diff < 0 )
+                    return {};
+                else
+                    pos = dequeue_pos_.load( std::memory_order_relaxed );
+            }
+
+            std::optional<T> result{ std::move( c->data ) };
+            c->data = T{};
+            c->sequence.store( pos + mask_ + 1, std::memory_order_release );
+            return result;
+        }
+
+        /// number of queued items; approximate whilst other threads
+        /// are pushing or popping
+        size_t size() const
+        {
+            const size_t enqueued = enqueue_pos_.load( std::memory_order_relaxed );
+            const size_t dequeued = dequeue_pos_.load( std::memory_order_relaxed );
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        size_t capacity() const { return mask_ + 1; }
+
+    private:
+        struct cell
+        {
+            std::atomic<size_t> sequence{ 0 };
+            T data{};
+        };
+
+        std::unique_ptr<cell[]> cells_;
+        size_t mask_ = 0;
+
+        // keep producer and consumer positions on separate cache lines
+        alignas(64) std::atomic<size_t> enqueue_pos_{ 0 };
+        alignas(64) std::atomic<size_t> dequeue_pos_{ 0 };
+    };
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// openpiv
+#include "core/bounded_queue.h"
+
+namespace openpiv::core {
+
+    /// timing information gathered from a pipeline run; each stage
+    /// time is the time spent inside that stage's function, so the
+    /// largest identifies the bottleneck
+    struct pipeline_stats
+    {
+        using duration_t = std::chrono::duration<double>;
+
+        size_t count = 0;
+        duration_t load_time{};
+        duration_t process_time{};
+        duration_t write_time{};
+        duration_t total_time{};
+    };
+
+    /// run a three stage load -> process -> write pipeline over the
+    /// items [0, count):
+    ///
+    /// - load is called on a dedicated loader thread as `L load(size_t i)`
+    /// - process is called on the calling thread as `P process(size_t i, L&&)`
+    /// - write is called on a dedicated writer thread as `void write(size_t i, P&&)`
+    ///
+    /// the stages are joined by bounded queues of capacity \a depth so
+    /// that loading of item N+1 and writing of item N-1 overlap with
+    /// processing of item N; items are processed and written in order.
+    ///
+    /// If any stage throws, the pipeline is stopped and the first
+    /// exception is rethrown on the calling thread.
+    template < typename LoadF,
+               typename ProcessF,
+               typename WriteF,
+               typename LoadedT = std::invoke_result_t<LoadF, size_t>,
+               typename ProcessedT = std::invoke_result_t<ProcessF, size_t, LoadedT&&>,
+               typename = std::enable_if_t< std::is_invocable_v<WriteF, size_t, ProcessedT&&> >
+               >
+    pipeline_stats run_pipeline( size_t count,
+                                 LoadF load,
+                                 ProcessF process,
+                                 WriteF write,
+                                 size_t depth = 1 )
+    {
+        using clock = std::chrono::steady_clock;
+
+        bounded_queue< std::tuple<size_t, LoadedT> > loaded( depth );
+        bounded_queue< std::tuple<size_t, ProcessedT> > processed( depth );
+
+        pipeline_stats stats;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto fail =
+            [&]( std::exception_ptr e )
+            {
+                {
+                    std::unique_lock<std::mutex> lock( error_mutex );
+                    if ( !error )
+                        error = e;
+                }
+                loaded.close();
+                processed.close();
+            };
+
+        const auto start = clock::now();
+
+        std::thread loader(
+            [&]()
+            {
+                try
+                {
+                    for ( size_t i=0; i<count; ++i )
+                    {
+                        const auto t = clock::now();
+                        LoadedT item{ load( i ) };
+                        stats.load_time += clock::now() - t;
+
+                        if ( !loaded.push( { i, std::move(item) } ) )
+                            break;
+                    }
+                    loaded.close();
+                }
+                catch (...)
+                {
+                    fail( std::current_exception() );
+                }
+            });
+
+        std::thread writer(
+            [&]()
+            {
+                try
+                {
+                    while ( auto item = processed.pop() )
+                    {
+                        auto& [i, result] = *item;
+                        const auto t = clock::now();
+                        write( i, std::move(result) );
+                        stats.write_time += clock::now() - t;
+                    }
+                }
+                catch (...)
+                {
+                    fail( std::current_exception() );
+                }
+            });
+
+        try
+        {
+            while ( auto item = loaded.pop() )
+            {
+                auto& [i, input] = *item;
+                const auto t = clock::now();
+                ProcessedT result{ process( i, std::move(input) ) };
+                stats.process_time += clock::now() - t;
+                ++stats.count;
+
+                if ( !processed.push( { i, std::move(result) } ) )
+                    break;
+            }
+            processed.close();
+        }
+        catch (...)
+        {
+            fail( std::current_exception() );
+        }
+
+        loader.join();
+        writer.join();
+        stats.total_time = clock::now() - start;
+
+        if ( error )
+            std::rethrow_exception( error );
+
+        return stats;
+    }
+
+}
@@ -0,0 +1,479 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// openpiv
+#include "core/enum_helper.h"
+#include "core/exception_builder.h"
+#include "core/executor.h"
+
+namespace openpiv::core {
+
+    /// how much of the processing a real-time frame received, from
+    /// best to worst
+    enum class realtime_quality
+    {
+        FULL,           ///< full grid with sub-pixel fitting
+        NO_SUBPIXEL,    ///< full grid, sub-pixel fitting skipped
+        COARSE_GRID,    ///< coarser grid, sub-pixel fitting skipped
+        DROPPED         ///< not processed
+    };
+
+    DECLARE_ENUM_HELPER( realtime_quality, {
+            { realtime_quality::FULL,        "full" },
+            { realtime_quality::NO_SUBPIXEL, "no-subpixel" },
+            { realtime_quality::COARSE_GRID, "coarse-grid" },
+            { realtime_quality::DROPPED,     "dropped" }
+        } )
+
+    /// records latencies and reports percentiles over the most recent
+    /// \a capacity samples; adding a sample doesn't allocate
+    class latency_recorder
+    {
+    public:
+        using duration_t = std::chrono::duration<double>;
+
+        explicit latency_recorder( size_t capacity = 4096 )
+            : samples_( std::max<size_t>( capacity, 1 ) )
+        {}
+
+        void add( duration_t latency )
+        {
+            samples_[count_ % samples_.size()] = latency;
+            ++count_;
+            max_ = std::max( max_, latency );
+        }
+
+        /// total number of samples added
+        size_t count() const { return count_; }
+
+        /// largest sample added
+        duration_t max() const { return max_; }
+
+        /// \returns the \a p th percentile, 0 <= p <= 100, of the
+        /// retained samples using the nearest rank method
+        duration_t percentile( double p ) const
+        {
+            const size_t n = std::min( count_, samples_.size() );
+            if ( n == 0 )
+                return {};
+
+            std::vector<duration_t> sorted( samples_.begin(), samples_.begin() + n );
+            const double rank = std::clamp( p, 0.0, 100.0 )/100.0 * n;
+            const size_t index = std::min( n - 1, static_cast<size_t>( std::max( 1.0, std::ceil( rank ) ) ) - 1 );
+            std::nth_element( sorted.begin(), sorted.begin() + index, sorted.end() );
+
+            return sorted[index];
+        }
+
+    private:
+        std::vector<duration_t> samples_;
+        size_t count_ = 0;
+        duration_t max_{};
+    };
+
+    /// options for \sa realtime_pipeline
+    struct realtime_options
+    {
+        std::chrono::microseconds deadline{ 100000 };  ///< from submit() to result
+        int cpu = -1;               ///< pin the processing thread to this CPU; -1 to not pin
+        double headroom = 0.9;      ///< plan to use at most this fraction of the time left
+        double smoothing = 0.25;    ///< weight of the newest sample in cost estimates
+    };
+
+    /// per-frame state passed to the processing function
+    class realtime_context
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        realtime_context( realtime_quality quality, clock::time_point start, clock::time_point deadline )
+            : quality_( quality )
+            , start_( start )
+            , deadline_( deadline )
+        {}
+
+        /// quality chosen for the frame as a whole
+        realtime_quality quality() const { return quality_; }
+
+        clock::time_point deadline() const { return deadline_; }
+        clock::duration time_left() const { return deadline_ - clock::now(); }
+
+        /// \returns true if, having completed \a fraction_done of the
+        /// frame's work, more than that fraction of the time available
+        /// when processing started has been used; remaining work should
+        /// then be degraded, e.g. by skipping sub-pixel fitting. The
+        /// progress reported here also lets the pipeline estimate the
+        /// cost of frames cut short by the deadline
+        bool behind( double fraction_done ) const
+        {
+            double progress = progress_.load( std::memory_order_relaxed );
+            while ( fraction_done > progress &&
+                    !progress_.compare_exchange_weak( progress, fraction_done, std::memory_order_relaxed ) )
+            {}
+
+            const auto now = clock::now();
+            if ( now >= deadline_ )
+                return true;
+            if ( fraction_done <= 0 )
+                return false;
+
+            const double used = std::chrono::duration<double>( now - start_ ).count();
+            const double available = std::chrono::duration<double>( deadline_ - start_ ).count();
+            return used > fraction_done * available;
+        }
+
+        /// largest fraction of work done reported to \sa behind
+        double progress() const { return progress_.load( std::memory_order_relaxed ); }
+
+    private:
+        realtime_quality quality_;
+        clock::time_point start_;
+        clock::time_point deadline_;
+        mutable std::atomic<double> progress_{ 0 };
+    };
+
+    /// outcome of a single real-time frame
+    struct realtime_frame_info
+    {
+        using duration_t = std::chrono::duration<double>;
+
+        size_t index = 0;                           ///< order of submission
+        size_t id = 0;                              ///< as passed to submit()
+        realtime_quality quality = realtime_quality::FULL;
+        duration_t latency{};                       ///< from submit() to result
+        bool deadline_met = false;
+    };
+
+    /// statistics gathered by \sa realtime_pipeline
+    struct realtime_stats
+    {
+        using duration_t = std::chrono::duration<double>;
+
+        size_t submitted = 0;       ///< frames submitted
+        size_t overruns = 0;        ///< frames the producer couldn't queue: all slots in use
+        size_t late = 0;            ///< frames processed after their deadline
+        std::array<size_t, 4> quality_counts{};     ///< frames per \sa realtime_quality
+        duration_t p50{};
+        duration_t p90{};
+        duration_t p99{};
+        duration_t max{};
+    };
+
+    /// Processes frames within a fixed deadline, in order, using a
+    /// ring of preallocated frame slots.
+    ///
+    /// A single producer obtains a free slot with try_acquire(), fills
+    /// it in place and publishes it with submit(); if no slot is free
+    /// the frame is lost and counted as an overrun, so the producer is
+    /// never blocked. A dedicated processing thread, optionally pinned
+    /// to a CPU, takes slots in order and calls
+    /// `ResultT process(FrameT&, const realtime_context&)` and then
+    /// `void on_result(const realtime_frame_info&, ResultT*)`; the
+    /// result pointer is null for dropped frames.
+    ///
+    /// Before each frame the quality is chosen from running estimates
+    /// of the cost of each \sa realtime_quality and the time left
+    /// before the frame's deadline: the best quality expected to fit
+    /// within \sa realtime_options::headroom of the time left is used,
+    /// and the frame is dropped if even the coarsest won't finish in
+    /// time. Estimates for unused qualities decay so that better
+    /// qualities are retried once load drops. Within a frame, the
+    /// processing function may degrade individual windows using
+    /// \sa realtime_context::behind.
+    ///
+    /// If process or on_result throws, processing stops and the
+    /// exception is rethrown by the next call to try_acquire(),
+    /// submit() or close().
+    template < typename FrameT, typename ResultT >
+    class realtime_pipeline
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+        using process_fn_t = std::function<ResultT(FrameT&, const realtime_context&)>;
+        using result_fn_t = std::function<void(const realtime_frame_info&, ResultT*)>;
+
+        /// \a slots are the preallocated frames; at least one is required
+        realtime_pipeline( std::vector<FrameT> slots,
+                           process_fn_t process,
+                           result_fn_t on_result,
+                           const realtime_options& options = {} )
+            : frames_( std::move( slots ) )
+            , slots_( frames_.size() )
+            , process_( std::move( process ) )
+            , on_result_( std::move( on_result ) )
+            , options_( options )
+        {
+            if ( frames_.empty() )
+                exception_builder<std::runtime_error>() << "realtime_pipeline requires at least one slot";
+
+            thread_ = std::thread( [this](){ run(); } );
+        }
+
+        ~realtime_pipeline()
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {}
+        }
+
+        realtime_pipeline( const realtime_pipeline& ) = delete;
+        realtime_pipeline& operator=( const realtime_pipeline& ) = delete;
+
+        /// \returns the next free slot, or nullptr if all slots are in
+        /// use; must be followed by submit() before the next call
+        FrameT* try_acquire()
+        {
+            rethrow_if_failed();
+
+            const size_t i = write_ % slots_.size();
+            if ( slots_[i].state.load( std::memory_order_acquire ) != slot_state::FREE )
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                ++stats_.overruns;
+                return nullptr;
+            }
+
+            acquired_ = true;
+            return &frames_[i];
+        }
+
+        /// publish the slot returned by try_acquire(); its id is its
+        /// order of submission
+        void submit()
+        {
+            submit( write_ );
+        }
+
+        /// publish the slot returned by try_acquire(), reporting \a id
+        /// in its \sa realtime_frame_info, e.g. the frame's number in
+        /// the source sequence when frames are lost to overruns
+        void submit( size_t id )
+        {
+            rethrow_if_failed();
+            if ( !acquired_ )
+                exception_builder<std::runtime_error>() << "submit() without a slot from try_acquire()";
+
+            auto& s = slots_[write_ % slots_.size()];
+            s.index = write_++;
+            s.id = id;
+            s.submitted = clock::now();
+            acquired_ = false;
+
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                s.state.store( slot_state::READY, std::memory_order_release );
+                ++stats_.submitted;
+            }
+            ready_.notify_one();
+        }
+
+        /// process all submitted frames and stop the processing thread
+        void close()
+        {
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                closing_ = true;
+            }
+            ready_.notify_one();
+
+            if ( thread_.joinable() )
+                thread_.join();
+
+            rethrow_if_failed();
+        }
+
+        /// statistics so far, including latency percentiles
+        realtime_stats stats() const
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            auto result = stats_;
+            result.p50 = latencies_.percentile( 50 );
+            result.p90 = latencies_.percentile( 90 );
+            result.p99 = latencies_.percentile( 99 );
+            result.max = latencies_.max();
+
+            return result;
+        }
+
+    private:
+        enum class slot_state : uint32_t { FREE, READY };
+
+        struct slot
+        {
+            std::atomic<slot_state> state{ slot_state::FREE };
+            size_t index = 0;
+            size_t id = 0;
+            clock::time_point submitted;
+        };
+
+        realtime_quality choose_quality( clock::duration time_left )
+        {
+            const double left = std::chrono::duration<double>( time_left ).count();
+            if ( left <= 0 )
+                return realtime_quality::DROPPED;
+
+            // unknown (zero) costs are optimistic so each quality is tried
+            for ( auto q : { realtime_quality::FULL, realtime_quality::NO_SUBPIXEL, realtime_quality::COARSE_GRID } )
+                if ( cost_[static_cast<size_t>(q)] <= options_.headroom * left )
+                    return q;
+
+            return cost_[static_cast<size_t>(realtime_quality::COARSE_GRID)] <= left
+                ? realtime_quality::COARSE_GRID
+                : realtime_quality::DROPPED;
+        }
+
+        void update_cost( realtime_quality quality, double seconds )
+        {
+            const size_t q = static_cast<size_t>(quality);
+            cost_[q] = cost_[q] == 0 ? seconds : options_.smoothing * seconds + (1 - options_.smoothing) * cost_[q];
+
+            // let better qualities be retried once load drops
+            for ( size_t better=0; better<q; ++better )
+                cost_[better] *= 1 - options_.smoothing/8;
+        }
+
+        void run()
+        {
+            if ( options_.cpu >= 0 )
+                pin_current_thread( static_cast<size_t>( options_.cpu ) );
+
+            size_t read = 0;
+            while ( true )
+            {
+                auto& s = slots_[read % slots_.size()];
+                {
+                    std::unique_lock<std::mutex> lock( mutex_ );
+                    ready_.wait( lock, [this, &s](){
+                        return closing_ || s.state.load( std::memory_order_acquire ) == slot_state::READY; } );
+
+                    if ( s.state.load( std::memory_order_acquire ) != slot_state::READY )
+                        break;
+                }
+
+                if ( !failed_ )
+                {
+                    try
+                    {
+                        process_slot( s, frames_[read % slots_.size()] );
+                    }
+                    catch (...)
+                    {
+                        std::unique_lock<std::mutex> lock( mutex_ );
+                        error_ = std::current_exception();
+                        failed_ = true;
+                    }
+                }
+
+                s.state.store( slot_state::FREE, std::memory_order_release );
+                ++read;
+            }
+        }
+
+        void process_slot( slot& s, FrameT& frame )
+        {
+            const auto start = clock::now();
+            const auto deadline = s.submitted + options_.deadline;
+
+            realtime_frame_info info;
+            info.index = s.index;
+            info.id = s.id;
+            info.quality = choose_quality( deadline - start );
+
+            std::optional<ResultT> result;
+            if ( info.quality != realtime_quality::DROPPED )
+            {
+                realtime_context ctx( info.quality, start, deadline );
+                result.emplace( process_( frame, ctx ) );
+
+                // a frame cut short by its deadline would understate
+                // the cost; extrapolate from the progress reported
+                double cost = std::chrono::duration<double>( clock::now() - start ).count();
+                if ( clock::now() > deadline && ctx.progress() > 0 && ctx.progress() < 1 )
+                    cost /= ctx.progress();
+                update_cost( info.quality, cost );
+            }
+            else
+            {
+                // retry processing once load drops
+                for ( auto& c : cost_ )
+                    c *= 1 - options_.smoothing/8;
+            }
+
+            const auto end = clock::now();
+            info.latency = end - s.submitted;
+            info.deadline_met = info.quality != realtime_quality::DROPPED && end <= deadline;
+
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                ++stats_.quality_counts[static_cast<size_t>(info.quality)];
+                if ( info.quality != realtime_quality::DROPPED )
+                {
+                    latencies_.add( info.latency );
+                    if ( !info.deadline_met )
+                        ++stats_.late;
+                }
+            }
+
+            on_result_( info, result ? &*result : nullptr );
+        }
+
+        void rethrow_if_failed()
+        {
+            if ( !failed_ )
+                return;
+
+            std::exception_ptr error;
+            {
+                // only report the error once
+                std::unique_lock<std::mutex> lock( mutex_ );
+                error = std::exchange( error_, nullptr );
+            }
+
+            if ( error )
+                std::rethrow_exception( error );
+        }
+
+        std::vector<FrameT> frames_;
+        std::vector<slot> slots_;
+        process_fn_t process_;
+        result_fn_t on_result_;
+        realtime_options options_;
+
+        // producer state
+        size_t write_ = 0;
+        bool acquired_ = false;
+
+        // processing thread state
+        std::array<double, 3> cost_{};   ///< estimated seconds per quality
+
+        mutable std::mutex mutex_;
+        std::condition_variable ready_;
+        bool closing_ = false;
+        std::atomic<bool> failed_{ false };
+        std::exception_ptr error_;
+        realtime_stats stats_;
+        latency_recorder latencies_;
+
+        std::thread thread_;
+    };
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace openpiv::core {
+
+    /// contiguous run of pixels forming a single row of an image or
+    /// image_view; \a T may be const
+    template < typename T >
+    class row_span
+    {
+    public:
+        using value_type = std::remove_const_t<T>;
+        using iterator = T*;
+
+        constexpr row_span() = default;
+        constexpr row_span( T* data, size_t width )
+            : data_( data )
+            , width_( width )
+        {}
+
+        /// allow conversion from a mutable to a const span
+        template < typename U,
+                   typename = typename std::enable_if_t< std::is_same_v<const U, T> > >
+        constexpr row_span( const row_span<U>& rhs )
+            : data_( rhs.data() )
+            , width_( rhs.size() )
+        {}
+
+        constexpr T* begin() const { return data_; }
+        constexpr T* end() const { return data_ + width_; }
+        constexpr T* data() const { return data_; }
+        constexpr size_t size() const { return width_; }
+        constexpr bool empty() const { return width_ == 0; }
+        constexpr T& operator[]( size_t i ) const { return data_[i]; }
+
+    private:
+        T* data_ = nullptr;
+        size_t width_ = 0;
+    };
+
+    /// the rows of an image or image_view as a range of \sa row_span;
+    /// rows are \a pitch pixels apart. Iterating rows and then the
+    /// pixels of each row avoids the index arithmetic of per-pixel
+    /// access, and leaves a simple loop over contiguous memory that
+    /// the compiler can vectorize.
+    template < typename T >
+    class row_range
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = row_span<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = row_span<T>;
+
+            iterator() = default;
+            iterator( T* p, size_t width, size_t pitch )
+                : p_( p )
+                , width_( width )
+                , pitch_( pitch )
+            {}
+
+            iterator& operator++() { p_ += pitch_; return *this; }
+            iterator operator++(int) { iterator result = *this; operator++(); return result; }
+            iterator& operator--() { p_ -= pitch_; return *this; }
+            iterator operator--(int) { iterator result = *this; operator--(); return result; }
+            iterator& operator+=( difference_type n ) { p_ += n*static_cast<difference_type>(pitch_); return *this; }
+            iterator& operator-=( difference_type n ) { return operator+=( -n ); }
+            iterator operator+( difference_type n ) const { iterator result = *this; return result += n; }
+            iterator operator-( difference_type n ) const { iterator result = *this; return result -= n; }
+            difference_type operator-( const iterator& rhs ) const
+            {
+                return pitch_ ? (p_ - rhs.p_)/static_cast<difference_type>(pitch_) : 0;
+            }
+
+            bool operator==( const iterator& rhs ) const { return p_ == rhs.p_; }
+            bool operator!=( const iterator& rhs ) const { return p_ != rhs.p_; }
+            bool operator<( const iterator& rhs ) const { return p_ < rhs.p_; }
+
+            row_span<T> operator*() const { return { p_, width_ }; }
+            row_span<T> operator[]( difference_type n ) const { return *(*this + n); }
+
+        private:
+            T* p_ = nullptr;
+            size_t width_ = 0;
+            size_t pitch_ = 0;
+        };
+
+        row_range() = default;
+        row_range( T* first, size_t width, size_t pitch, size_t height )
+            : first_( first )
+            , width_( width )
+            , pitch_( pitch )
+            , height_( height )
+        {}
+
+        iterator begin() const { return { first_, width_, pitch_ }; }
+        iterator end() const { return { first_ + height_*pitch_, width_, pitch_ }; }
+        size_t size() const { return height_; }
+        bool empty() const { return height_ == 0; }
+
+        /// row \a y
+        row_span<T> operator[]( size_t y ) const { return { first_ + y*pitch_, width_ }; }
+
+    private:
+        T* first_ = nullptr;
+        size_t width_ = 0;
+        size_t pitch_ = 0;
+        size_t height_ = 0;
+    };
+
+}
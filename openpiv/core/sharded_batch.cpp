@@ -0,0 +1,249 @@
+#include "core/sharded_batch.h"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// platform
+#if !defined(_WIN32)
+#  include <sys/mman.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#  include <cerrno>
+#endif
+
+// local
+#include "core/exception_builder.h"
+#include "core/log.h"
+
+namespace logger = openpiv::core::logger;
+
+namespace openpiv::core {
+
+#if defined(_WIN32)
+
+    bool has_sharded_batch()
+    {
+        return false;
+    }
+
+    void run_sharded( size_t,
+                      const std::function<void(size_t)>&,
+                      const sharded_batch_options&,
+                      const std::function<void(size_t, size_t)>&,
+                      const std::function<void(size_t, size_t, size_t)>& )
+    {
+        throw std::runtime_error( "sharded batch processing requires fork()" );
+    }
+
+#else
+
+    namespace {
+
+        /// per-worker state, shared between parent and workers
+        struct worker_status
+        {
+            std::atomic<uint64_t> completed;
+            char message[248];
+        };
+
+        static_assert( std::atomic<uint64_t>::is_always_lock_free );
+
+        /// anonymous shared mapping, inherited by forked workers
+        class shared_status
+        {
+        public:
+            explicit shared_status( size_t count )
+                : size_( count * sizeof(worker_status) )
+            {
+                void* p = ::mmap( nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+                if ( p == MAP_FAILED )
+                    exception_builder<std::runtime_error>() << "failed to map shared memory: " << std::strerror( errno );
+
+                // anonymous mappings are zero filled
+                status_ = static_cast<worker_status*>( p );
+            }
+
+            ~shared_status()
+            {
+                ::munmap( status_, size_ );
+            }
+
+            shared_status( const shared_status& ) = delete;
+            shared_status& operator=( const shared_status& ) = delete;
+
+            worker_status& operator[]( size_t i ) { return status_[i]; }
+
+        private:
+            size_t size_;
+            worker_status* status_ = nullptr;
+        };
+
+        [[noreturn]] void run_worker( worker_status& status,
+                                      size_t shard, size_t begin, size_t end,
+                                      const std::function<void(size_t)>& process_item,
+                                      const std::function<void(size_t, size_t, size_t)>& init )
+        {
+            auto fail =
+                [&status]( const char* message )
+                {
+                    std::strncpy( status.message, message, sizeof(status.message) - 1 );
+                    ::_exit( 1 );
+                };
+
+            try
+            {
+                if ( init )
+                    init( shard, begin, end );
+
+                for ( size_t i=begin; i<end; ++i )
+                {
+                    process_item( i );
+                    status.completed.fetch_add( 1, std::memory_order_relaxed );
+                }
+            }
+            catch ( std::exception& e )
+            {
+                fail( e.what() );
+            }
+            catch (...)
+            {
+                fail( "unknown error" );
+            }
+
+            ::_exit( 0 );
+        }
+
+    }
+
+    bool has_sharded_batch()
+    {
+        return true;
+    }
+
+    void run_sharded( size_t count,
+                      const std::function<void(size_t)>& process_item,
+                      const sharded_batch_options& options,
+                      const std::function<void(size_t, size_t)>& progress,
+                      const std::function<void(size_t, size_t, size_t)>& init )
+    {
+        if ( count == 0 )
+            return;
+
+        const size_t process_count = std::clamp<size_t>( options.process_count, 1, count );
+        shared_status status( process_count );
+
+        // don't let workers inherit (and later repeat) buffered output
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush( nullptr );
+
+        std::vector<pid_t> workers;
+        std::string fork_error;
+        for ( size_t shard=0; shard<process_count; ++shard )
+        {
+            const size_t begin = (shard*count)/process_count;
+            const size_t end = ((shard + 1)*count)/process_count;
+
+            auto& log = logger::Logger::instance();
+            log.prepare_fork();
+            const pid_t pid = ::fork();
+            log.fork_completed( pid == 0 );
+
+            if ( pid == 0 )
+                run_worker( status[shard], shard, begin, end, process_item, init );
+
+            if ( pid < 0 )
+            {
+                fork_error = std::strerror( errno );
+                break;
+            }
+
+            workers.push_back( pid );
+        }
+
+        auto completed =
+            [&status, &workers]()
+            {
+                size_t result = 0;
+                for ( size_t shard=0; shard<workers.size(); ++shard )
+                    result += status[shard].completed.load( std::memory_order_relaxed );
+                return result;
+            };
+
+        // wait for all workers, reporting progress
+        std::vector<int> exit_status( workers.size(), 0 );
+        std::vector<std::string> wait_error( workers.size() );
+        std::vector<bool> running( workers.size(), true );
+        size_t remaining = workers.size();
+        while ( remaining > 0 )
+        {
+            for ( size_t shard=0; shard<workers.size(); ++shard )
+            {
+                if ( !running[shard] )
+                    continue;
+
+                const pid_t result = ::waitpid( workers[shard], &exit_status[shard], WNOHANG );
+                if ( result < 0 && errno == EINTR )
+                    continue;
+
+                // if the worker can't be waited for, e.g. it was reaped
+                // elsewhere, its outcome is unknown: report it as failed
+                if ( result < 0 )
+                    wait_error[shard] = std::strerror( errno );
+
+                if ( result == workers[shard] || result < 0 )
+                {
+                    running[shard] = false;
+                    --remaining;
+                }
+            }
+
+            if ( remaining == 0 )
+                break;
+
+            if ( progress )
+                progress( completed(), count );
+            std::this_thread::sleep_for( options.poll_interval );
+        }
+
+        if ( progress )
+            progress( completed(), count );
+
+        std::ostringstream errors;
+        if ( !fork_error.empty() )
+            errors << "failed to create worker process: " << fork_error;
+
+        for ( size_t shard=0; shard<workers.size(); ++shard )
+        {
+            const int s = exit_status[shard];
+            if ( wait_error[shard].empty() && WIFEXITED(s) && WEXITSTATUS(s) == 0 )
+                continue;
+
+            if ( errors.tellp() > 0 )
+                errors << "; ";
+
+            errors << "worker " << shard;
+            if ( !wait_error[shard].empty() )
+                errors << " could not be waited for: " << wait_error[shard];
+            else if ( WIFSIGNALED(s) )
+                errors << " terminated by signal " << WTERMSIG(s);
+            else
+                errors << " failed: " << status[shard].message;
+        }
+
+        if ( errors.tellp() > 0 )
+            exception_builder<std::runtime_error>() << errors.str();
+    }
+
+#endif
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <functional>
+
+namespace openpiv::core {
+
+    /// options for \sa run_sharded
+    struct sharded_batch_options
+    {
+        size_t process_count = 2;                               ///< number of worker processes
+        std::chrono::milliseconds poll_interval{ 100 };        ///< how often progress is reported
+    };
+
+    /// \returns true if \sa run_sharded is supported on this platform
+    bool has_sharded_batch();
+
+    /// Process the items [0, count) in separate worker processes.
+    ///
+    /// The items are split into \sa sharded_batch_options::process_count
+    /// contiguous shards and a worker process is forked for each. A
+    /// worker calls \a init(shard, begin, end) once and then
+    /// \a process_item(i) for each item of its shard; workers share no
+    /// allocator, logger or thread-local state with each other or with
+    /// the parent so they scale past the contention limits of a single
+    /// process. Results must be returned through the file system or
+    /// shared memory, e.g. a \sa vector_field_series opened read-write
+    /// by each worker.
+    ///
+    /// A forked worker contains only the calling thread: threads,
+    /// thread pools and executors must be created in \a init rather
+    /// than inherited, and logging is disabled in workers. Workers end
+    /// with _exit() so no destructors or atexit handlers run.
+    ///
+    /// The number of items completed by each worker is kept in shared
+    /// memory; whilst waiting the parent calls \a progress(completed,
+    /// count) every poll interval and once more when all workers have
+    /// finished.
+    ///
+    /// If any worker fails, its error message is reported by a
+    /// std::runtime_error thrown once all workers have finished.
+    /// Throws std::runtime_error if processes can't be created or
+    /// \sa has_sharded_batch is false.
+    void run_sharded( size_t count,
+                      const std::function<void(size_t)>& process_item,
+                      const sharded_batch_options& options = {},
+                      const std::function<void(size_t, size_t)>& progress = {},
+                      const std::function<void(size_t, size_t, size_t)>& init = {} );
+
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// openpiv
+#include "core/exception_builder.h"
+#include "core/point.h"
+#include "core/size.h"
+#include "core/vector.h"
+
+namespace openpiv::core {
+
+    /// per-vector status bits held in vector_field::flags()
+    struct vector_flag
+    {
+        using type = uint8_t;
+
+        static constexpr type NONE     = 0;
+        static constexpr type INVALID  = 1 << 0;  ///< no valid correlation peak
+        static constexpr type REPLACED = 1 << 1;  ///< value replaced e.g. by validation
+        static constexpr type MASKED   = 1 << 2;  ///< window lies in a masked region
+    };
+
+    /// a vector field stored as a structure of arrays: each of the
+    /// columns x, y, u, v, quality and flags is a contiguous array of
+    /// nx * ny values in row-major order, so kernels such as
+    /// validation or smoothing can iterate over a single column (or
+    /// the same offset in several columns) and vectorise.
+    ///
+    /// Neighbours are found by index arithmetic: the vector at grid
+    /// position (ix, iy) is at index iy * nx + ix, so the vector
+    /// above is at index + nx, the one to the right at index + 1.
+    ///
+    /// All columns share a single allocation which may alternatively
+    /// be provided externally (e.g. a mapped file). Copies are deep
+    /// and always own their storage; use \sa share for another field
+    /// referring to the same columns.
+    template < typename T >
+    class vector_field
+    {
+        static_assert( std::is_floating_point_v<T>, "vector_field requires floating point values" );
+
+    public:
+        using value_t = T;
+        using flags_t = vector_flag::type;
+
+        /// a single vector gathered from the columns
+        struct entry
+        {
+            point2<T> xy;
+            vector2<T> uv;
+            T quality = 0;
+            flags_t flags = vector_flag::NONE;
+        };
+
+        /// pointers to the columns of a field
+        struct columns_t
+        {
+            T* x = nullptr;
+            T* y = nullptr;
+            T* u = nullptr;
+            T* v = nullptr;
+            T* quality = nullptr;
+            flags_t* flags = nullptr;
+        };
+
+        vector_field() = default;
+        vector_field( vector_field&& ) = default;
+        vector_field& operator=( vector_field&& ) = default;
+
+        vector_field( const vector_field& rhs )
+            : vector_field( rhs.nx_, rhs.ny_ )
+        {
+            std::copy( rhs.x(), rhs.x() + size(), x() );
+            std::copy( rhs.y(), rhs.y() + size(), y() );
+            std::copy( rhs.u(), rhs.u() + size(), u() );
+            std::copy( rhs.v(), rhs.v() + size(), v() );
+            std::copy( rhs.quality(), rhs.quality() + size(), quality() );
+            std::copy( rhs.flags(), rhs.flags() + size(), flags() );
+        }
+
+        /// replaces the storage rather than writing into it, as that
+        /// may be shared or external
+        vector_field& operator=( const vector_field& rhs )
+        {
+            if ( this != &rhs )
+                *this = vector_field( rhs );
+
+            return *this;
+        }
+
+        /// create a zero-initialized field of \a nx by \a ny vectors
+        vector_field( uint32_t nx, uint32_t ny )
+        {
+            resize( nx, ny );
+        }
+
+        explicit vector_field( const core::size& s )
+            : vector_field( s.width(), s.height() )
+        {}
+
+        /// wrap externally owned columns of \a nx by \a ny vectors;
+        /// \a owner is kept alive for as long as any field refers to
+        /// the columns
+        vector_field( uint32_t nx, uint32_t ny, const columns_t& columns, std::shared_ptr<void> owner )
+            : nx_( nx )
+            , ny_( ny )
+            , columns_( columns )
+            , storage_( std::move( owner ) )
+        {
+            if ( size() > 0 &&
+                 !(columns.x && columns.y && columns.u && columns.v && columns.quality && columns.flags) )
+                core::exception_builder<std::runtime_error>() << "vector_field: all columns must be provided";
+        }
+
+        /// resize the field; this is destructive and allocates new,
+        /// zero-initialized, storage
+        void resize( uint32_t nx, uint32_t ny )
+        {
+            const size_t n = static_cast<size_t>(nx) * ny;
+
+            // value columns first to keep them aligned, flags last
+            auto buffer = std::make_shared<std::vector<T>>( 5 * n + (n + sizeof(T) - 1) / sizeof(T) );
+            T* p = buffer->data();
+            columns_ = { p, p + n, p + 2*n, p + 3*n, p + 4*n, reinterpret_cast<flags_t*>(p + 5*n) };
+
+            nx_ = nx;
+            ny_ = ny;
+            storage_ = std::move( buffer );
+        }
+
+        /// deep copy into newly allocated storage; the same as a copy
+        vector_field clone() const
+        {
+            return *this;
+        }
+
+        /// \returns a field referring to the same columns, keeping
+        /// their storage alive; writes through either are seen by both
+        vector_field share()
+        {
+            vector_field result;
+            result.nx_ = nx_;
+            result.ny_ = ny_;
+            result.columns_ = columns_;
+            result.storage_ = storage_;
+            return result;
+        }
+
+        /// dimensions
+        inline uint32_t nx() const { return nx_; }
+        inline uint32_t ny() const { return ny_; }
+        inline core::size shape() const { return { nx_, ny_ }; }
+        inline size_t size() const { return static_cast<size_t>(nx_) * ny_; }
+        inline bool empty() const { return size() == 0; }
+
+        /// distance between vertically adjacent vectors
+        inline size_t stride() const { return nx_; }
+
+        /// column access
+        inline T* x() { return columns_.x; }
+        inline const T* x() const { return columns_.x; }
+        inline T* y() { return columns_.y; }
+        inline const T* y() const { return columns_.y; }
+        inline T* u() { return columns_.u; }
+        inline const T* u() const { return columns_.u; }
+        inline T* v() { return columns_.v; }
+        inline const T* v() const { return columns_.v; }
+        inline T* quality() { return columns_.quality; }
+        inline const T* quality() const { return columns_.quality; }
+        inline flags_t* flags() { return columns_.flags; }
+        inline const flags_t* flags() const { return columns_.flags; }
+
+        /// index of the vector at grid position (\a ix, \a iy)
+        inline size_t index( uint32_t ix, uint32_t iy ) const { return static_cast<size_t>(iy) * nx_ + ix; }
+
+        /// grid position of the vector at index \a i
+        inline point2<uint32_t> position( size_t i ) const
+        {
+            return { static_cast<uint32_t>(i % nx_), static_cast<uint32_t>(i / nx_) };
+        }
+
+        /// \returns the index of the vector offset by (\a dx, \a dy)
+        /// from the vector at index \a i, or nothing if that lies
+        /// outside the field
+        inline std::optional<size_t> neighbour( size_t i, int32_t dx, int32_t dy ) const
+        {
+            const int64_t ix = static_cast<int64_t>(i % nx_) + dx;
+            const int64_t iy = static_cast<int64_t>(i / nx_) + dy;
+            if ( ix < 0 || iy < 0 || ix >= nx_ || iy >= ny_ )
+                return {};
+
+            return static_cast<size_t>(iy) * nx_ + static_cast<size_t>(ix);
+        }
+
+        /// gather the vector at index \a i
+        entry operator[]( size_t i ) const
+        {
+            return { { x()[i], y()[i] }, { u()[i], v()[i] }, quality()[i], flags()[i] };
+        }
+
+        /// scatter \a e to index \a i
+        void set( size_t i, const entry& e )
+        {
+            x()[i] = e.xy[0];
+            y()[i] = e.xy[1];
+            u()[i] = e.uv[0];
+            v()[i] = e.uv[1];
+            quality()[i] = e.quality;
+            flags()[i] = e.flags;
+        }
+
+    private:
+        uint32_t nx_ = 0;
+        uint32_t ny_ = 0;
+        columns_t columns_;
+        std::shared_ptr<void> storage_;
+    };
+
+    /// ostream operator
+    template < typename T >
+    std::ostream& operator<<( std::ostream& os, const vector_field<T>& f )
+    {
+        os << "vector_field<" << (sizeof(T) == sizeof(float) ? "float" : "double") << ">["
+           << f.nx() << " x " << f.ny() << "]";
+
+        return os;
+    }
+
+    /// standard vector field types
+    using vector_field_f = vector_field< float >;
+    using vector_field_d = vector_field< double >;
+
+}
@@ -0,0 +1,255 @@
+#include "io/async_writer.h"
+
+// std
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+// local
+#include "core/exception_builder.h"
+#include "core/log.h"
+
+namespace logger = openpiv::core::logger;
+
+namespace openpiv::core {
+
+    text_sink::text_sink( std::ostream& os )
+        : os_( os )
+    {}
+
+    void text_sink::write( const vector_field_frame& frame )
+    {
+        if ( !frame.label.empty() )
+            os_ << "# " << frame.label << "\n";
+
+        write_vector_field_text( os_, frame.field );
+        if ( !os_ )
+            exception_builder<std::runtime_error>() << "failed to write vector field " << frame.index;
+    }
+
+    void text_sink::close()
+    {
+        os_.flush();
+    }
+
+    binary_sink::binary_sink( path_fn_t path_for, const vector_field_parameters& parameters )
+        : path_for_( std::move( path_for ) )
+        , parameters_( parameters )
+    {}
+
+    void binary_sink::write( const vector_field_frame& frame )
+    {
+        write_vector_field( path_for_( frame ), frame.field, parameters_ );
+    }
+
+    hdf5_sink::hdf5_sink( const std::string& path,
+                          const vector_field_parameters& parameters,
+                          const hdf5_options& options )
+        : file_( path, parameters, options )
+    {}
+
+    void hdf5_sink::write( const vector_field_frame& frame )
+    {
+        file_.append( frame.field );
+    }
+
+    void hdf5_sink::close()
+    {
+        file_.close();
+    }
+
+    async_writer::async_writer( std::unique_ptr<vector_field_sink> sink, size_t capacity )
+        : sink_( std::move( sink ) )
+        , queue_( capacity )
+        , start_( clock::now() )
+    {
+        if ( !sink_ )
+            exception_builder<std::runtime_error>() << "async_writer requires a sink";
+
+        thread_ = std::thread( [this](){ run(); } );
+    }
+
+    async_writer::~async_writer()
+    {
+        try
+        {
+            close();
+        }
+        catch ( std::exception& e )
+        {
+            logger::error( "failed to write vector field: {}", e.what() );
+        }
+    }
+
+    void async_writer::write( vector_field_d field, std::string label )
+    {
+        write( next_index_++, std::move( field ), std::move( label ) );
+    }
+
+    void async_writer::write( size_t index, vector_field_d field, std::string label )
+    {
+        vector_field_frame frame{ index, std::move( label ), std::move( field ) };
+
+        auto blocked_since = clock::time_point{};
+        while ( true )
+        {
+            rethrow_if_failed();
+            if ( closing_ )
+                exception_builder<std::runtime_error>() << "async_writer is closed";
+
+            // only moves from frame on success
+            if ( queue_.try_push( std::move( frame ) ) )
+                break;
+
+            // queue is full: the sink is not keeping up
+            if ( blocked_since == clock::time_point{} )
+                blocked_since = clock::now();
+
+            // pops are counted under the lock so retrying under it
+            // means a slot freed from here on can't be missed
+            std::unique_lock<std::mutex> lock( mutex_ );
+            const size_t popped = popped_;
+            if ( queue_.try_push( std::move( frame ) ) )
+                break;
+
+            cv_.wait( lock, [this, popped](){ return popped_ != popped || closing_ || failed_; } );
+        }
+
+        if ( blocked_since != clock::time_point{} )
+            blocked_ticks_ += (clock::now() - blocked_since).count();
+
+        const size_t queued = queue_.size();
+        size_t high_water = high_water_;
+        while ( queued > high_water && !high_water_.compare_exchange_weak( high_water, queued ) )
+            ;
+
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            ++pushed_;
+        }
+        cv_.notify_all();
+    }
+
+    void async_writer::run()
+    {
+        while ( true )
+        {
+            auto frame = queue_.try_pop();
+            if ( !frame )
+            {
+                // as in write(), retry under the lock so a push can't
+                // be missed; closing_ is only set once all writes have
+                // been queued so the queue is then drained
+                std::unique_lock<std::mutex> lock( mutex_ );
+                const size_t pushed = pushed_;
+                frame = queue_.try_pop();
+                if ( !frame )
+                {
+                    if ( closing_ )
+                        break;
+
+                    cv_.wait( lock, [this, pushed](){ return pushed_ != pushed || closing_; } );
+                    continue;
+                }
+            }
+
+            // a slot is free
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                ++popped_;
+            }
+            cv_.notify_all();
+            if ( failed_ )
+                continue;
+
+            try
+            {
+                const auto t = clock::now();
+                sink_->write( *frame );
+                sink_ticks_ += (clock::now() - t).count();
+                ++frames_;
+            }
+            catch (...)
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                error_ = std::current_exception();
+                failed_ = true;
+            }
+        }
+
+        try
+        {
+            sink_->close();
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            if ( !error_ )
+                error_ = std::current_exception();
+            failed_ = true;
+        }
+    }
+
+    async_writer_stats async_writer::close()
+    {
+        if ( !closed_.exchange( true ) )
+        {
+            {
+                std::unique_lock<std::mutex> lock( mutex_ );
+                closing_ = true;
+            }
+            cv_.notify_all();
+            if ( thread_.joinable() )
+                thread_.join();
+
+            end_ticks_ = clock::now().time_since_epoch().count();
+
+            // the logger only accepts plain "{}" placeholders
+            const auto s = stats();
+            const auto seconds = []( auto d ){ return fmt::format( "{:.3f}s", d.count() ); };
+            if ( s.output_bound() )
+                logger::warn( "output is the bottleneck: writers waited {} of {} for "
+                              "the sink, which took {} to write {} vector fields",
+                              seconds( s.blocked_time ), seconds( s.elapsed ),
+                              seconds( s.sink_time ), s.frames );
+            else
+                logger::debug( "wrote {} vector fields in {}; writers waited {}",
+                               s.frames, seconds( s.sink_time ), seconds( s.blocked_time ) );
+        }
+
+        rethrow_if_failed();
+        return stats();
+    }
+
+    async_writer_stats async_writer::stats() const
+    {
+        const auto end_ticks = end_ticks_.load();
+        const auto end = end_ticks ? clock::time_point( clock::duration( end_ticks ) ) : clock::now();
+
+        async_writer_stats s;
+        s.frames = frames_;
+        s.high_water = high_water_;
+        s.sink_time = clock::duration( sink_ticks_.load() );
+        s.blocked_time = clock::duration( blocked_ticks_.load() );
+        s.elapsed = end - start_;
+        return s;
+    }
+
+    void async_writer::rethrow_if_failed()
+    {
+        if ( !failed_ )
+            return;
+
+        std::exception_ptr error;
+        {
+            // only report the error once
+            std::unique_lock<std::mutex> lock( mutex_ );
+            error = std::exchange( error_, nullptr );
+        }
+
+        if ( error )
+            std::rethrow_exception( error );
+    }
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// openpiv
+#include "core/mpmc_queue.h"
+#include "core/vector_field.h"
+#include "io/hdf5_vector_field_writer.h"
+#include "io/vector_field_io.h"
+
+namespace openpiv::core {
+
+    /// a vector field queued for output
+    struct vector_field_frame
+    {
+        size_t index = 0;       ///< as passed to \sa async_writer::write, or its sequence number
+        std::string label;      ///< e.g. the name of the source image
+        vector_field_d field;
+    };
+
+    /// destination for vector fields written by \sa async_writer;
+    /// write() and close() are only ever called from the writer's
+    /// background thread
+    class vector_field_sink
+    {
+    public:
+        virtual ~vector_field_sink() = default;
+        virtual void write( const vector_field_frame& frame ) = 0;
+        virtual void close() {}
+    };
+
+    /// writes each frame as text to a stream, preceded by a
+    /// "# <label>" line if the frame has a label; see
+    /// \sa write_vector_field_text
+    class text_sink : public vector_field_sink
+    {
+    public:
+        explicit text_sink( std::ostream& os );
+        void write( const vector_field_frame& frame ) override;
+        void close() override;
+
+    private:
+        std::ostream& os_;
+    };
+
+    /// writes each frame to its own binary vector field file; the
+    /// file name is provided by \a path_for
+    class binary_sink : public vector_field_sink
+    {
+    public:
+        using path_fn_t = std::function<std::string(const vector_field_frame&)>;
+
+        binary_sink( path_fn_t path_for, const vector_field_parameters& parameters = {} );
+        void write( const vector_field_frame& frame ) override;
+
+    private:
+        path_fn_t path_for_;
+        vector_field_parameters parameters_;
+    };
+
+    /// appends each frame to an HDF5 time series; see \sa hdf5_vector_field_file
+    class hdf5_sink : public vector_field_sink
+    {
+    public:
+        hdf5_sink( const std::string& path,
+                   const vector_field_parameters& parameters = {},
+                   const hdf5_options& options = {} );
+        void write( const vector_field_frame& frame ) override;
+        void close() override;
+
+    private:
+        hdf5_vector_field_file<double> file_;
+    };
+
+    /// timing information gathered by \sa async_writer
+    struct async_writer_stats
+    {
+        using duration_t = std::chrono::duration<double>;
+
+        size_t frames = 0;              ///< frames written to the sink
+        size_t high_water = 0;          ///< largest number of frames queued
+        duration_t sink_time{};         ///< time spent inside the sink
+        duration_t blocked_time{};      ///< time producers waited for queue space
+        duration_t elapsed{};           ///< time from construction to close
+
+        /// \returns true if producers spent a significant part of the
+        /// run waiting for output i.e. writing, not computing vector
+        /// fields, limited throughput
+        bool output_bound() const
+        {
+            return elapsed.count() > 0 && blocked_time.count() > 0.1 * elapsed.count();
+        }
+    };
+
+    /// Writes vector fields to a \sa vector_field_sink on a background
+    /// thread.
+    ///
+    /// Frames are handed over through a bounded lock-free queue; when
+    /// the queue is full write() blocks until the sink catches up, so
+    /// memory use is bounded by \a capacity frames. The time spent
+    /// blocked is recorded and, if output turns out to be the
+    /// bottleneck, reported when the writer is closed.
+    ///
+    /// write() may be called from several threads; frames are passed
+    /// to the sink in the order in which they were queued. Errors
+    /// raised by the sink are rethrown by the next call to write() or
+    /// close(); subsequent frames are discarded.
+    class async_writer
+    {
+    public:
+        explicit async_writer( std::unique_ptr<vector_field_sink> sink, size_t capacity = 4 );
+
+        /// closes the writer; errors are logged rather than thrown,
+        /// call \sa close to handle them
+        ~async_writer();
+
+        async_writer( const async_writer& ) = delete;
+        async_writer& operator=( const async_writer& ) = delete;
+
+        /// queue \a field for output, blocking while the queue is full;
+        /// a field passed by value is independent of the caller's, move
+        /// it in to avoid a copy. Only a field from
+        /// \sa vector_field::share aliases the caller's storage, which
+        /// must then not be modified until the frame has been written
+        void write( vector_field_d field, std::string label = {} );
+
+        /// as above, but the frame is identified by the caller's
+        /// \a index, e.g. its image pair, rather than the order in
+        /// which frames were queued; use one form or the other
+        void write( size_t index, vector_field_d field, std::string label = {} );
+
+        /// write all queued frames, close the sink and \returns the
+        /// writer's statistics; must not be called concurrently with
+        /// write()
+        async_writer_stats close();
+
+        /// statistics so far
+        async_writer_stats stats() const;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        void run();
+        void rethrow_if_failed();
+
+        std::unique_ptr<vector_field_sink> sink_;
+        mpmc_queue<vector_field_frame> queue_;
+
+        // waiting is only needed when the queue is full or empty;
+        // pushes and pops are counted under the mutex, which also
+        // guards error_, so that waiters wake on either
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        size_t pushed_ = 0;
+        size_t popped_ = 0;
+
+        std::thread thread_;
+        std::atomic<bool> closing_{ false };
+        std::atomic<bool> closed_{ false };
+        std::atomic<bool> failed_{ false };
+        std::exception_ptr error_;
+
+        std::atomic<size_t> next_index_{ 0 };
+        std::atomic<size_t> frames_{ 0 };
+        std::atomic<size_t> high_water_{ 0 };
+        std::atomic<clock::rep> sink_ticks_{ 0 };
+        std::atomic<clock::rep> blocked_ticks_{ 0 };
+        clock::time_point start_;
+        std::atomic<clock::rep> end_ticks_{ 0 };   ///< 0 until closed
+    };
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// local
+#include "core/exception_builder.h"
+#include "core/size.h"
+#include "io/vector_field_io.h"
+
+/// pieces of the binary format shared by vector field files (see
+/// vector_field_io.h) and vector field series (see
+/// vector_field_series.h); not part of the public interface
+namespace openpiv::core::detail::vector_field_format {
+
+    using magic_t = std::array<char, 8>;
+
+    constexpr uint32_t version = 1;
+    constexpr uint32_t byte_order_mark = 0x01020304;
+    constexpr size_t units_length = 32;
+    constexpr size_t column_count = 6;
+    constexpr size_t column_alignment = 64;
+    constexpr size_t header_size = 256;
+
+    /// the first 128 bytes of the on-disk header, common to both
+    /// formats; each is followed by its own layout fields
+    struct header_prefix
+    {
+        magic_t magic;
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t header_size;
+        uint32_t nx;
+        uint32_t ny;
+        uint32_t value_size;
+        uint32_t window_size[2];
+        uint32_t window_spacing[2];
+        double dt;
+        double scale;
+        char position_units[units_length];
+        char velocity_units[units_length];
+    };
+
+    static_assert( offsetof(header_prefix, version) == 8 );
+    static_assert( offsetof(header_prefix, nx) == 20 );
+    static_assert( offsetof(header_prefix, window_size) == 32 );
+    static_assert( offsetof(header_prefix, dt) == 48 );
+    static_assert( offsetof(header_prefix, position_units) == 64 );
+    static_assert( sizeof(header_prefix) == 128 );
+
+    inline size_t align( size_t v )
+    {
+        return (v + column_alignment - 1) / column_alignment * column_alignment;
+    }
+
+    inline void copy_units( char (&to)[units_length], const std::string& from )
+    {
+        std::memset( to, 0, units_length );
+        std::memcpy( to, from.data(), std::min( from.size(), units_length - 1 ) );
+    }
+
+    inline std::string read_units( const char (&from)[units_length] )
+    {
+        return std::string( from, strnlen( from, units_length ) );
+    }
+
+    /// byte offsets of the columns x, y, u, v, quality and flags of
+    /// \a n values of \a value_size bytes, laid out from \a start with
+    /// each column aligned; the last entry is the aligned end of the
+    /// flags column
+    inline std::array<size_t, column_count + 1> column_layout( size_t start, size_t n, size_t value_size )
+    {
+        std::array<size_t, column_count + 1> result;
+        result[0] = start;
+        for ( size_t c=0; c<column_count; ++c )
+            result[c + 1] = align( result[c] + n * (c == column_count - 1 ? 1 : value_size) );
+
+        return result;
+    }
+
+    /// header prefix for a field of \a shape stored with values of
+    /// \a value_size bytes
+    inline header_prefix make_prefix( const magic_t& magic,
+                                      const core::size& shape,
+                                      uint32_t value_size,
+                                      const vector_field_parameters& parameters )
+    {
+        header_prefix result{};
+        result.magic = magic;
+        result.version = version;
+        result.byte_order = byte_order_mark;
+        result.header_size = header_size;
+        result.nx = shape.width();
+        result.ny = shape.height();
+        result.value_size = value_size;
+        result.window_size[0] = parameters.window_size.width();
+        result.window_size[1] = parameters.window_size.height();
+        result.window_spacing[0] = parameters.window_spacing.width();
+        result.window_spacing[1] = parameters.window_spacing.height();
+        result.dt = parameters.dt;
+        result.scale = parameters.scale;
+        copy_units( result.position_units, parameters.position_units );
+        copy_units( result.velocity_units, parameters.velocity_units );
+
+        return result;
+    }
+
+    /// throws unless \a header has the expected \a magic, byte order
+    /// and version; \a what names the format in the message
+    inline void check_prefix( const header_prefix& header,
+                              const magic_t& magic,
+                              const std::string& path,
+                              const char* what )
+    {
+        if ( header.magic != magic )
+            exception_builder<std::runtime_error>() << path << " is not a " << what;
+        if ( header.byte_order != byte_order_mark )
+            exception_builder<std::runtime_error>() << path << " has a different byte order";
+        if ( header.version != version )
+            exception_builder<std::runtime_error>() << path << " has unsupported version: " << header.version;
+    }
+
+    inline vector_field_parameters to_parameters( const header_prefix& header )
+    {
+        vector_field_parameters result;
+        result.window_size = { header.window_size[0], header.window_size[1] };
+        result.window_spacing = { header.window_spacing[0], header.window_spacing[1] };
+        result.dt = header.dt;
+        result.scale = header.scale;
+        result.position_units = read_units( header.position_units );
+        result.velocity_units = read_units( header.velocity_units );
+
+        return result;
+    }
+
+}
@@ -0,0 +1,505 @@
+#include "io/hdf5_vector_field_writer.h"
+
+// std
+#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+// local
+#include "core/exception_builder.h"
+#include "core/log.h"
+
+#if defined(OPENPIV_HAS_HDF5)
+#  include <hdf5.h>
+#endif
+
+namespace logger = openpiv::core::logger;
+
+namespace {
+
+    using namespace openpiv::core;
+
+    constexpr std::array<const char*, 6> dataset_names{ "x", "y", "u", "v", "quality", "flags" };
+
+#if defined(OPENPIV_HAS_HDF5)
+
+    /// the HDF5 library is not necessarily built thread-safe;
+    /// serialize all calls into it
+    std::mutex& hdf5_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /// owns an HDF5 identifier
+    class h5_handle
+    {
+    public:
+        using close_fn_t = herr_t (*)(hid_t);
+
+        h5_handle() = default;
+        h5_handle( hid_t id, close_fn_t close, const char* what )
+            : id_( id )
+            , close_( close )
+        {
+            if ( id_ < 0 )
+                exception_builder<std::runtime_error>() << "HDF5: failed to " << what;
+        }
+
+        h5_handle( h5_handle&& rhs )
+        {
+            std::swap( id_, rhs.id_ );
+            std::swap( close_, rhs.close_ );
+        }
+
+        h5_handle& operator=( h5_handle&& rhs )
+        {
+            std::swap( id_, rhs.id_ );
+            std::swap( close_, rhs.close_ );
+            return *this;
+        }
+
+        ~h5_handle()
+        {
+            if ( id_ >= 0 && close_ )
+                close_( id_ );
+        }
+
+        operator hid_t() const { return id_; }
+
+    private:
+        hid_t id_ = -1;
+        close_fn_t close_ = nullptr;
+    };
+
+    void check( herr_t status, const char* what )
+    {
+        if ( status < 0 )
+            exception_builder<std::runtime_error>() << "HDF5: failed to " << what;
+    }
+
+    template < typename T >
+    hid_t native_type()
+    {
+        if constexpr ( std::is_same_v<T, float> )
+            return H5T_NATIVE_FLOAT;
+        else if constexpr ( std::is_same_v<T, double> )
+            return H5T_NATIVE_DOUBLE;
+        else
+            return H5T_NATIVE_UINT8;
+    }
+
+    void write_attribute( hid_t location, const char* name, hid_t type, const void* data, hsize_t count )
+    {
+        h5_handle space{ H5Screate_simple( 1, &count, nullptr ), H5Sclose, "create attribute space" };
+        h5_handle attribute{ H5Acreate2( location, name, type, space, H5P_DEFAULT, H5P_DEFAULT ), H5Aclose, "create attribute" };
+        check( H5Awrite( attribute, type, data ), "write attribute" );
+    }
+
+    void write_attribute( hid_t location, const char* name, const std::string& value )
+    {
+        h5_handle type{ H5Tcopy( H5T_C_S1 ), H5Tclose, "create string type" };
+        check( H5Tset_size( type, std::max<size_t>( 1, value.size() ) ), "set string size" );
+        h5_handle space{ H5Screate( H5S_SCALAR ), H5Sclose, "create attribute space" };
+        h5_handle attribute{ H5Acreate2( location, name, type, space, H5P_DEFAULT, H5P_DEFAULT ), H5Aclose, "create attribute" };
+        check( H5Awrite( attribute, type, value.empty() ? "" : value.c_str() ), "write attribute" );
+    }
+
+    void read_attribute( hid_t location, const char* name, hid_t type, void* data )
+    {
+        h5_handle attribute{ H5Aopen( location, name, H5P_DEFAULT ), H5Aclose, "open attribute" };
+        check( H5Aread( attribute, type, data ), "read attribute" );
+    }
+
+    std::string read_string_attribute( hid_t location, const char* name )
+    {
+        h5_handle attribute{ H5Aopen( location, name, H5P_DEFAULT ), H5Aclose, "open attribute" };
+        h5_handle type{ H5Aget_type( attribute ), H5Tclose, "get attribute type" };
+        std::string result( H5Tget_size( type ), '\0' );
+        check( H5Aread( attribute, type, result.data() ), "read attribute" );
+
+        return result.substr( 0, result.find( '\0' ) );
+    }
+
+    /// dataset dimensions: (frames, ny, nx)
+    using dims_t = std::array<hsize_t, 3>;
+
+#else
+
+    [[noreturn]] void no_hdf5()
+    {
+        throw std::runtime_error( "openpiv was built without HDF5 support" );
+    }
+
+#endif
+
+}
+
+namespace openpiv::core {
+
+    bool has_hdf5()
+    {
+#if defined(OPENPIV_HAS_HDF5)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#if defined(OPENPIV_HAS_HDF5)
+
+    template < typename T >
+    struct hdf5_vector_field_file<T>::impl
+    {
+        impl( const std::string& path, const vector_field_parameters& parameters, const hdf5_options& options )
+            : options_( options )
+        {
+            std::unique_lock<std::mutex> lock( hdf5_mutex() );
+            id_ = { H5Fcreate( path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT ), H5Fclose, "create file" };
+
+            const std::array<uint32_t, 2> window_size{ parameters.window_size.width(), parameters.window_size.height() };
+            const std::array<uint32_t, 2> window_spacing{ parameters.window_spacing.width(), parameters.window_spacing.height() };
+            write_attribute( id_, "window_size", H5T_NATIVE_UINT32, window_size.data(), 2 );
+            write_attribute( id_, "window_spacing", H5T_NATIVE_UINT32, window_spacing.data(), 2 );
+            write_attribute( id_, "dt", H5T_NATIVE_DOUBLE, &parameters.dt, 1 );
+            write_attribute( id_, "scale", H5T_NATIVE_DOUBLE, &parameters.scale, 1 );
+            write_attribute( id_, "position_units", parameters.position_units );
+            write_attribute( id_, "velocity_units", parameters.velocity_units );
+        }
+
+        /// create the datasets on the first frame, when the shape is known
+        void create( uint32_t nx, uint32_t ny )
+        {
+            if ( nx == 0 || ny == 0 )
+                exception_builder<std::runtime_error>() << "HDF5: cannot write an empty vector field";
+
+            const std::array<uint32_t, 2> shape{ nx, ny };
+            write_attribute( id_, "shape", H5T_NATIVE_UINT32, shape.data(), 2 );
+
+            dims_ = { 0, ny, nx };
+            const dims_t max_dims{ H5S_UNLIMITED, ny, nx };
+            const dims_t chunk{ 1, ny, nx };
+
+            h5_handle properties{ H5Pcreate( H5P_DATASET_CREATE ), H5Pclose, "create dataset properties" };
+            check( H5Pset_chunk( properties, 3, chunk.data() ), "set chunk size" );
+            if ( options_.compression > 0 && H5Zfilter_avail( H5Z_FILTER_DEFLATE ) > 0 )
+            {
+                if ( options_.shuffle )
+                    check( H5Pset_shuffle( properties ), "set shuffle" );
+                check( H5Pset_deflate( properties, std::min( options_.compression, 9u ) ), "set compression" );
+            }
+
+            h5_handle space{ H5Screate_simple( 3, dims_.data(), max_dims.data() ), H5Sclose, "create dataspace" };
+            for ( size_t c=0; c<dataset_names.size(); ++c )
+            {
+                const hid_t type = c == dataset_names.size() - 1 ? native_type<uint8_t>() : native_type<T>();
+                datasets_[c] = { H5Dcreate2( id_, dataset_names[c], type, space, H5P_DEFAULT, properties, H5P_DEFAULT ),
+                                 H5Dclose, "create dataset" };
+            }
+        }
+
+        void append( const vector_field<T>& field )
+        {
+            std::unique_lock<std::mutex> lock( hdf5_mutex() );
+            if ( dims_[0] == 0 && dims_[1] == 0 )
+                create( field.nx(), field.ny() );
+
+            if ( field.nx() != dims_[2] || field.ny() != dims_[1] )
+                exception_builder<std::runtime_error>()
+                    << "HDF5: vector field shape " << field.shape()
+                    << " differs from (" << dims_[2] << ", " << dims_[1] << ")";
+
+            const std::array<const void*, 6> columns{
+                field.x(), field.y(), field.u(), field.v(), field.quality(), field.flags() };
+
+            const dims_t extended{ dims_[0] + 1, dims_[1], dims_[2] };
+            const dims_t start{ dims_[0], 0, 0 };
+            const dims_t count{ 1, dims_[1], dims_[2] };
+            h5_handle memory_space{ H5Screate_simple( 3, count.data(), nullptr ), H5Sclose, "create dataspace" };
+
+            for ( size_t c=0; c<datasets_.size(); ++c )
+            {
+                check( H5Dset_extent( datasets_[c], extended.data() ), "extend dataset" );
+                h5_handle file_space{ H5Dget_space( datasets_[c] ), H5Sclose, "get dataspace" };
+                check( H5Sselect_hyperslab( file_space, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr ),
+                       "select frame" );
+
+                const hid_t type = c == datasets_.size() - 1 ? native_type<uint8_t>() : native_type<T>();
+                check( H5Dwrite( datasets_[c], type, memory_space, file_space, H5P_DEFAULT, columns[c] ),
+                       "write frame" );
+            }
+
+            dims_ = extended;
+        }
+
+        void close()
+        {
+            std::unique_lock<std::mutex> lock( hdf5_mutex() );
+            for ( auto& dataset : datasets_ )
+                dataset = {};
+
+            if ( id_ >= 0 )
+                check( H5Fflush( id_, H5F_SCOPE_LOCAL ), "flush file" );
+            id_ = {};
+        }
+
+        hdf5_options options_;
+        h5_handle id_;
+        std::array<h5_handle, 6> datasets_;
+        dims_t dims_{ 0, 0, 0 };
+    };
+
+    template < typename T >
+    hdf5_vector_field_file<T>::hdf5_vector_field_file( const std::string& path,
+                                                       const vector_field_parameters& parameters,
+                                                       const hdf5_options& options )
+        : impl_( std::make_unique<impl>( path, parameters, options ) )
+    {}
+
+    template < typename T >
+    void hdf5_vector_field_file<T>::append( const vector_field<T>& field )
+    {
+        if ( !impl_ )
+            exception_builder<std::runtime_error>() << "HDF5 vector field file is closed";
+
+        impl_->append( field );
+    }
+
+    template < typename T >
+    size_t hdf5_vector_field_file<T>::frames() const
+    {
+        return impl_ ? impl_->dims_[0] : 0;
+    }
+
+    template < typename T >
+    void hdf5_vector_field_file<T>::close()
+    {
+        if ( impl_ )
+        {
+            auto i = std::move( impl_ );
+            i->close();
+        }
+    }
+
+    template < typename T >
+    hdf5_vector_field_writer<T>::hdf5_vector_field_writer( const std::string& path,
+                                                           const vector_field_parameters& parameters,
+                                                           const hdf5_options& options )
+        : file_( path, parameters, options )
+        , queue_( std::max<size_t>( 1, options.queue_depth ) )
+    {
+        thread_ = std::thread( [this](){ run(); } );
+    }
+
+    template < typename T >
+    void hdf5_vector_field_writer<T>::run()
+    {
+        while ( auto field = queue_.pop() )
+        {
+            if ( failed_ )
+                continue;
+
+            try
+            {
+                file_.append( *field );
+                ++frames_written_;
+            }
+            catch (...)
+            {
+                error_ = std::current_exception();
+                failed_ = true;
+                queue_.close();
+            }
+        }
+    }
+
+#else
+
+    template < typename T >
+    struct hdf5_vector_field_file<T>::impl
+    {};
+
+    template < typename T >
+    hdf5_vector_field_file<T>::hdf5_vector_field_file( const std::string&,
+                                                       const vector_field_parameters&,
+                                                       const hdf5_options& )
+    {
+        no_hdf5();
+    }
+
+    template < typename T >
+    void hdf5_vector_field_file<T>::append( const vector_field<T>& )
+    {
+        no_hdf5();
+    }
+
+    template < typename T >
+    size_t hdf5_vector_field_file<T>::frames() const
+    {
+        return 0;
+    }
+
+    template < typename T >
+    void hdf5_vector_field_file<T>::close()
+    {}
+
+    template < typename T >
+    hdf5_vector_field_writer<T>::hdf5_vector_field_writer( const std::string& path,
+                                                           const vector_field_parameters& parameters,
+                                                           const hdf5_options& options )
+        : file_( path, parameters, options )
+        , queue_( 1 )
+    {}
+
+    template < typename T >
+    void hdf5_vector_field_writer<T>::run()
+    {}
+
+#endif
+
+    template < typename T >
+    hdf5_vector_field_file<T>::~hdf5_vector_field_file()
+    {
+        try
+        {
+            close();
+        }
+        catch ( std::exception& e )
+        {
+            logger::error( "failed to close HDF5 vector field file: {}", e.what() );
+        }
+    }
+
+    template < typename T >
+    hdf5_vector_field_writer<T>::~hdf5_vector_field_writer()
+    {
+        try
+        {
+            close();
+        }
+        catch ( std::exception& e )
+        {
+            logger::error( "failed to write HDF5 vector field: {}", e.what() );
+        }
+    }
+
+    template < typename T >
+    void hdf5_vector_field_writer<T>::write( vector_field<T> field )
+    {
+        rethrow_if_failed();
+        if ( !queue_.push( std::move( field ) ) )
+        {
+            rethrow_if_failed();
+            exception_builder<std::runtime_error>() << "HDF5 vector field writer is closed";
+        }
+    }
+
+    template < typename T >
+    void hdf5_vector_field_writer<T>::close()
+    {
+        queue_.close();
+        if ( thread_.joinable() )
+            thread_.join();
+
+        file_.close();
+        rethrow_if_failed();
+    }
+
+    template < typename T >
+    void hdf5_vector_field_writer<T>::rethrow_if_failed()
+    {
+        if ( failed_ && error_ )
+        {
+            // only report the error once
+            auto error = std::exchange( error_, nullptr );
+            std::rethrow_exception( error );
+        }
+    }
+
+    size_t hdf5_frame_count( const std::string& path )
+    {
+#if defined(OPENPIV_HAS_HDF5)
+        std::unique_lock<std::mutex> lock( hdf5_mutex() );
+        h5_handle file{ H5Fopen( path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT ), H5Fclose, "open file" };
+        if ( H5Lexists( file, dataset_names[0], H5P_DEFAULT ) <= 0 )
+            return 0;
+
+        h5_handle dataset{ H5Dopen2( file, dataset_names[0], H5P_DEFAULT ), H5Dclose, "open dataset" };
+        h5_handle space{ H5Dget_space( dataset ), H5Sclose, "get dataspace" };
+        dims_t dims;
+        check( H5Sget_simple_extent_dims( space, dims.data(), nullptr ), "get dimensions" );
+
+        return dims[0];
+#else
+        (void)path;
+        no_hdf5();
+#endif
+    }
+
+    template < typename T >
+    vector_field<T> read_hdf5_vector_field( const std::string& path,
+                                            size_t frame,
+                                            vector_field_parameters* parameters )
+    {
+#if defined(OPENPIV_HAS_HDF5)
+        std::unique_lock<std::mutex> lock( hdf5_mutex() );
+        h5_handle file{ H5Fopen( path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT ), H5Fclose, "open file" };
+
+        if ( parameters )
+        {
+            std::array<uint32_t, 2> window_size, window_spacing;
+            read_attribute( file, "window_size", H5T_NATIVE_UINT32, window_size.data() );
+            read_attribute( file, "window_spacing", H5T_NATIVE_UINT32, window_spacing.data() );
+            parameters->window_size = { window_size[0], window_size[1] };
+            parameters->window_spacing = { window_spacing[0], window_spacing[1] };
+            read_attribute( file, "dt", H5T_NATIVE_DOUBLE, &parameters->dt );
+            read_attribute( file, "scale", H5T_NATIVE_DOUBLE, &parameters->scale );
+            parameters->position_units = read_string_attribute( file, "position_units" );
+            parameters->velocity_units = read_string_attribute( file, "velocity_units" );
+        }
+
+        vector_field<T> result;
+        for ( size_t c=0; c<dataset_names.size(); ++c )
+        {
+            h5_handle dataset{ H5Dopen2( file, dataset_names[c], H5P_DEFAULT ), H5Dclose, "open dataset" };
+            h5_handle file_space{ H5Dget_space( dataset ), H5Sclose, "get dataspace" };
+            dims_t dims;
+            check( H5Sget_simple_extent_dims( file_space, dims.data(), nullptr ), "get dimensions" );
+            if ( frame >= dims[0] )
+                exception_builder<std::out_of_range>()
+                    << "HDF5: frame " << frame << " out of range, " << path << " has " << dims[0] << " frames";
+
+            if ( result.empty() )
+                result.resize( static_cast<uint32_t>(dims[2]), static_cast<uint32_t>(dims[1]) );
+
+            const dims_t start{ frame, 0, 0 };
+            const dims_t count{ 1, dims[1], dims[2] };
+            check( H5Sselect_hyperslab( file_space, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr ),
+                   "select frame" );
+            h5_handle memory_space{ H5Screate_simple( 3, count.data(), nullptr ), H5Sclose, "create dataspace" };
+
+            const std::array<void*, 6> columns{
+                result.x(), result.y(), result.u(), result.v(), result.quality(), result.flags() };
+            const hid_t type = c == dataset_names.size() - 1 ? native_type<uint8_t>() : native_type<T>();
+            check( H5Dread( dataset, type, memory_space, file_space, H5P_DEFAULT, columns[c] ), "read frame" );
+        }
+
+        return result;
+#else
+        (void)path;
+        (void)frame;
+        (void)parameters;
+        no_hdf5();
+#endif
+    }
+
+    // explicit instantiations
+    template class hdf5_vector_field_file<float>;
+    template class hdf5_vector_field_file<double>;
+    template class hdf5_vector_field_writer<float>;
+    template class hdf5_vector_field_writer<double>;
+    template vector_field<float> read_hdf5_vector_field<float>( const std::string&, size_t, vector_field_parameters* );
+    template vector_field<double> read_hdf5_vector_field<double>( const std::string&, size_t, vector_field_parameters* );
+
+}
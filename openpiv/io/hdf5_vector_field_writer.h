@@ -0,0 +1,124 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+
+// openpiv
+#include "core/bounded_queue.h"
+#include "core/vector_field.h"
+#include "io/vector_field_io.h"
+
+namespace openpiv::core {
+
+    /// \returns true if the library was built with HDF5 support; if
+    /// not, the functions and classes below throw std::runtime_error
+    bool has_hdf5();
+
+    /// options for HDF5 output
+    struct hdf5_options
+    {
+        uint32_t compression = 4;   ///< deflate level: 0 (none) to 9
+        bool shuffle = true;        ///< shuffle bytes before compressing
+        size_t queue_depth = 4;     ///< frames queued before write() blocks
+    };
+
+    /// An HDF5 file holding vector fields as frames of a time series.
+    /// Each of the datasets /x, /y, /u, /v, /quality and /flags has
+    /// shape (frames, ny, nx) and is extended by one frame per append;
+    /// datasets are chunked by frame and optionally compressed.
+    /// Processing parameters are stored as attributes of the root
+    /// group.
+    ///
+    /// Appending is synchronous; see \sa hdf5_vector_field_writer to
+    /// write on a background thread. All frames must have the same
+    /// shape.
+    template < typename T >
+    class hdf5_vector_field_file
+    {
+    public:
+        /// create (or truncate) the file at \a path
+        hdf5_vector_field_file( const std::string& path,
+                                const vector_field_parameters& parameters = {},
+                                const hdf5_options& options = {} );
+
+        /// closes the file; errors are logged rather than thrown
+        ~hdf5_vector_field_file();
+
+        hdf5_vector_field_file( const hdf5_vector_field_file& ) = delete;
+        hdf5_vector_field_file& operator=( const hdf5_vector_field_file& ) = delete;
+
+        /// append \a field as the next frame
+        void append( const vector_field<T>& field );
+
+        /// number of frames appended
+        size_t frames() const;
+
+        /// flush and close the file
+        void close();
+
+    private:
+        struct impl;
+        std::unique_ptr<impl> impl_;
+    };
+
+    /// Appends vector fields to an \sa hdf5_vector_field_file.
+    ///
+    /// Compression and writing happen on a background thread so
+    /// write() returns immediately unless \sa hdf5_options::queue_depth
+    /// frames are already pending. Errors on the background thread
+    /// are rethrown by the next call to write() or close().
+    template < typename T >
+    class hdf5_vector_field_writer
+    {
+    public:
+        hdf5_vector_field_writer( const std::string& path,
+                                  const vector_field_parameters& parameters = {},
+                                  const hdf5_options& options = {} );
+
+        /// closes the file; errors are logged rather than thrown, call
+        /// \sa close to handle them
+        ~hdf5_vector_field_writer();
+
+        hdf5_vector_field_writer( const hdf5_vector_field_writer& ) = delete;
+        hdf5_vector_field_writer& operator=( const hdf5_vector_field_writer& ) = delete;
+
+        /// queue \a field to be appended; a field passed by value is
+        /// independent of the caller's, move it in to avoid a copy.
+        /// Only a field from \sa vector_field::share aliases the
+        /// caller's storage, which must then not be modified
+        void write( vector_field<T> field );
+
+        /// write all queued frames and close the file
+        void close();
+
+        /// number of frames written to the file so far
+        size_t frames_written() const { return frames_written_; }
+
+    private:
+        void run();
+        void rethrow_if_failed();
+
+        hdf5_vector_field_file<T> file_;
+        bounded_queue<vector_field<T>> queue_;
+        std::thread thread_;
+        std::exception_ptr error_;
+        std::atomic<bool> failed_{ false };
+        std::atomic<size_t> frames_written_{ 0 };
+    };
+
+    /// \returns the number of frames in the HDF5 vector field file at \a path
+    size_t hdf5_frame_count( const std::string& path );
+
+    /// read frame \a frame from the HDF5 vector field file at \a path;
+    /// parameters are returned via \a parameters if non-null
+    template < typename T >
+    vector_field<T> read_hdf5_vector_field( const std::string& path,
+                                            size_t frame,
+                                            vector_field_parameters* parameters = nullptr );
+
+}
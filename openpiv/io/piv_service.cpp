@@ -0,0 +1,266 @@
+#include "io/piv_service.h"
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// platform
+#if defined(_WIN32)
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+// local
+#include "core/exception_builder.h"
+#include "core/log.h"
+#include "core/mapped_image.h"
+#include "io/vector_field_io.h"
+
+namespace logger = openpiv::core::logger;
+
+namespace {
+
+    using namespace openpiv::core;
+
+    constexpr uint32_t magic = 0x5649504f;  // "OPIV"
+    constexpr uint32_t version = 1;
+    constexpr auto poll_interval = std::chrono::milliseconds( 100 );
+
+    static_assert( sizeof(g_8) == 1 && sizeof(g_16) == 2 && sizeof(g_f) == 8 );
+
+    long process_id()
+    {
+#if defined(_WIN32)
+        return _getpid();
+#else
+        return ::getpid();
+#endif
+    }
+
+    template < size_t N >
+    void copy_string( char (&to)[N], const std::string& from )
+    {
+        if ( from.size() >= N )
+            exception_builder<std::runtime_error>() << "path is too long: " << from;
+
+        std::memset( to, 0, N );
+        std::memcpy( to, from.data(), from.size() );
+    }
+
+    template < size_t N >
+    std::string read_string( const char (&from)[N] )
+    {
+        return std::string( from, strnlen( from, N ) );
+    }
+
+    /// map both images of a request from \a buffer and call \a handler
+    template < typename T >
+    vector_field_d handle_pair( const piv_pair_handler_t<T>& handler,
+                                std::shared_ptr<mapped_file> buffer,
+                                const size& s )
+    {
+        if ( !handler )
+            exception_builder<std::runtime_error>() << "unsupported pixel type: " << pixeltype_name<T>();
+
+        const auto a = map_image<T>( buffer, s );
+        const auto b = map_image<T>( buffer, s, s.area() * sizeof(T) );
+        return handler( a, b );
+    }
+
+}
+
+namespace openpiv::core {
+
+    std::string shared_memory_directory()
+    {
+        std::error_code ec;
+        if ( std::filesystem::is_directory( "/dev/shm", ec ) )
+            return "/dev/shm";
+
+        return std::filesystem::temp_directory_path().string();
+    }
+
+    piv_service::piv_service( const std::string& socket_path, piv_handlers handlers )
+        : listener_( local_socket::listen( socket_path ) )
+        , handlers_( std::move( handlers ) )
+    {}
+
+    void piv_service::run()
+    {
+        while ( !stop_ )
+        {
+            if ( !listener_.wait_readable( poll_interval ) )
+                continue;
+
+            auto connection = listener_.accept();
+            logger::debug( "piv service: client connected" );
+
+            try
+            {
+                while ( !stop_ )
+                {
+                    if ( !connection.wait_readable( poll_interval ) )
+                        continue;
+
+                    piv_request request;
+                    if ( !connection.receive_all( &request, sizeof(request) ) )
+                        break;
+
+                    piv_response response;
+                    if ( request.magic == magic && request.type == piv_request::SHUTDOWN )
+                    {
+                        logger::info( "piv service: shutdown requested" );
+                        stop_ = true;
+                        response.magic = magic;
+                    }
+                    else
+                        response = handle( request );
+
+                    connection.send_all( &response, sizeof(response) );
+                }
+            }
+            catch ( std::exception& e )
+            {
+                logger::error( "piv service: dropping connection: {}", e.what() );
+            }
+
+            logger::debug( "piv service: client disconnected" );
+        }
+    }
+
+    piv_response piv_service::handle( const piv_request& request )
+    {
+        piv_response response;
+        response.magic = magic;
+
+        try
+        {
+            if ( request.magic != magic || request.version != version )
+                exception_builder<std::runtime_error>() << "unsupported request";
+            if ( request.type != piv_request::PROCESS )
+                exception_builder<std::runtime_error>() << "unknown request type: " << request.type;
+
+            const uint32_t bpp = request.bytes_per_pixel;
+            if ( bpp != 1 && bpp != 2 && bpp != 8 )
+                exception_builder<std::runtime_error>() << "unsupported bytes per pixel: " << bpp;
+
+            // pixels are used in place; the client doesn't touch the
+            // buffer until it has the response
+            const auto image_path = read_string( request.image_path );
+            auto buffer = std::make_shared<mapped_file>( image_path );
+            const size s{ request.width, request.height };
+            if ( s.area() == 0 || buffer->size() < 2 * s.area() * bpp )
+                exception_builder<std::runtime_error>()
+                    << image_path << " is too small for two " << request.width << "x" << request.height << " images";
+
+            const auto field =
+                bpp == 1 ? handle_pair( handlers_.g8, std::move( buffer ), s ) :
+                bpp == 2 ? handle_pair( handlers_.g16, std::move( buffer ), s ) :
+                           handle_pair( handlers_.gf, std::move( buffer ), s );
+            write_vector_field( read_string( request.result_path ), field );
+
+            response.nx = field.nx();
+            response.ny = field.ny();
+            ++requests_;
+        }
+        catch ( std::exception& e )
+        {
+            logger::error( "piv service: request failed: {}", e.what() );
+            response.status = 1;
+            std::strncpy( response.message, e.what(), sizeof(response.message) - 1 );
+        }
+
+        return response;
+    }
+
+    piv_client::piv_client( const std::string& socket_path, const std::string& buffer_directory )
+        : socket_( local_socket::connect( socket_path ) )
+    {
+        static std::atomic<size_t> counter{ 0 };
+        const auto prefix =
+            buffer_directory + "/openpiv-client-" + std::to_string( process_id() ) + "-" + std::to_string( counter++ );
+        image_path_ = prefix + ".pair";
+        result_path_ = prefix + ".vec";
+    }
+
+    piv_client::~piv_client()
+    {
+        image_buffer_.close();
+        std::remove( image_path_.c_str() );
+        std::remove( result_path_.c_str() );
+    }
+
+    template < typename T >
+    vector_field_d piv_client::process_pair( const image<T>& a, const image<T>& b )
+    {
+        if ( a.size() != b.size() )
+            exception_builder<std::runtime_error>() << "image sizes don't match: " << a.size() << ", " << b.size();
+
+        // the buffer is only recreated when the image size changes
+        const size_t bytes = a.pixel_count() * sizeof(T);
+        if ( image_buffer_.size() != 2 * bytes )
+            image_buffer_ = mapped_file::create( image_path_, 2 * bytes );
+
+        // images may have padded rows; the buffer is packed
+        const size_t row_bytes = a.width() * sizeof(T);
+        uint8_t* out = image_buffer_.data();
+        for ( const auto* im : { &a, &b } )
+            for ( uint32_t h=0; h<im->height(); ++h, out += row_bytes )
+                std::memcpy( out, im->line( h ), row_bytes );
+
+        piv_request request;
+        request.magic = magic;
+        request.version = version;
+        request.type = piv_request::PROCESS;
+        request.width = a.width();
+        request.height = a.height();
+        request.bytes_per_pixel = sizeof(T);
+        copy_string( request.image_path, image_path_ );
+        copy_string( request.result_path, result_path_ );
+        socket_.send_all( &request, sizeof(request) );
+
+        piv_response response;
+        if ( !socket_.receive_all( &response, sizeof(response) ) )
+            exception_builder<std::runtime_error>() << "piv service closed the connection";
+        if ( response.status != 0 )
+            exception_builder<std::runtime_error>() << "piv service: " << read_string( response.message );
+
+        // copy: the service replaces the result file on the next request
+        return read_vector_field<double>( result_path_ ).clone();
+    }
+
+    vector_field_d piv_client::process( const g8_image& a, const g8_image& b )
+    {
+        return process_pair( a, b );
+    }
+
+    vector_field_d piv_client::process( const g16_image& a, const g16_image& b )
+    {
+        return process_pair( a, b );
+    }
+
+    vector_field_d piv_client::process( const gf_image& a, const gf_image& b )
+    {
+        return process_pair( a, b );
+    }
+
+    void piv_client::shutdown()
+    {
+        piv_request request;
+        request.magic = magic;
+        request.version = version;
+        request.type = piv_request::SHUTDOWN;
+        socket_.send_all( &request, sizeof(request) );
+
+        piv_response response;
+        socket_.receive_all( &response, sizeof(response) );
+    }
+
+}
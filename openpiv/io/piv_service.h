@@ -0,0 +1,155 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+// openpiv
+#include "core/image.h"
+#include "core/local_socket.h"
+#include "core/mapped_file.h"
+#include "core/vector_field.h"
+
+namespace openpiv::core {
+
+    /// Local PIV service: a long-running process accepts requests over
+    /// a Unix domain socket and exchanges image pairs and vector
+    /// fields with its clients through shared memory, i.e. files on a
+    /// memory-backed file system mapped by both processes, so only a
+    /// small fixed-size message crosses the socket per pair.
+    ///
+    /// A request names a buffer holding both images of a pair,
+    /// consecutively in row-major order, and a path for the result,
+    /// which the service writes in the format of \sa write_vector_field.
+    /// All values are in native byte order; client and service must
+    /// run on the same host.
+
+    /// fixed-size request message
+    struct piv_request
+    {
+        enum type_t : uint32_t { PROCESS = 1, SHUTDOWN = 2 };
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t type = PROCESS;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t bytes_per_pixel = 0;   ///< 1 (g8), 2 (g16) or 8 (gf)
+        char image_path[256] = {};      ///< buffer holding both images
+        char result_path[256] = {};     ///< vector field written here
+    };
+
+    /// fixed-size response message
+    struct piv_response
+    {
+        uint32_t magic = 0;
+        uint32_t status = 0;            ///< zero on success
+        uint32_t nx = 0;
+        uint32_t ny = 0;
+        char message[256] = {};         ///< error message if status is non-zero
+    };
+
+    /// \returns the directory used for shared buffers: /dev/shm if
+    /// present, otherwise the system temporary directory
+    std::string shared_memory_directory();
+
+    /// handlers for an image pair of pixel type \a T
+    template < typename T >
+    using piv_pair_handler_t = std::function<vector_field_d(const image<T>&, const image<T>&)>;
+
+    /// one handler per pixel type a client may send
+    struct piv_handlers
+    {
+        piv_pair_handler_t<g_8> g8;
+        piv_pair_handler_t<g_16> g16;
+        piv_pair_handler_t<g_f> gf;
+    };
+
+    /// Serves PIV requests on a Unix domain socket.
+    ///
+    /// For each request the image pair is mapped from the client's
+    /// buffer, without copying or converting the pixels, and passed to
+    /// the handler for its pixel type to produce the vector field; the
+    /// images are only valid during the call. Anything expensive to set
+    /// up (loaders, FFT plans, worker threads) should be created once
+    /// and captured by the handler so that each request only pays for
+    /// correlation.
+    ///
+    /// Connections are served one at a time, in the order accepted.
+    /// Errors raised by the handler are returned to the client.
+    class piv_service
+    {
+    public:
+        /// listen at \a socket_path; any stale socket file is replaced
+        piv_service( const std::string& socket_path, piv_handlers handlers );
+
+        /// as above, calling \a handler, e.g. a generic lambda, for
+        /// every pixel type
+        template < typename F,
+                   typename = std::enable_if_t< std::is_invocable_r_v<vector_field_d, F&, const g8_image&, const g8_image&> &&
+                                                std::is_invocable_r_v<vector_field_d, F&, const g16_image&, const g16_image&> &&
+                                                std::is_invocable_r_v<vector_field_d, F&, const gf_image&, const gf_image&> > >
+        piv_service( const std::string& socket_path, F handler )
+            : piv_service( socket_path, piv_handlers{ handler, handler, handler } )
+        {}
+
+        piv_service( const piv_service& ) = delete;
+        piv_service& operator=( const piv_service& ) = delete;
+
+        /// serve requests until \sa stop is called or a client sends
+        /// a shutdown request
+        void run();
+
+        /// ask \sa run to return; may be called from any thread
+        void stop() { stop_ = true; }
+
+        /// number of pairs processed
+        size_t requests() const { return requests_; }
+
+    private:
+        piv_response handle( const piv_request& request );
+
+        local_socket listener_;
+        piv_handlers handlers_;
+        std::atomic<bool> stop_{ false };
+        std::atomic<size_t> requests_{ 0 };
+    };
+
+    /// Connects to a \sa piv_service; the image and result buffers are
+    /// created in \a buffer_directory, reused for each request and
+    /// removed when the client is destroyed.
+    ///
+    /// This class is not thread-safe
+    class piv_client
+    {
+    public:
+        explicit piv_client( const std::string& socket_path,
+                             const std::string& buffer_directory = shared_memory_directory() );
+        ~piv_client();
+
+        piv_client( const piv_client& ) = delete;
+        piv_client& operator=( const piv_client& ) = delete;
+
+        /// process the pair \a a, \a b; throws std::runtime_error if
+        /// the service reports an error
+        vector_field_d process( const g8_image& a, const g8_image& b );
+        vector_field_d process( const g16_image& a, const g16_image& b );
+        vector_field_d process( const gf_image& a, const gf_image& b );
+
+        /// ask the service to shut down
+        void shutdown();
+
+    private:
+        template < typename T >
+        vector_field_d process_pair( const image<T>& a, const image<T>& b );
+
+        local_socket socket_;
+        std::string image_path_;
+        std::string result_path_;
+        mapped_file image_buffer_;
+    };
+
+}
@@ -0,0 +1,172 @@
+#include "io/vector_field_io.h"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+
+// local
+#include "core/exception_builder.h"
+#include "core/mapped_file.h"
+#include "io/detail/vector_field_format.h"
+
+namespace {
+
+    using namespace openpiv::core;
+    using namespace openpiv::core::detail::vector_field_format;
+
+    constexpr magic_t magic{ 'O', 'P', 'I', 'V', 'V', 'E', 'C', '\0' };
+
+    /// on-disk header; see vector_field_io.h for the layout
+    struct file_header
+    {
+        header_prefix prefix;
+        uint64_t column_offsets[column_count];
+    };
+
+    static_assert( offsetof(file_header, column_offsets) == 128 );
+    static_assert( sizeof(file_header) <= header_size );
+
+    /// read and validate the header of a mapped file
+    file_header read_header( const mapped_file& file, const std::string& path )
+    {
+        file_header header;
+        if ( file.size() < header_size )
+            exception_builder<std::runtime_error>() << path << " is too small to be a vector field file";
+
+        std::memcpy( &header, file.data(), sizeof(header) );
+        const auto& prefix = header.prefix;
+        check_prefix( prefix, magic, path, "vector field file" );
+        if ( prefix.value_size != sizeof(float) && prefix.value_size != sizeof(double) )
+            exception_builder<std::runtime_error>() << path << " has unsupported value size: " << prefix.value_size;
+
+        const size_t n = static_cast<size_t>(prefix.nx) * prefix.ny;
+        for ( size_t c=0; c<column_count; ++c )
+        {
+            // written so as not to overflow for corrupt offsets or sizes
+            const size_t value_size = c == column_count - 1 ? 1 : prefix.value_size;
+            const uint64_t offset = header.column_offsets[c];
+            if ( offset % column_alignment != 0 ||
+                 offset < prefix.header_size ||
+                 offset > file.size() ||
+                 n > (file.size() - offset) / value_size )
+                exception_builder<std::runtime_error>() << path << " has an invalid column layout";
+        }
+
+        return header;
+    }
+
+    template < typename T >
+    struct columns_of
+    {
+        template < typename FieldT >
+        static std::array<T*, column_count - 1> get( FieldT& f )
+        {
+            return { f.x(), f.y(), f.u(), f.v(), f.quality() };
+        }
+    };
+
+    /// read values of type \a From into a new field of \a To
+    template < typename From, typename To >
+    vector_field<To> convert_columns( const mapped_file& file, const file_header& header )
+    {
+        vector_field<To> result( header.prefix.nx, header.prefix.ny );
+        const auto to = columns_of<To>::get( result );
+        for ( size_t c=0; c<column_count - 1; ++c )
+        {
+            const auto* from = reinterpret_cast<const From*>( file.data() + header.column_offsets[c] );
+            std::copy( from, from + result.size(), to[c] );
+        }
+
+        const auto* flags = file.data() + header.column_offsets[column_count - 1];
+        std::copy( flags, flags + result.size(), result.flags() );
+
+        return result;
+    }
+
+}
+
+namespace openpiv::core {
+
+    template < typename T >
+    void write_vector_field( const std::string& path,
+                             const vector_field<T>& field,
+                             const vector_field_parameters& parameters )
+    {
+        file_header header{};
+        header.prefix = make_prefix( magic, field.shape(), sizeof(T), parameters );
+
+        const size_t n = field.size();
+        const auto layout = column_layout( header_size, n, sizeof(T) );
+        std::copy( layout.begin(), layout.end() - 1, header.column_offsets );
+
+        auto file = mapped_file::create( path, layout.back() );
+        std::memset( file.data(), 0, header_size );
+        std::memcpy( file.data(), &header, sizeof(header) );
+
+        const auto columns = columns_of<const T>::get( field );
+        for ( size_t c=0; c<column_count - 1; ++c )
+            std::memcpy( file.data() + header.column_offsets[c], columns[c], n * sizeof(T) );
+        std::memcpy( file.data() + header.column_offsets[column_count - 1], field.flags(), n );
+
+        file.flush();
+    }
+
+    template < typename T >
+    vector_field<T> read_vector_field( const std::string& path,
+                                       vector_field_parameters* parameters )
+    {
+        auto file = std::make_shared<mapped_file>( path, mapped_file::mode::COPY_ON_WRITE );
+        const auto header = read_header( *file, path );
+        if ( parameters )
+            *parameters = to_parameters( header.prefix );
+
+        if ( header.prefix.value_size != sizeof(T) )
+        {
+            if ( header.prefix.value_size == sizeof(float) )
+                return convert_columns<float, T>( *file, header );
+
+            return convert_columns<double, T>( *file, header );
+        }
+
+        // zero-copy: columns refer to the mapping which is kept
+        // alive by the field
+        auto column = [&file, &header]( size_t c ) {
+            return reinterpret_cast<T*>( file->data() + header.column_offsets[c] );
+        };
+
+        typename vector_field<T>::columns_t columns{
+            column(0), column(1), column(2), column(3), column(4),
+            reinterpret_cast<vector_flag::type*>( file->data() + header.column_offsets[column_count - 1] ) };
+
+        return { header.prefix.nx, header.prefix.ny, columns, file };
+    }
+
+    template < typename T >
+    void write_vector_field_text( std::ostream& os, const vector_field<T>& field )
+    {
+        for ( size_t i=0; i<field.size(); ++i )
+            os << field.x()[i] << ", " << field.y()[i] << ", "
+               << field.u()[i] << ", " << field.v()[i] << ", "
+               << field.quality()[i] << "\n";
+    }
+
+    void convert_vector_field_to_text( const std::string& path, std::ostream& os )
+    {
+        // values are written as double regardless of the stored type
+        write_vector_field_text( os, read_vector_field<double>( path ) );
+    }
+
+    // explicit instantiations
+    template void write_vector_field<float>( const std::string&, const vector_field<float>&, const vector_field_parameters& );
+    template void write_vector_field<double>( const std::string&, const vector_field<double>&, const vector_field_parameters& );
+    template vector_field<float> read_vector_field<float>( const std::string&, vector_field_parameters* );
+    template vector_field<double> read_vector_field<double>( const std::string&, vector_field_parameters* );
+    template void write_vector_field_text<float>( std::ostream&, const vector_field<float>& );
+    template void write_vector_field_text<double>( std::ostream&, const vector_field<double>& );
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+// std
+#include <iosfwd>
+#include <string>
+
+// openpiv
+#include "core/size.h"
+#include "core/vector_field.h"
+
+namespace openpiv::core {
+
+    /// processing parameters stored alongside a vector field
+    struct vector_field_parameters
+    {
+        core::size window_size;             ///< interrogation window size, pixels
+        core::size window_spacing;          ///< distance between windows, pixels
+        double dt = 1.0;                    ///< time between frames
+        double scale = 1.0;                 ///< position units per pixel
+        std::string position_units = "px";
+        std::string velocity_units = "px/frame";
+    };
+
+    /// Binary vector field file format; all values are in native
+    /// byte order which is recorded by a byte order mark:
+    ///
+    /// offset  size  field
+    /// 0       8     magic "OPIVVEC\0"
+    /// 8       4     format version (1)
+    /// 12      4     byte order mark (0x01020304)
+    /// 16      4     header size in bytes
+    /// 20      4     nx
+    /// 24      4     ny
+    /// 28      4     bytes per value: 4 (float) or 8 (double)
+    /// 32      8     window width, height
+    /// 40      8     window spacing x, y
+    /// 48      8     dt
+    /// 56      8     scale
+    /// 64      32    position units, NUL padded
+    /// 96      32    velocity units, NUL padded
+    /// 128     48    byte offsets of the x, y, u, v, quality and flags columns
+    ///
+    /// Each column is a contiguous block of nx * ny values (flags
+    /// are one byte each) starting on a 64 byte boundary, so a
+    /// mapped file can be used as a vector_field without copying.
+
+    /// write a vector field to \a path; the file is sized up front
+    /// and written through a memory mapping. Throws std::runtime_error
+    /// on failure.
+    template < typename T >
+    void write_vector_field( const std::string& path,
+                             const vector_field<T>& field,
+                             const vector_field_parameters& parameters = {} );
+
+    /// read a vector field from \a path by mapping it; if the stored
+    /// value type matches \a T the returned field refers directly to
+    /// the mapped file (writes are private to the field), otherwise
+    /// values are converted into a new field. Parameters are returned
+    /// via \a parameters if non-null. Throws std::runtime_error if the
+    /// file is not a valid vector field file.
+    template < typename T >
+    vector_field<T> read_vector_field( const std::string& path,
+                                       vector_field_parameters* parameters = nullptr );
+
+    /// write \a field as text, one "x, y, u, v, quality" line per
+    /// vector; this is the layout written by examples/process
+    template < typename T >
+    void write_vector_field_text( std::ostream& os, const vector_field<T>& field );
+
+    /// convert the binary vector field at \a path to text on \a os
+    void convert_vector_field_to_text( const std::string& path, std::ostream& os );
+
+}
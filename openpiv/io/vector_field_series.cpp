@@ -0,0 +1,183 @@
+#include "io/vector_field_series.h"
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+// local
+#include "core/exception_builder.h"
+#include "io/detail/vector_field_format.h"
+
+namespace {
+
+    using namespace openpiv::core;
+    using namespace openpiv::core::detail::vector_field_format;
+
+    constexpr magic_t magic{ 'O', 'P', 'I', 'V', 'V', 'F', 'S', '\0' };
+
+    /// on-disk header; see vector_field_series.h for the layout
+    struct file_header
+    {
+        header_prefix prefix;
+        uint64_t frame_count;
+        uint64_t frame_size;
+        uint64_t status_offset;
+        uint64_t frames_offset;
+    };
+
+    static_assert( offsetof(file_header, frame_count) == 128 );
+    static_assert( offsetof(file_header, frames_offset) == 152 );
+    static_assert( sizeof(file_header) <= header_size );
+
+    // the status array is shared between processes
+    using status_t = std::atomic<uint8_t>;
+    static_assert( sizeof(status_t) == 1 );
+    static_assert( status_t::is_always_lock_free );
+
+    /// byte offset of column \a c within a frame of \a n values
+    size_t column_offset( size_t c, size_t n )
+    {
+        return column_layout( 0, n, sizeof(double) )[c];
+    }
+
+    size_t frame_size( size_t n )
+    {
+        return column_layout( 0, n, sizeof(double) ).back();
+    }
+
+}
+
+namespace openpiv::core {
+
+    vector_field_series vector_field_series::create( const std::string& path,
+                                                     size_t frames,
+                                                     const core::size& shape,
+                                                     const vector_field_parameters& parameters )
+    {
+        file_header header{};
+        header.prefix = make_prefix( magic, shape, sizeof(double), parameters );
+        header.frame_count = frames;
+        header.frame_size = frame_size( shape.area() );
+        header.status_offset = header_size;
+        header.frames_offset = align( header_size + frames );
+
+        // a new file is zero filled so all frames are unwritten
+        auto file = mapped_file::create( path, header.frames_offset + frames * header.frame_size );
+        std::memcpy( file.data(), &header, sizeof(header) );
+        file.flush();
+
+        vector_field_series result;
+        result.file_ = std::make_shared<mapped_file>( std::move( file ) );
+        result.writable_ = true;
+        result.read_header( path );
+
+        return result;
+    }
+
+    vector_field_series::vector_field_series( const std::string& path, mapped_file::mode m )
+        : file_( std::make_shared<mapped_file>( path, m ) )
+        , writable_( m == mapped_file::mode::READ_WRITE )
+    {
+        read_header( path );
+    }
+
+    void vector_field_series::read_header( const std::string& path )
+    {
+        file_header header;
+        if ( file_->size() < header_size )
+            exception_builder<std::runtime_error>() << path << " is too small to be a vector field series";
+
+        std::memcpy( &header, file_->data(), sizeof(header) );
+        const auto& prefix = header.prefix;
+        check_prefix( prefix, magic, path, "vector field series" );
+        if ( prefix.value_size != sizeof(double) )
+            exception_builder<std::runtime_error>() << path << " has unsupported value size: " << prefix.value_size;
+
+        const size_t n = static_cast<size_t>(prefix.nx) * prefix.ny;
+        // written so as not to overflow for corrupt offsets or counts
+        if ( header.frame_size != frame_size( n ) ||
+             header.status_offset < prefix.header_size ||
+             header.status_offset > header.frames_offset ||
+             header.frame_count > header.frames_offset - header.status_offset ||
+             header.frames_offset % column_alignment != 0 ||
+             header.frames_offset > file_->size() ||
+             ( header.frame_size > 0 &&
+               header.frame_count > (file_->size() - header.frames_offset) / header.frame_size ) )
+            exception_builder<std::runtime_error>() << path << " has an invalid layout";
+
+        frames_ = header.frame_count;
+        shape_ = { prefix.nx, prefix.ny };
+        frame_size_ = header.frame_size;
+        status_offset_ = header.status_offset;
+        frames_offset_ = header.frames_offset;
+
+        parameters_ = to_parameters( prefix );
+    }
+
+    void vector_field_series::check_frame( size_t frame ) const
+    {
+        if ( frame >= frames_ )
+            exception_builder<std::out_of_range>() << "frame " << frame << " out of range; series has " << frames_ << " frames";
+    }
+
+    uint8_t* vector_field_series::frame_data( size_t frame ) const
+    {
+        return file_->data() + frames_offset_ + frame * frame_size_;
+    }
+
+    void vector_field_series::write( size_t frame, const vector_field_d& field )
+    {
+        check_frame( frame );
+        if ( !writable_ )
+            exception_builder<std::runtime_error>() << "vector field series is not open for writing";
+        if ( field.shape() != shape_ )
+            exception_builder<std::runtime_error>()
+                << "vector field shape " << field.shape() << " doesn't match series shape " << shape_;
+
+        const size_t n = field.size();
+        uint8_t* data = frame_data( frame );
+        const double* columns[] = { field.x(), field.y(), field.u(), field.v(), field.quality() };
+        for ( size_t c=0; c<column_count - 1; ++c )
+            std::memcpy( data + column_offset( c, n ), columns[c], n * sizeof(double) );
+        std::memcpy( data + column_offset( column_count - 1, n ), field.flags(), n );
+
+        // publish the values before the status
+        auto* status = reinterpret_cast<status_t*>( file_->data() + status_offset_ );
+        status[frame].store( 1, std::memory_order_release );
+    }
+
+    bool vector_field_series::written( size_t frame ) const
+    {
+        check_frame( frame );
+        const auto* status = reinterpret_cast<const status_t*>( file_->data() + status_offset_ );
+        return status[frame].load( std::memory_order_acquire ) != 0;
+    }
+
+    vector_field_d vector_field_series::read( size_t frame ) const
+    {
+        if ( !written( frame ) )
+            exception_builder<std::runtime_error>() << "frame " << frame << " has not been written";
+
+        const size_t n = shape_.area();
+        uint8_t* data = frame_data( frame );
+        auto column = [data, n]( size_t c ) {
+            return reinterpret_cast<double*>( data + column_offset( c, n ) );
+        };
+
+        vector_field_d::columns_t columns{
+            column(0), column(1), column(2), column(3), column(4),
+            reinterpret_cast<vector_flag::type*>( data + column_offset( column_count - 1, n ) ) };
+
+        return { shape_.width(), shape_.height(), columns, file_ };
+    }
+
+    void vector_field_series::flush()
+    {
+        file_->flush();
+    }
+
+}
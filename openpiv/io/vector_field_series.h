@@ -0,0 +1,98 @@
+#pragma once
+
+// std
+#include <memory>
+#include <string>
+
+// openpiv
+#include "core/mapped_file.h"
+#include "core/size.h"
+#include "core/vector_field.h"
+#include "io/vector_field_io.h"
+
+namespace openpiv::core {
+
+    /// A memory-mapped file of equally shaped vector fields indexed
+    /// by frame. The file is sized when it is created; frames may then
+    /// be written in any order, concurrently, by any number of threads
+    /// or processes that have the file open with
+    /// mapped_file::mode::READ_WRITE, provided each frame is written by
+    /// only one of them. A frame is marked as written once its values
+    /// are in place so readers may poll \sa written().
+    ///
+    /// Values are stored as double in native byte order:
+    ///
+    /// offset  size  field
+    /// 0       8     magic "OPIVVFS\0"
+    /// 8       4     format version (1)
+    /// 12      4     byte order mark (0x01020304)
+    /// 16      4     header size in bytes
+    /// 20      4     nx
+    /// 24      4     ny
+    /// 28      4     bytes per value (8)
+    /// 32      8     window width, height
+    /// 40      8     window spacing x, y
+    /// 48      8     dt
+    /// 56      8     scale
+    /// 64      32    position units, NUL padded
+    /// 96      32    velocity units, NUL padded
+    /// 128     8     frame count
+    /// 136     8     bytes per frame
+    /// 144     8     byte offset of the frame status array
+    /// 152     8     byte offset of the first frame
+    ///
+    /// The status array holds one byte per frame, non-zero once the
+    /// frame is written. Each frame holds the x, y, u, v, quality and
+    /// flags columns of nx * ny values, each starting on a 64 byte
+    /// boundary, as in the single field format of \sa write_vector_field.
+    class vector_field_series
+    {
+    public:
+        /// create (or truncate) the file at \a path for \a frames
+        /// fields of \a shape; all frames are initially unwritten
+        static vector_field_series create( const std::string& path,
+                                           size_t frames,
+                                           const core::size& shape,
+                                           const vector_field_parameters& parameters = {} );
+
+        /// open the existing file at \a path; use
+        /// mapped_file::mode::READ_WRITE to write frames. Throws
+        /// std::runtime_error if the file is not a valid series file.
+        explicit vector_field_series( const std::string& path,
+                                      mapped_file::mode m = mapped_file::mode::COPY_ON_WRITE );
+
+        size_t frames() const { return frames_; }
+        core::size shape() const { return shape_; }
+        const vector_field_parameters& parameters() const { return parameters_; }
+
+        /// copy \a field into frame \a frame and mark it as written
+        void write( size_t frame, const vector_field_d& field );
+
+        /// \returns true once frame \a frame has been written
+        bool written( size_t frame ) const;
+
+        /// \returns frame \a frame; the field refers directly to the
+        /// mapped file and keeps it open. Throws std::runtime_error if
+        /// the frame has not been written.
+        vector_field_d read( size_t frame ) const;
+
+        /// write modified pages back to the file
+        void flush();
+
+    private:
+        vector_field_series() = default;
+        void read_header( const std::string& path );
+        void check_frame( size_t frame ) const;
+        uint8_t* frame_data( size_t frame ) const;
+
+        std::shared_ptr<mapped_file> file_;
+        bool writable_ = false;
+        size_t frames_ = 0;
+        core::size shape_;
+        vector_field_parameters parameters_;
+        size_t frame_size_ = 0;
+        size_t status_offset_ = 0;
+        size_t frames_offset_ = 0;
+    };
+
+}
@@ -94,7 +94,9 @@ namespace openpiv::core {
         /// \return true if \a is contains valid image data
         virtual bool open( std::istream& is ) = 0;
 
-        /// Extract an image from an opened stream;
+        /// Extract an image from an opened stream; rows are decoded
+        /// directly into the row layout of the image passed in, see
+        /// \sa image_layout.
         /// may throw ImageLoaderException if there is an issue
         virtual bool extract( size_t index, g16_image& ) = 0;
         virtual bool extract( size_t index, gf_image& ) = 0;
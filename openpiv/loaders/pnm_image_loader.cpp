@@ -66,13 +66,13 @@ namespace {
 
     ///
     template < typename PixelT, uint16_t SampleN, uint16_t BitsPerSample >
-    image<PixelT> copy(std::istream& is, uint32_t width, uint32_t height);
+    image<PixelT> copy(std::istream& is, uint32_t width, uint32_t height, const image_layout& layout);
 
     // 8-bit greyscale to 16-bit greyscale
     template <>
-    g16_image copy<g_16, 1, 8>(std::istream& is, uint32_t width, uint32_t height)
+    g16_image copy<g_16, 1, 8>(std::istream& is, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        g16_image im(width, height, 0);
+        g16_image im({width, height}, 0, layout);
 
         // copy per line
         std::vector<char> buffer(width);
@@ -93,9 +93,9 @@ namespace {
 
     // 16-bit greyscale to 16-bit greyscale
     template <>
-    g16_image copy<g_16, 1, 16>(std::istream& is, uint32_t width, uint32_t height)
+    g16_image copy<g_16, 1, 16>(std::istream& is, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        g16_image im(width, height, 0);
+        g16_image im({width, height}, 0, layout);
 
         // copy per line
         const size_t bytesPerLine = width * sizeof(g_16);
@@ -118,9 +118,9 @@ namespace {
 
     // 8-bit RGB to 16-bit RGBA
     template <>
-    rgba16_image copy<rgba_16, 3, 8>(std::istream& is, uint32_t width, uint32_t height)
+    rgba16_image copy<rgba_16, 3, 8>(std::istream& is, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        rgba16_image im(width, height, 0);
+        rgba16_image im({width, height}, 0, layout);
 
         // copy per line
         const size_t bytesPerLine = 3 * width;
@@ -147,9 +147,9 @@ namespace {
 
     // 16-bit RGB to 16-bit RGBA
     template <>
-    rgba16_image copy<rgba_16, 3, 16>(std::istream& is, uint32_t width, uint32_t height)
+    rgba16_image copy<rgba_16, 3, 16>(std::istream& is, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        rgba16_image im(width, height, 0);
+        rgba16_image im({width, height}, 0, layout);
 
         // copy per line
         const size_t bytesPerLine = 3 * width * sizeof(g_16);
@@ -206,17 +206,17 @@ namespace openpiv::core {
             {
                 // binary greyscale
                 if ( depth > 255 )
-                    im = copy<g_16, 1, 16>( is, width, height );
+                    im = copy<g_16, 1, 16>(is, width, height, im.layout());
                 else
-                    im = copy<g_16, 1, 8>( is, width, height );
+                    im = copy<g_16, 1, 8>(is, width, height, im.layout());
             }
             else
             {
                 // binary RGB
                 if ( depth > 255 )
-                    im = copy<rgba_16, 3, 16>( is, width, height );
+                    im = copy<rgba_16, 3, 16>(is, width, height, im.layout());
                 else
-                    im = copy<rgba_16, 3, 8>( is, width, height );
+                    im = copy<rgba_16, 3, 8>(is, width, height, im.layout());
             }
 
             return true;
@@ -35,13 +35,13 @@ namespace {
     };
 
     template < typename PixelT, planar_config, sample_format, uint16_t SampleN, uint16_t BitsPerSample >
-    image<PixelT> copy(TIFF* tiff, uint32_t width, uint32_t height);
+    image<PixelT> copy(TIFF* tiff, uint32_t width, uint32_t height, const image_layout& layout);
 
     // 8-bit greyscale to 16-bit greyscale
     template <>
-    g16_image copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 8>(TIFF* tiff, uint32_t width, uint32_t height)
+    g16_image copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 8>(TIFF* tiff, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        g16_image im(width, height, 0);
+        g16_image im({width, height}, 0, layout);
 
         // allocate line buffer
         size_t bytesPerLine = TIFFScanlineSize( tiff );
@@ -63,9 +63,9 @@ namespace {
 
     // 16-bit greyscale to 16-bit greyscale
     template <>
-    g16_image copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 16>(TIFF* tiff, uint32_t width, uint32_t height)
+    g16_image copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 16>(TIFF* tiff, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        g16_image im(width, height, 0);
+        g16_image im({width, height}, 0, layout);
 
         // copy the data
         for (uint32_t h=0; h<height; ++h)
@@ -79,9 +79,9 @@ namespace {
 
     // 16-bit RGB to 16-bit RGBA
     template <>
-    rgba16_image copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 16>(TIFF* tiff, uint32_t width, uint32_t height)
+    rgba16_image copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 16>(TIFF* tiff, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        rgba16_image im(width, height, 0);
+        rgba16_image im({width, height}, 0, layout);
 
         // allocate line buffer
         size_t bytesPerLine = TIFFScanlineSize( tiff );
@@ -107,9 +107,9 @@ namespace {
 
     // 8-bit RGB to 16-bit RGBA
     template <>
-    rgba16_image copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 8>(TIFF* tiff, uint32_t width, uint32_t height)
+    rgba16_image copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 8>(TIFF* tiff, uint32_t width, uint32_t height, const image_layout& layout)
     {
-        rgba16_image im(width, height, 0);
+        rgba16_image im({width, height}, 0, layout);
 
         // allocate line buffer
         size_t bytesPerLine = TIFFScanlineSize( tiff );
@@ -220,16 +220,16 @@ namespace openpiv::core {
             if ( spp == 1 )
             {
                 if ( bps == 8 )
-                    im = copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 8>(tiff.get(), width, height);
+                    im = copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 8>(tiff.get(), width, height, im.layout());
                 else
-                    im = copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 16>(tiff.get(), width, height);
+                    im = copy<g_16, planar_config::CONTIG, sample_format::UINT, 1, 16>(tiff.get(), width, height, im.layout());
             }
             else
             {
                 if ( bps == 8 )
-                    im = copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 8>(tiff.get(), width, height);
+                    im = copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 8>(tiff.get(), width, height, im.layout());
                 else
-                    im = copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 16>(tiff.get(), width, height);
+                    im = copy<rgba_16, planar_config::CONTIG, sample_format::UINT, 3, 16>(tiff.get(), width, height, im.layout());
             }
 
             return true;
@@ -0,0 +1,276 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// to be tested
+#include "core/mpmc_queue.h"
+#include "io/async_writer.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    vector_field_d make_field( double u )
+    {
+        vector_field_d f( 2, 1 );
+        f.x()[1] = 16;
+        f.u()[0] = u;
+        f.u()[1] = u;
+        return f;
+    }
+
+    /// records the frames it is given, optionally slowly
+    class recording_sink : public vector_field_sink
+    {
+    public:
+        explicit recording_sink( std::chrono::milliseconds delay = {} )
+            : delay_( delay )
+        {}
+
+        void write( const vector_field_frame& frame ) override
+        {
+            if ( delay_.count() )
+                std::this_thread::sleep_for( delay_ );
+
+            std::unique_lock<std::mutex> lock( *mutex );
+            indices->push_back( frame.index );
+            values->push_back( frame.field.u()[0] );
+        }
+
+        void close() override
+        {
+            *closed = true;
+        }
+
+        std::shared_ptr<std::mutex> mutex = std::make_shared<std::mutex>();
+        std::shared_ptr<std::vector<size_t>> indices = std::make_shared<std::vector<size_t>>();
+        std::shared_ptr<std::vector<double>> values = std::make_shared<std::vector<double>>();
+        std::shared_ptr<bool> closed = std::make_shared<bool>( false );
+
+    private:
+        std::chrono::milliseconds delay_;
+    };
+
+    class failing_sink : public vector_field_sink
+    {
+    public:
+        void write( const vector_field_frame& frame ) override
+        {
+            if ( frame.index == 2 )
+                throw std::runtime_error( "disk full" );
+        }
+    };
+
+}
+
+TEST_CASE("async_writer_test - mpmc_queue")
+{
+    mpmc_queue<int> q( 3 );
+    REQUIRE( q.capacity() == 4 );
+    REQUIRE( !q.try_pop() );
+
+    for ( int i=0; i<4; ++i )
+        REQUIRE( q.try_push( int{ i } ) );
+    REQUIRE( !q.try_push( 4 ) );
+    REQUIRE( q.size() == 4 );
+
+    for ( int i=0; i<4; ++i )
+        REQUIRE( q.try_pop() == i );
+    REQUIRE( !q.try_pop() );
+
+    REQUIRE_THROWS_AS( mpmc_queue<int>( 0 ), std::runtime_error );
+}
+
+TEST_CASE("async_writer_test - mpmc_queue concurrent")
+{
+    constexpr size_t producers = 4;
+    constexpr size_t per_producer = 10000;
+    mpmc_queue<size_t> q( 16 );
+
+    std::vector<std::thread> threads;
+    for ( size_t p=0; p<producers; ++p )
+        threads.emplace_back(
+            [&q, p]()
+            {
+                for ( size_t i=0; i<per_producer; ++i )
+                    while ( !q.try_push( p * per_producer + i ) )
+                        std::this_thread::yield();
+            } );
+
+    std::set<size_t> seen;
+    std::vector<size_t> last( producers, 0 );
+    bool ordered = true;
+    while ( seen.size() < producers * per_producer )
+    {
+        if ( auto v = q.try_pop() )
+        {
+            // each producer's values arrive in order
+            const size_t p = *v / per_producer;
+            ordered = ordered && ( *v % per_producer == 0 || *v > last[p] );
+            last[p] = *v;
+            seen.insert( *v );
+        }
+        else
+            std::this_thread::yield();
+    }
+
+    for ( auto& t : threads )
+        t.join();
+
+    REQUIRE( ordered );
+    REQUIRE( *seen.begin() == 0 );
+    REQUIRE( *seen.rbegin() == producers * per_producer - 1 );
+}
+
+TEST_CASE("async_writer_test - frames are written in order")
+{
+    auto sink = std::make_unique<recording_sink>();
+    auto values = sink->values;
+    auto indices = sink->indices;
+    auto closed = sink->closed;
+
+    async_writer writer( std::move( sink ), 2 );
+    for ( size_t i=0; i<50; ++i )
+        writer.write( make_field( i ) );
+
+    auto stats = writer.close();
+    REQUIRE( *closed );
+    REQUIRE( stats.frames == 50 );
+    REQUIRE( stats.high_water <= 2 );
+    REQUIRE( values->size() == 50 );
+    for ( size_t i=0; i<50; ++i )
+    {
+        REQUIRE( (*indices)[i] == i );
+        REQUIRE( (*values)[i] == i );
+    }
+
+    REQUIRE_THROWS_AS( writer.write( make_field( 0 ) ), std::runtime_error );
+}
+
+TEST_CASE("async_writer_test - slow output is reported")
+{
+    auto sink = std::make_unique<recording_sink>( std::chrono::milliseconds( 5 ) );
+    auto values = sink->values;
+
+    async_writer writer( std::move( sink ), 1 );
+    for ( size_t i=0; i<10; ++i )
+        writer.write( make_field( i ) );
+
+    auto stats = writer.close();
+    REQUIRE( values->size() == 10 );
+    REQUIRE( stats.blocked_time.count() > 0 );
+    REQUIRE( stats.sink_time.count() >= 0.04 );
+    REQUIRE( stats.output_bound() );
+}
+
+TEST_CASE("async_writer_test - fast output is not reported")
+{
+    async_writer writer( std::make_unique<recording_sink>(), 4 );
+    for ( size_t i=0; i<4; ++i )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+        writer.write( make_field( i ) );
+    }
+
+    REQUIRE( !writer.close().output_bound() );
+}
+
+TEST_CASE("async_writer_test - sink errors are rethrown")
+{
+    async_writer writer( std::make_unique<failing_sink>(), 1 );
+    bool thrown = false;
+    try
+    {
+        for ( size_t i=0; i<100; ++i )
+        {
+            writer.write( make_field( i ) );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        writer.close();
+    }
+    catch ( std::runtime_error& e )
+    {
+        thrown = true;
+        REQUIRE( e.what() == "disk full"s );
+    }
+
+    REQUIRE( thrown );
+    REQUIRE_NOTHROW( writer.close() );
+}
+
+TEST_CASE("async_writer_test - text sink")
+{
+    std::stringstream ss;
+    {
+        async_writer writer( std::make_unique<text_sink>( ss ) );
+        writer.write( make_field( 1 ), "a.pgm" );
+        writer.write( make_field( 2 ) );
+    }
+
+    REQUIRE( ss.str() == "# a.pgm\n0, 0, 1, 0, 0\n16, 0, 1, 0, 0\n0, 0, 2, 0, 0\n16, 0, 2, 0, 0\n" );
+}
+
+TEST_CASE("async_writer_test - binary sink")
+{
+    {
+        async_writer writer(
+            std::make_unique<binary_sink>(
+                []( const vector_field_frame& frame ){ return "async_writer_test_" + std::to_string( frame.index ) + ".vec"; } ) );
+        writer.write( make_field( 3 ) );
+        writer.write( make_field( 4 ) );
+        writer.close();
+    }
+
+    REQUIRE( read_vector_field<double>( "async_writer_test_0.vec" ).u()[0] == 3 );
+    REQUIRE( read_vector_field<double>( "async_writer_test_1.vec" ).u()[1] == 4 );
+
+    std::remove( "async_writer_test_0.vec" );
+    std::remove( "async_writer_test_1.vec" );
+}
+
+TEST_CASE("async_writer_test - caller indices")
+{
+    auto sink = std::make_unique<recording_sink>();
+    auto indices = sink->indices;
+
+    // e.g. frames dropped by a realtime pipeline leave gaps
+    async_writer writer( std::move( sink ) );
+    for ( size_t i : { 0, 2, 3, 7 } )
+        writer.write( i, make_field( i ) );
+    writer.close();
+
+    REQUIRE( *indices == std::vector<size_t>{ 0, 2, 3, 7 } );
+}
+
+TEST_CASE("async_writer_test - hdf5 sink")
+{
+    if ( !has_hdf5() )
+        return;
+
+    const std::string path = "async_writer_test.h5";
+    {
+        async_writer writer( std::make_unique<hdf5_sink>( path ) );
+        for ( size_t i=0; i<5; ++i )
+            writer.write( make_field( i ) );
+        REQUIRE( writer.close().frames == 5 );
+    }
+
+    REQUIRE( hdf5_frame_count( path ) == 5 );
+    REQUIRE( read_hdf5_vector_field<double>( path, 4 ).u()[0] == 4 );
+
+    std::remove( path.c_str() );
+}
@@ -0,0 +1,131 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// to be tested
+#include "core/batch.h"
+#include "core/executor.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+using namespace std::literals;
+
+TEST_CASE("batch_test - in flight limit")
+{
+    REQUIRE( batch_in_flight_limit( 0, 100, 3 ) == 4 );
+    REQUIRE( batch_in_flight_limit( 1000, 0, 3 ) == 4 );
+    REQUIRE( batch_in_flight_limit( 1000, 400, 3 ) == 2 );
+    REQUIRE( batch_in_flight_limit( 1000, 4000, 3 ) == 1 );
+    REQUIRE( batch_in_flight_limit( 1000000, 10, 7 ) == 8 );
+}
+
+TEST_CASE("batch_test - results are written in order")
+{
+    static constexpr size_t count = 40;
+    work_stealing_executor executor( 3 );
+
+    std::vector<size_t> written;
+    auto stats = run_batch(
+        executor,
+        count,
+        []( size_t i ) { return std::vector<size_t>( 100, i ); },
+        [&executor]( size_t i, std::vector<size_t>&& v )
+        {
+            // later items finish first
+            std::this_thread::sleep_for( std::chrono::microseconds( 50 * (count - i) ) );
+
+            std::atomic<size_t> sum{ 0 };
+            executor.parallel_for( 0, v.size(), [&]( size_t j ) { sum += v[j]; }, 10 );
+            return sum.load();
+        },
+        [&written]( size_t i, size_t&& sum ) { written.push_back( sum == 100 * i ? i : count ); } );
+
+    REQUIRE( stats.count == count );
+    REQUIRE( stats.in_flight == 4 );
+    REQUIRE( written.size() == count );
+    for ( size_t i=0; i<count; ++i )
+        REQUIRE( written[i] == i );
+}
+
+TEST_CASE("batch_test - in flight items are limited")
+{
+    work_stealing_executor executor( 4 );
+
+    std::atomic<size_t> loaded{ 0 };
+    std::atomic<size_t> peak{ 0 };
+    batch_options options;
+    options.max_in_flight = 2;
+
+    auto stats = run_batch(
+        executor,
+        20,
+        [&]( size_t i )
+        {
+            const size_t n = ++loaded;
+            size_t p = peak;
+            while ( n > p && !peak.compare_exchange_weak( p, n ) )
+                ;
+            return i;
+        },
+        [&]( size_t, size_t&& i )
+        {
+            // blocks of this item run on all workers
+            executor.parallel_for( 0, 64, []( size_t ) { std::this_thread::sleep_for( 10us ); }, 4 );
+            --loaded;
+            return i;
+        },
+        []( size_t, size_t&& ) {},
+        options );
+
+    REQUIRE( stats.in_flight == 2 );
+    REQUIRE( peak <= 2 );
+    REQUIRE( peak >= 1 );
+}
+
+TEST_CASE("batch_test - no workers")
+{
+    work_stealing_executor executor( 0 );
+    std::vector<size_t> written;
+    auto stats = run_batch(
+        executor,
+        5,
+        []( size_t i ) { return i; },
+        []( size_t, size_t&& i ) { return i * i; },
+        [&written]( size_t, size_t&& v ) { written.push_back( v ); } );
+
+    REQUIRE( stats.in_flight == 1 );
+    REQUIRE( written == std::vector<size_t>{ 0, 1, 4, 9, 16 } );
+}
+
+TEST_CASE("batch_test - errors are rethrown")
+{
+    work_stealing_executor executor( 2 );
+    std::atomic<size_t> processed{ 0 };
+
+    REQUIRE_THROWS_AS(
+        run_batch(
+            executor,
+            1000,
+            []( size_t i ) { return i; },
+            [&processed]( size_t, size_t&& i ) {
+                if ( i == 3 )
+                    throw std::runtime_error( "bad pair" );
+                ++processed;
+                std::this_thread::sleep_for( 100us );
+                return i;
+            },
+            []( size_t, size_t&& ) {} ),
+        std::runtime_error );
+
+    REQUIRE( processed < 999 );
+}
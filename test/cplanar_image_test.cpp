@@ -0,0 +1,130 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cmath>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "algos/fft.h"
+#include "algos/pocket_fft.h"
+#include "core/cplanar_image.h"
+#include "core/image_utils.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+using namespace openpiv::algos;
+
+namespace {
+    cf_image make_complex( uint32_t w, uint32_t h, double phase )
+    {
+        cf_image result{ w, h };
+        for ( uint32_t y=0; y<h; ++y )
+            for ( uint32_t x=0; x<w; ++x )
+                result[ {x, y} ] = c_f{ std::sin( 0.1*x + phase ), std::cos( 0.3*y - phase ) };
+
+        return result;
+    }
+}
+
+TEST_CASE("cplanar_image_test - planes")
+{
+    const cf_image c{ make_complex( 30, 20, 0.5 ) };
+    cplanar_f_image p{ c };
+
+    REQUIRE( p.size() == c.size() );
+    REQUIRE( p.real().layout() == image_layout::aligned() );
+    REQUIRE( (p[ {7, 3} ] == c[ {7, 3} ]) );
+    REQUIRE( p.real()[ {7, 3} ] == c[ {7, 3} ].real );
+    REQUIRE( p.imag()[ {7, 3} ] == c[ {7, 3} ].imag );
+    REQUIRE( p.interleaved() == c );
+
+    p.set( {1, 2}, c_f{ 5, -5 } );
+    REQUIRE( (p[ {1, 2} ] == c_f{ 5, -5 }) );
+
+    // split/join
+    auto [re, im] = split_to_channels( p );
+    REQUIRE( re == p.real() );
+    REQUIRE( im == p.imag() );
+    auto joined = join_from_channels<image, double, cplanar_f_image>( re, im );
+    REQUIRE( joined == p );
+
+    _REQUIRE_THROWS_MATCHES(
+        cplanar_f_image( gf_image{ 4, 4 }, gf_image{ 4, 5 } ),
+        std::runtime_error,
+        ContainsSubstring( "matching dimensions" ) );
+}
+
+TEST_CASE("cplanar_image_test - expressions")
+{
+    const cf_image a{ make_complex( 33, 17, 0.1 ) };
+    const cf_image b{ make_complex( 33, 17, 0.7 ) };
+    const cplanar_f_image pa{ a };
+    const cplanar_f_image pb{ b };
+
+    const cf_image expected{ b * conj( a ) };
+
+    // planar only, mixed, and via the helper
+    cplanar_f_image product{ pb * conj( pa ) };
+    REQUIRE( product.interleaved() == expected );
+    REQUIRE( cplanar_f_image{ b * conj( pa ) }.interleaved() == expected );
+    REQUIRE( multiply_conjugate( pa, pb ).interleaved() == expected );
+    REQUIRE( multiply_conjugate( a, b ).interleaved() == expected );
+
+    // assigning to an interleaved image
+    cf_image interleaved;
+    interleaved = pb * conj( pa );
+    REQUIRE( interleaved == expected );
+
+    // in place
+    cplanar_f_image in_place{ pa };
+    in_place = pb * conj( in_place );
+    REQUIRE( in_place == product );
+
+    cplanar_f_image sqr{ abs_sqr( pa ) };
+    REQUIRE( sqr.interleaved() == cf_image{ abs_sqr( a ) } );
+}
+
+TEST_CASE("cplanar_image_test - FFT")
+{
+    const cf_image c{ make_complex( 64, 32, 0.3 ) };
+    const cplanar_f_image p{ c };
+    cplanar_f_image out;
+
+    SECTION("FFT")
+    {
+        FFT fft( c.size() );
+        fft.transform( p, out, direction::FORWARD );
+        REQUIRE( out.interleaved() == fft.transform( c, direction::FORWARD ) );
+
+        _REQUIRE_THROWS_MATCHES(
+            fft.transform( cplanar_f_image{ 32, 32 }, out ),
+            std::runtime_error,
+            ContainsSubstring( "size is different" ) );
+    }
+
+    SECTION("PocketFFT")
+    {
+        PocketFFT fft( c.size() );
+        fft.transform( p, out, direction::FORWARD );
+        REQUIRE( out.interleaved() == fft.transform( c, direction::FORWARD ) );
+
+        // round trip
+        cplanar_f_image back;
+        fft.transform( out, back, direction::REVERSE );
+        const double n = c.pixel_count();
+        for ( uint32_t y=0; y<c.height(); ++y )
+            for ( uint32_t x=0; x<c.width(); ++x )
+            {
+                const auto v = back[ {x, y} ];
+                const auto expected = c[ {x, y} ];
+                REQUIRE_THAT( v.real/n, WithinAbs( expected.real, 1e-12 ) );
+                REQUIRE_THAT( v.imag/n, WithinAbs( expected.imag, 1e-12 ) );
+            }
+    }
+}
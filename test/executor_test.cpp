@@ -0,0 +1,159 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// to be tested
+#include "core/executor.h"
+#include "core/grid.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+using namespace std::literals;
+
+TEST_CASE("executor_test - parallel_for visits each index once")
+{
+    for ( size_t thread_count : { 0, 1, 3 } )
+    {
+        work_stealing_executor executor( thread_count );
+        REQUIRE( executor.thread_count() == thread_count );
+
+        for ( size_t chunk_size : { 0, 1, 7, 1000 } )
+        {
+            std::vector<std::atomic<uint32_t>> visited( 1000 );
+            executor.parallel_for( 0, visited.size(), [&visited]( size_t i ){ ++visited[i]; }, chunk_size );
+
+            bool result = true;
+            for ( const auto& v : visited )
+                result &= (v == 1);
+            REQUIRE( result );
+        }
+    }
+}
+
+TEST_CASE("executor_test - parallel_for_chunks respects chunk size")
+{
+    work_stealing_executor executor( 2 );
+    std::atomic<size_t> total{ 0 };
+    std::atomic<bool> too_large{ false };
+
+    executor.parallel_for_chunks(
+        10, 110,
+        [&]( size_t b, size_t e ) {
+            too_large = too_large || (e - b) > 8;
+            total += e - b;
+        },
+        8 );
+
+    REQUIRE( !too_large );
+    REQUIRE( total == 100 );
+}
+
+TEST_CASE("executor_test - empty range")
+{
+    work_stealing_executor executor( 2 );
+    bool called = false;
+    executor.parallel_for( 5, 5, [&called]( size_t ){ called = true; } );
+    REQUIRE( !called );
+}
+
+TEST_CASE("executor_test - imbalanced work is stolen")
+{
+    // all expensive items are in the first chunk block; if no stealing
+    // occurred the first worker would process all of them
+    work_stealing_executor executor( 3 );
+    std::vector<std::thread::id> ids( 64 );
+    executor.parallel_for(
+        0, ids.size(),
+        [&ids]( size_t i ) {
+            if ( i < 16 )
+                std::this_thread::sleep_for( 5ms );
+            ids[i] = std::this_thread::get_id();
+        },
+        1 );
+
+    std::sort( std::begin(ids), std::end(ids) );
+    auto unique = std::distance( std::begin(ids), std::unique( std::begin(ids), std::end(ids) ) );
+    REQUIRE( unique > 1 );
+}
+
+TEST_CASE("executor_test - nested parallel_for")
+{
+    work_stealing_executor executor( 2 );
+    std::atomic<size_t> count{ 0 };
+    executor.parallel_for(
+        0, 8,
+        [&]( size_t ) {
+            executor.parallel_for( 0, 8, [&count]( size_t ){ ++count; }, 1 );
+        },
+        1 );
+
+    REQUIRE( count == 64 );
+}
+
+TEST_CASE("executor_test - exceptions are propagated")
+{
+    for ( size_t thread_count : { 0, 2 } )
+    {
+        work_stealing_executor executor( thread_count );
+        REQUIRE_THROWS_WITH(
+            executor.parallel_for(
+                0, 100,
+                []( size_t i ) { if ( i == 50 ) throw std::runtime_error( "failed" ); } ),
+            "failed" );
+
+        // executor is still usable
+        std::atomic<size_t> count{ 0 };
+        executor.parallel_for( 0, 100, [&count]( size_t ){ ++count; } );
+        REQUIRE( count == 100 );
+    }
+}
+
+TEST_CASE("executor_test - parallel_for over grid")
+{
+    auto grid = generate_cartesian_grid( {256, 256}, {32, 32}, 0.5 );
+    std::vector<rect> seen( grid.size() );
+
+    work_stealing_executor executor( 2 );
+    parallel_for( executor, grid, [&seen]( size_t i, const rect& r ){ seen[i] = r; } );
+
+    REQUIRE( seen == grid );
+}
+
+TEST_CASE("executor_test - grid_chunk_size")
+{
+    auto grid = generate_cartesian_grid( {1024, 1024}, {32, 32}, 0.5 );
+
+    // 256KiB / (2 * 32 * 32 * 8) = 16 windows per chunk
+    REQUIRE( grid_chunk_size( grid, 0 ) == 16 );
+
+    // limited by the need to balance across many threads
+    REQUIRE( grid_chunk_size( grid, 127 ) == grid.size()/512 );
+
+    REQUIRE( grid_chunk_size( {}, 4 ) == 1 );
+}
+
+TEST_CASE("executor_test - parallel_for over ordered grid")
+{
+    auto grid = generate_cartesian_grid( {256, 256}, {32, 32}, 0.5 );
+    auto order = grid_traversal_order( grid, grid_order::HILBERT );
+    std::vector<rect> seen( grid.size() );
+
+    work_stealing_executor executor( 2 );
+    parallel_for( executor, grid, order, [&seen]( size_t i, const rect& r ){ seen[i] = r; } );
+    REQUIRE( seen == grid );
+
+    order.pop_back();
+    REQUIRE_THROWS_AS(
+        parallel_for( executor, grid, order, []( size_t, const rect& ){} ),
+        std::runtime_error );
+}
@@ -0,0 +1,246 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "core/executor.h"
+#include "core/filters.h"
+#include "core/image.h"
+#include "core/image_utils.h"
+#include "core/image_view.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    gf_image make_noise( uint32_t w, uint32_t h )
+    {
+        gf_image result{ w, h };
+        fill( result, []( auto x, auto y ){ return g_f( ((x*7919 + y*104729) % 1000) / 10.0 ); } );
+        return result;
+    }
+
+    /// direct convolution with replicated edges
+    template < typename ImageT >
+    gf_image reference_convolve( const ImageT& in, const std::vector<double>& kx, const std::vector<double>& ky )
+    {
+        const int64_t w = in.width(), h = in.height();
+        const int64_t rx = kx.size()/2, ry = ky.size()/2;
+        gf_image result{ in.size() };
+        for ( int64_t y=0; y<h; ++y )
+            for ( int64_t x=0; x<w; ++x )
+            {
+                double sum = 0;
+                for ( int64_t j=0; j<static_cast<int64_t>( ky.size() ); ++j )
+                    for ( int64_t i=0; i<static_cast<int64_t>( kx.size() ); ++i )
+                    {
+                        const auto xx = static_cast<uint32_t>( std::clamp<int64_t>( x + i - rx, 0, w - 1 ) );
+                        const auto yy = static_cast<uint32_t>( std::clamp<int64_t>( y + j - ry, 0, h - 1 ) );
+                        sum += kx[i] * ky[j] * in[ {xx, yy} ].v;
+                    }
+                result[ {static_cast<uint32_t>( x ), static_cast<uint32_t>( y )} ] = sum;
+            }
+
+        return result;
+    }
+
+    /// direct running minimum or maximum over the clipped window
+    template < typename ImageT >
+    auto reference_running( const ImageT& in, uint32_t rx, uint32_t ry, bool is_max )
+    {
+        image<typename ImageT::pixel_t> result{ in.size() };
+        for ( uint32_t y=0; y<in.height(); ++y )
+            for ( uint32_t x=0; x<in.width(); ++x )
+            {
+                auto v = in[ {x, y} ];
+                for ( uint32_t yy=(y > ry ? y - ry : 0); yy<=std::min( y + ry, in.height() - 1 ); ++yy )
+                    for ( uint32_t xx=(x > rx ? x - rx : 0); xx<=std::min( x + rx, in.width() - 1 ); ++xx )
+                        v = is_max ? std::max( v, in[ {xx, yy} ] ) : std::min( v, in[ {xx, yy} ] );
+                result[ {x, y} ] = v;
+            }
+
+        return result;
+    }
+
+    template < typename T >
+    void check_close( const image<T>& a, const image<T>& b, double tolerance )
+    {
+        REQUIRE( a.size() == b.size() );
+        for ( uint32_t i=0; i<a.pixel_count(); ++i )
+            REQUIRE_THAT( static_cast<double>( a[i].v ), WithinAbs( b[i].v, tolerance ) );
+    }
+
+}
+
+TEST_CASE("filters_test - gaussian kernel")
+{
+    const auto k = gaussian_kernel( 1.5 );
+    REQUIRE( k.size() == 11 );
+    REQUIRE_THAT( std::accumulate( k.begin(), k.end(), 0.0 ), WithinAbs( 1.0, 1e-12 ) );
+    REQUIRE( k[4] == k[6] );
+    REQUIRE( k[5] > k[4] );
+    REQUIRE( gaussian_kernel( 2.0, 2 ).size() == 5 );
+
+    _REQUIRE_THROWS_MATCHES( gaussian_kernel( 0.0 ), std::invalid_argument, ContainsSubstring( "sigma" ) );
+}
+
+TEST_CASE("filters_test - convolution")
+{
+    const auto im = make_noise( 70, 45 );
+    const std::vector<double> kx{ 0.25, 0.5, 0.25 };
+    const auto ky = gaussian_kernel( 1.2 );
+
+    gf_image out;
+    convolve_separable( im, out, kx, ky );
+    check_close( out, reference_convolve( im, kx, ky ), 1e-9 );
+
+    // views, and in place
+    const auto view = create_image_view( im, { {5, 7}, {40, 30} } );
+    convolve_separable( view, out, kx, ky );
+    check_close( out, reference_convolve( view, kx, ky ), 1e-9 );
+
+    gf_image in_place{ im };
+    gaussian_blur( in_place, in_place, 1.2 );
+    check_close( in_place, reference_convolve( im, ky, ky ), 1e-9 );
+
+    // integral pixels are rounded and constant images preserved
+    g16_image flat{ 33, 17, 4000_g16 };
+    g16_image flat_out;
+    gaussian_blur( flat, flat_out, 2.0 );
+    for ( const auto& v : flat_out )
+        REQUIRE( v == 4000 );
+
+    _REQUIRE_THROWS_MATCHES(
+        convolve_separable( im, out, std::vector<double>{ 0.5, 0.5 }, ky ),
+        std::invalid_argument,
+        ContainsSubstring( "odd length" ) );
+}
+
+TEST_CASE("filters_test - running min and max")
+{
+    g16_image im{ 61, 37 };
+    fill( im, []( auto x, auto y ){ return g_16( (x*7919 + y*104729) % 4096 ); } );
+
+    for ( auto [rx, ry] : std::vector<std::pair<uint32_t, uint32_t>>{ {0, 0}, {1, 1}, {3, 2}, {5, 9}, {40, 1} } )
+    {
+        g16_image out;
+        min_filter( im, out, rx, ry );
+        REQUIRE( out == reference_running( im, rx, ry, false ) );
+        max_filter( im, out, rx, ry );
+        REQUIRE( out == reference_running( im, rx, ry, true ) );
+    }
+
+    // views, and in place
+    const auto view = create_image_view( im, { {10, 3}, {20, 30} } );
+    g16_image out;
+    max_filter( view, out, 2, 4 );
+    REQUIRE( out == reference_running( view, 2, 4, true ) );
+
+    gf_image imf{ im };
+    min_filter( imf, imf, 4, 4 );
+    REQUIRE( imf == gf_image{ reference_running( im, 4, 4, false ) } );
+}
+
+TEST_CASE("filters_test - parallel")
+{
+    const auto im = make_noise( 512, 384 );
+    work_stealing_executor executor( 4 );
+
+    const auto k = gaussian_kernel( 2.0 );
+    gf_image serial, parallel;
+    convolve_separable( im, serial, k, k );
+    convolve_separable( im, parallel, k, k, &executor );
+    REQUIRE( serial == parallel );
+
+    min_filter( im, serial, 6, 3 );
+    min_filter( im, parallel, 6, 3, &executor );
+    REQUIRE( serial == parallel );
+
+    normalise_local( im, serial, 5 );
+    normalise_local( im, parallel, 5, &executor );
+    REQUIRE( serial == parallel );
+}
+
+TEST_CASE("filters_test - background removal")
+{
+    // a particle on a sloping background
+    g16_image im{ 64, 64 };
+    fill( im, []( auto x, auto y ){ return g_16( 100 + x + y ); } );
+    im[ {30, 30} ] = 1000;
+
+    g16_image out;
+    subtract_background( im, out, 2 );
+    REQUIRE( out[ {30, 30} ] == 1000 - (100 + 28 + 28) );
+    REQUIRE( out[ {10, 10} ] == 4 );
+    REQUIRE( out[ {0, 0} ] == 0 );
+
+    // high pass: integral results are clipped at zero
+    gf_image flat{ 32, 32, 7.0_gf };
+    gf_image flat_out;
+    high_pass( flat, flat_out, 3.0 );
+    for ( const auto& v : flat_out )
+        REQUIRE_THAT( v.v, WithinAbs( 0.0, 1e-12 ) );
+
+    g16_image hp;
+    high_pass( im, hp, 1.0 );
+    REQUIRE( hp[ {30, 30} ] > 650 );
+    REQUIRE( hp[ {30, 30} ] < 750 );
+    REQUIRE( hp[ {31, 30} ] == 0 );
+
+    // local normalisation
+    gf_image norm;
+    normalise_local( gf_image{ im }, norm, 1 );
+    REQUIRE( norm[ {30, 30} ] == 1.0 );
+    REQUIRE( norm[ {10, 10} ] == 0.5 );
+    REQUIRE( norm[ {0, 0} ] == 0.0 );
+
+    g16_image norm16;
+    normalise_local( im, norm16, 1 );
+    REQUIRE( norm16[ {30, 30} ] == 65535 );
+
+    g16_image thresholded;
+    threshold( im, thresholded, 200_g16 );
+    REQUIRE( thresholded[ {30, 30} ] == 1000 );
+    REQUIRE( thresholded[ {50, 49} ] == 0 );
+    REQUIRE( thresholded[ {50, 50} ] == 200 );
+    REQUIRE( thresholded[ {0, 0} ] == 0 );
+    REQUIRE( thresholded[ {60, 60} ] == 220 );
+}
+
+TEST_CASE("filters_test - filter chain")
+{
+    g16_image im{ 64, 64 };
+    fill( im, []( auto x, auto y ){ return g_16( 100 + x + y ); } );
+    im[ {30, 30} ] = 1000;
+
+    filter_chain<g_16> chain;
+    REQUIRE( chain.empty() );
+    chain.subtract_background( 2 ).gaussian_blur( 0.7 ).threshold( 10_g16 );
+    REQUIRE( chain.size() == 3 );
+
+    g16_image expected;
+    subtract_background( im, expected, 2 );
+    gaussian_blur( expected, expected, 0.7 );
+    threshold( expected, expected, 10_g16 );
+
+    g16_image in_place{ im };
+    chain( in_place );
+    REQUIRE( in_place == expected );
+
+    work_stealing_executor executor( 2 );
+    REQUIRE( chain( g16_image{ im }, &executor ) == expected );
+
+    _REQUIRE_THROWS_MATCHES( chain.high_pass( -1 ), std::invalid_argument, ContainsSubstring( "sigma" ) );
+}
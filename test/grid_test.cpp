@@ -216,3 +216,91 @@ TEST_CASE("grid_test - cartesian grid")
     }
 
 }
+
+TEST_CASE("grid_test - traversal order")
+{
+    // 8x8 cells
+    auto grid = generate_cartesian_grid( {144, 144}, {32, 32}, 0.5 );
+    REQUIRE( grid.size() == 64 );
+
+    auto is_permutation = [&grid]( std::vector<size_t> order ) {
+        std::sort( std::begin(order), std::end(order) );
+        for ( size_t i=0; i<order.size(); ++i )
+            if ( order[i] != i )
+                return false;
+        return order.size() == grid.size();
+    };
+
+    // sum of steps between consecutive windows, in cells
+    auto path_length = [&grid]( const std::vector<size_t>& order ) {
+        int64_t length = 0;
+        for ( size_t i=1; i<order.size(); ++i )
+        {
+            const auto& a = grid[order[i-1]];
+            const auto& b = grid[order[i]];
+            length += (std::abs( a.left() - b.left() ) + std::abs( a.bottom() - b.bottom() ))/16;
+        }
+        return length;
+    };
+
+    SECTION("row major is identity")
+    {
+        auto order = grid_traversal_order( grid, grid_order::ROW_MAJOR );
+        for ( size_t i=0; i<order.size(); ++i )
+            CHECK( order[i] == i );
+    }
+
+    SECTION("morton")
+    {
+        auto order = grid_traversal_order( grid, grid_order::MORTON );
+        REQUIRE( is_permutation( order ) );
+
+        // first four windows form a 2x2 block
+        CHECK( grid[order[0]].bottomLeft() == grid[0].bottomLeft() );
+        CHECK( grid[order[1]].bottomLeft() == grid[1].bottomLeft() );
+        CHECK( grid[order[2]].bottomLeft() == grid[8].bottomLeft() );
+        CHECK( grid[order[3]].bottomLeft() == grid[9].bottomLeft() );
+    }
+
+    SECTION("hilbert")
+    {
+        auto order = grid_traversal_order( grid, grid_order::HILBERT );
+        REQUIRE( is_permutation( order ) );
+
+        // each step moves to an adjacent cell
+        CHECK( path_length( order ) == 63 );
+    }
+
+    SECTION("supertile")
+    {
+        auto order = grid_traversal_order( grid, grid_order::SUPERTILE, 4 );
+        REQUIRE( is_permutation( order ) );
+
+        // first sixteen windows are the bottom-left 4x4 cells
+        for ( size_t i=0; i<16; ++i )
+        {
+            CHECK( grid[order[i]].left() < grid[4].left() );
+            CHECK( grid[order[i]].bottom() < grid[32].bottom() );
+        }
+
+        REQUIRE_THROWS( grid_traversal_order( grid, grid_order::SUPERTILE, 0 ) );
+    }
+
+    SECTION("non-square grid")
+    {
+        auto rectangular = generate_cartesian_grid( {200, 72}, {32, 32}, 0.5 );
+        for ( auto o : { grid_order::MORTON, grid_order::HILBERT, grid_order::SUPERTILE } )
+        {
+            auto order = grid_traversal_order( rectangular, o );
+            std::sort( std::begin(order), std::end(order) );
+            for ( size_t i=0; i<order.size(); ++i )
+                CHECK( order[i] == i );
+        }
+    }
+
+    SECTION("names")
+    {
+        CHECK( to_string( grid_order::HILBERT ) == "hilbert" );
+        CHECK( from_string<grid_order>( "supertile" ) == grid_order::SUPERTILE );
+    }
+}
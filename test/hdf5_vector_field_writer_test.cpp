@@ -0,0 +1,137 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cstdio>
+#include <stdexcept>
+
+// to be tested
+#include "core/vector_field.h"
+#include "io/hdf5_vector_field_writer.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    vector_field_d make_frame( uint32_t nx, uint32_t ny, double t )
+    {
+        vector_field_d f( nx, ny );
+        for ( size_t i=0; i<f.size(); ++i )
+        {
+            f.x()[i] = 16 * (i % nx);
+            f.y()[i] = 16 * (i / nx);
+            f.u()[i] = t + 0.25 * i;
+            f.v()[i] = t - 0.5 * i;
+            f.quality()[i] = 1.5 * t;
+            f.flags()[i] = i % 2 ? vector_flag::INVALID : vector_flag::NONE;
+        }
+
+        return f;
+    }
+
+}
+
+TEST_CASE("hdf5_vector_field_writer_test - without HDF5")
+{
+    if ( has_hdf5() )
+        return;
+
+    REQUIRE_THROWS_AS( hdf5_vector_field_writer<double>( "unsupported.h5" ), std::runtime_error );
+}
+
+TEST_CASE("hdf5_vector_field_writer_test - time series round trip")
+{
+    if ( !has_hdf5() )
+        return;
+
+    const std::string path = "hdf5_vector_field_test.h5";
+    constexpr size_t frames = 10;
+
+    vector_field_parameters parameters;
+    parameters.window_size = { 32, 32 };
+    parameters.window_spacing = { 16, 16 };
+    parameters.dt = 0.002;
+    parameters.position_units = "mm";
+    parameters.velocity_units = "m/s";
+
+    {
+        hdf5_options options;
+        options.queue_depth = 2;
+        hdf5_vector_field_writer<double> writer( path, parameters, options );
+        for ( size_t t=0; t<frames; ++t )
+            writer.write( make_frame( 9, 7, t ) );
+
+        writer.close();
+        REQUIRE( writer.frames_written() == frames );
+    }
+
+    REQUIRE( hdf5_frame_count( path ) == frames );
+
+    vector_field_parameters read_parameters;
+    auto f = read_hdf5_vector_field<double>( path, 3, &read_parameters );
+    auto expected = make_frame( 9, 7, 3 );
+    REQUIRE( f.shape() == expected.shape() );
+    for ( size_t i=0; i<f.size(); ++i )
+    {
+        REQUIRE( f.x()[i] == expected.x()[i] );
+        REQUIRE( f.u()[i] == expected.u()[i] );
+        REQUIRE( f.v()[i] == expected.v()[i] );
+        REQUIRE( f.quality()[i] == expected.quality()[i] );
+        REQUIRE( f.flags()[i] == expected.flags()[i] );
+    }
+
+    REQUIRE( read_parameters.window_size == size{ 32, 32 } );
+    REQUIRE( read_parameters.window_spacing == size{ 16, 16 } );
+    REQUIRE( read_parameters.dt == 0.002 );
+    REQUIRE( read_parameters.position_units == "mm" );
+    REQUIRE( read_parameters.velocity_units == "m/s" );
+
+    // values are converted on read
+    auto f_float = read_hdf5_vector_field<float>( path, 9 );
+    REQUIRE( f_float.u()[4] == 10.0f );
+
+    REQUIRE_THROWS_AS( read_hdf5_vector_field<double>( path, frames ), std::out_of_range );
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("hdf5_vector_field_writer_test - uncompressed float")
+{
+    if ( !has_hdf5() )
+        return;
+
+    const std::string path = "hdf5_vector_field_float_test.h5";
+    {
+        hdf5_options options;
+        options.compression = 0;
+        hdf5_vector_field_writer<float> writer( path, {}, options );
+        vector_field_f f( 4, 4 );
+        f.u()[5] = 2.5f;
+        writer.write( f );
+    }
+
+    REQUIRE( hdf5_frame_count( path ) == 1 );
+    REQUIRE( read_hdf5_vector_field<float>( path, 0 ).u()[5] == 2.5f );
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("hdf5_vector_field_writer_test - shape mismatch is reported")
+{
+    if ( !has_hdf5() )
+        return;
+
+    const std::string path = "hdf5_vector_field_mismatch_test.h5";
+    hdf5_vector_field_writer<double> writer( path );
+    writer.write( make_frame( 4, 4, 0 ) );
+    writer.write( make_frame( 5, 4, 1 ) );
+
+    REQUIRE_THROWS_AS( writer.close(), std::runtime_error );
+    REQUIRE( writer.frames_written() == 1 );
+
+    std::remove( path.c_str() );
+}
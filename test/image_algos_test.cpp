@@ -11,6 +11,7 @@
 
 // to be tested
 #include "algos/fft.h"
+#include "algos/pocket_fft.h"
 #include "loaders/image_loader.h"
 #include "core/image_utils.h"
 
@@ -214,3 +215,113 @@ TEST_CASE("image_algos_test - fft_real_test")
     REQUIRE( save_to_file( "fft_corr_a_output.pgm", gf_image{ output }) );
 }
 
+
+TEST_CASE("image_algos_test - correlate from views")
+{
+    // correlating views must give the same result as correlating
+    // extracted copies of the same windows
+    gf_image im{ 200, 150 };
+    fill( im, []( uint32_t w, uint32_t h ){ return std::sin( 0.3*w ) * std::cos( 0.17*h ) + 0.01*((w*h) % 7); } );
+
+    const rect r_a{ {20, 30}, {64, 64} };
+    const rect r_b{ {23, 28}, {64, 64} };
+    const auto view_a = create_image_view( im, r_a );
+    const auto view_b = create_image_view( im, r_b );
+    const auto copy_a = extract( im, r_a );
+    const auto copy_b = extract( im, r_b );
+
+    auto check_equal = []( const gf_image& lhs, const gf_image& rhs ) {
+        REQUIRE( lhs.size() == rhs.size() );
+        for ( uint32_t i=0; i<lhs.pixel_count(); ++i )
+            REQUIRE_THAT( lhs[i].v, WithinAbs( rhs[i].v, 1e-9 ) );
+    };
+
+    SECTION("FFT")
+    {
+        FFT fft( r_a.size() );
+        check_equal( fft.cross_correlate( view_a, view_b ), fft.cross_correlate( copy_a, copy_b ) );
+        check_equal( fft.cross_correlate_real( view_a, view_b ), fft.cross_correlate_real( copy_a, copy_b ) );
+    }
+
+    SECTION("PocketFFT")
+    {
+        PocketFFT fft( r_a.size() );
+        check_equal( fft.cross_correlate( view_a, view_b ), fft.cross_correlate( copy_a, copy_b ) );
+        check_equal( fft.cross_correlate_real( view_a, view_b ), fft.cross_correlate_real( copy_a, copy_b ) );
+    }
+}
+
+TEST_CASE("image_algos_test - correlate pitched images")
+{
+    // images with aligned and padded rows must correlate exactly as
+    // packed images
+    gf_image packed_a{ 64, 64 };
+    gf_image packed_b{ 64, 64 };
+    fill( packed_a, []( uint32_t w, uint32_t h ){ return std::sin( 0.3*w ) * std::cos( 0.17*h ); } );
+    fill( packed_b, []( uint32_t w, uint32_t h ){ return std::sin( 0.3*(w + 2) ) * std::cos( 0.17*(h + 1) ); } );
+
+    const image_layout layout{ 64, 64, true };
+    gf_image a{ packed_a.size(), 0.0_gf, layout };
+    gf_image b{ packed_b.size(), 0.0_gf, layout };
+    std::copy( std::cbegin( packed_a ), std::cend( packed_a ), std::begin( a ) );
+    std::copy( std::cbegin( packed_b ), std::cend( packed_b ), std::begin( b ) );
+    REQUIRE( a.pitch() == 72 );
+
+    auto check_equal = []( const gf_image& lhs, const gf_image& rhs ) {
+        REQUIRE( lhs.size() == rhs.size() );
+        for ( uint32_t i=0; i<lhs.pixel_count(); ++i )
+            REQUIRE_THAT( lhs[i].v, WithinAbs( rhs[i].v, 1e-9 ) );
+    };
+
+    SECTION("FFT")
+    {
+        FFT fft( a.size() );
+        check_equal( fft.cross_correlate( a, b ), fft.cross_correlate( packed_a, packed_b ) );
+        check_equal( fft.cross_correlate_real( a, b ), fft.cross_correlate_real( packed_a, packed_b ) );
+    }
+
+    SECTION("PocketFFT")
+    {
+        PocketFFT fft( a.size() );
+        check_equal( fft.cross_correlate( a, b ), fft.cross_correlate( packed_a, packed_b ) );
+        check_equal( fft.cross_correlate_real( a, b ), fft.cross_correlate_real( packed_a, packed_b ) );
+    }
+}
+
+TEST_CASE("image_algos_test - correlate 16-bit views")
+{
+    // windows of 16-bit images are converted as they're loaded and
+    // must correlate exactly as the same windows of a double image
+    g16_image im{ 200, 150 };
+    fill( im, []( uint32_t w, uint32_t h ){ return g_16( 1000 + 900*std::sin( 0.3*w ) * std::cos( 0.17*h ) + (w*h) % 7 ); } );
+    const gf_image im_f{ im };
+
+    const rect r_a{ {20, 30}, {64, 64} };
+    const rect r_b{ {23, 28}, {64, 64} };
+    const auto view_a = create_image_view( im, r_a );
+    const auto view_b = create_image_view( im, r_b );
+    const auto view_f_a = create_image_view( im_f, r_a );
+    const auto view_f_b = create_image_view( im_f, r_b );
+
+    auto check_equal = []( const gf_image& lhs, const gf_image& rhs ) {
+        REQUIRE( lhs.size() == rhs.size() );
+        for ( uint32_t i=0; i<lhs.pixel_count(); ++i )
+            REQUIRE( lhs[i] == rhs[i] );
+    };
+
+    SECTION("FFT")
+    {
+        FFT fft( r_a.size() );
+        REQUIRE( std::is_same_v<decltype( fft.cross_correlate( view_a, view_b ) ), gf_image> );
+        check_equal( fft.cross_correlate( view_a, view_b ), fft.cross_correlate( view_f_a, view_f_b ) );
+        check_equal( fft.cross_correlate_real( view_a, view_b ), fft.cross_correlate_real( view_f_a, view_f_b ) );
+    }
+
+    SECTION("PocketFFT")
+    {
+        PocketFFT fft( r_a.size() );
+        REQUIRE( std::is_same_v<decltype( fft.cross_correlate_real( view_a, view_b ) ), gf_image> );
+        check_equal( fft.cross_correlate( view_a, view_b ), fft.cross_correlate( view_f_a, view_f_b ) );
+        check_equal( fft.cross_correlate_real( view_a, view_b ), fft.cross_correlate_real( view_f_a, view_f_b ) );
+    }
+}
@@ -1,6 +1,7 @@
 
 // catch
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
 
 // std
 #include <sstream>
@@ -11,6 +12,8 @@
 #include "test_utils.h"
 
 // to be tested
+#include "core/executor.h"
+#include "core/image_evaluate.h"
 #include "core/image_expression.h"
 #include "core/image.h"
 #include "core/image_utils.h"
@@ -102,6 +105,107 @@ TEST_CASE("image_expression_test - write_to_self_test")
         REQUIRE( (im[i] == c_f{ 5, 0 }) );
 }
 
+TEST_CASE("image_expression_test - image_view_expression_test")
+{
+    gf_image im{ 64, 48 };
+    fill( im, []( auto x, auto y ){ return g_f( x + 100*y ); } );
+
+    // views aren't contiguous so are evaluated row by row
+    auto view = create_image_view( im, { {10, 5}, {20, 30} } );
+    gf_image result{ view + view*2.0_gf };
+
+    REQUIRE( result.size() == view.size() );
+    for ( uint32_t y=0; y<result.height(); ++y )
+        for ( uint32_t x=0; x<result.width(); ++x )
+            REQUIRE( (result[ {x, y} ] == g_f( 3*((x + 10) + 100*(y + 5)) )) );
+}
+
+TEST_CASE("image_expression_test - parallel_evaluate_test")
+{
+    gf_image a{ 300, 200 };
+    fill( a, []( auto x, auto y ){ return g_f( x + 1000*y ); } );
+    gf_image b{ 300, 200, 2.0_gf };
+    const gf_image expected{ a*b - 1.0_gf };
+
+    work_stealing_executor executor( 3 );
+
+    // small chunks so that every thread has work
+    gf_image result;
+    evaluate( result, a*b - 1.0_gf, executor, 1000 );
+    REQUIRE( result == expected );
+
+    // in place, and with an aligned, pitched destination
+    gf_image in_place{ {300, 200}, 0.0_gf, image_layout::aligned() };
+    in_place = a;
+    evaluate( in_place, in_place*b - 1.0_gf, executor, 1000 );
+    REQUIRE( in_place == expected );
+
+    // into a view
+    gf_image big{ 400, 300, 7.0_gf };
+    auto view = create_image_view( big, { {50, 50}, {300, 200} } );
+    evaluate( view, a*b - 1.0_gf, executor, 1000 );
+    gf_image from_view{ expected.size() };
+    from_view = view;
+    REQUIRE( from_view == expected );
+    REQUIRE( big[ {49, 50} ] == 7.0_gf );
+    REQUIRE( big[ {350, 249} ] == 7.0_gf );
+
+    auto small = create_image_view( big, { {0, 0}, {10, 10} } );
+    REQUIRE_THROWS_AS( evaluate( small, a*b, executor ), std::runtime_error );
+}
+
+TEST_CASE("image_expression_test - compound_assignment_test")
+{
+    gf_image a{ 40, 30 };
+    fill( a, []( auto x, auto y ){ return g_f( x + 100*y ); } );
+    gf_image b{ 40, 30, 2.0_gf };
+
+    gf_image im{ a };
+    im += b;
+    REQUIRE( im == gf_image{ a + b } );
+    im -= 1.0_gf;
+    REQUIRE( im == gf_image{ a + b - 1.0_gf } );
+    im *= 2.0;
+    im /= b;
+    REQUIRE( im == gf_image{ (a + b - 1.0_gf)*2.0_gf/b } );
+
+    // expressions, including ones reading the destination pixel
+    im = a;
+    im += im*b - a;
+    REQUIRE( im == gf_image{ a*3.0_gf - a } );
+
+    // into a view, leaving the rest of the image alone
+    gf_image big{ 60, 50, 1.0_gf };
+    auto view = create_image_view( big, { {10, 10}, {40, 30} } );
+    view += a;
+    REQUIRE( big[ {9, 10} ] == 1.0_gf );
+    REQUIRE( big[ {10, 10} ] == 1.0_gf + a[ {0, 0} ] );
+    REQUIRE( big[ {49, 39} ] == 1.0_gf + a[ {39, 29} ] );
+    REQUIRE( big[ {50, 39} ] == 1.0_gf );
+
+    // an overlapping view at another position is read before update
+    gf_image shifted{ a };
+    auto left = create_image_view( shifted, { {0, 0}, {39, 30} } );
+    auto right = create_image_view( shifted, { {1, 0}, {39, 30} } );
+    right += left;
+    for ( uint32_t y=0; y<30; ++y )
+        for ( uint32_t x=1; x<40; ++x )
+            REQUIRE( (shifted[ {x, y} ] == a[ {x, y} ] + a[ {x - 1, y} ]) );
+
+    _REQUIRE_THROWS_MATCHES(
+        im += gf_image( 10, 10 ),
+        std::runtime_error,
+        Catch::Matchers::ContainsSubstring( "sizes don't match" ) );
+
+    // split across threads
+    work_stealing_executor executor( 3 );
+    gf_image sum{ 40, 30 };
+    for ( int i=0; i<3; ++i )
+        evaluate_in_place<plus_op>( sum, a, executor, 100 );
+    evaluate_in_place<minus_op>( sum, a*2.0_gf, executor, 100 );
+    REQUIRE( sum == a );
+}
+
 TEST_CASE("image_expression_test - add_image_test")
 {
     g8_image im1; g_8 v1;
@@ -70,6 +70,23 @@ TEST_CASE("image_loader_test - pnm_loader_load_p5")
 
     REQUIRE(im.width() == 300);
     REQUIRE(im.height() == 200);
+
+    // rows are decoded into the layout of the destination
+    SECTION("aligned rows")
+    {
+        ss.seekg( 0 );
+        gf_image aligned{ {1, 1}, 0.0_gf, image_layout::aligned() };
+        loader->load( ss, aligned );
+
+        REQUIRE(aligned.size() == im.size());
+        REQUIRE(aligned.pitch() == 304);
+        for ( uint32_t h=0; h<aligned.height(); ++h )
+        {
+            REQUIRE( reinterpret_cast<uintptr_t>( aligned.line(h) ) % 64 == 0 );
+            for ( uint32_t w=0; w<aligned.width(); ++w )
+                REQUIRE( aligned[ {w, h} ] == im[ {w, h} ] );
+        }
+    }
 }
 
 
@@ -0,0 +1,132 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "core/image.h"
+#include "core/image_pyramid.h"
+#include "core/image_utils.h"
+#include "core/image_view.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+TEST_CASE("image_pyramid_test - box downsample")
+{
+    g8_image im{ 5, 4 };
+    fill( im, []( auto x, auto y ){ return g_8( 10*y + x ); } );
+
+    // odd trailing column is dropped; 2x2 means rounded to nearest
+    const auto down = downsample( im, pyramid_filter::BOX );
+    REQUIRE( down.size() == size{ 2, 2 } );
+    REQUIRE( down[ {0, 0} ] == 6 );    // (0 + 1 + 10 + 11)/4 = 5.5
+    REQUIRE( down[ {1, 0} ] == 8 );    // (2 + 3 + 12 + 13)/4 = 7.5
+    REQUIRE( down[ {0, 1} ] == 26 );
+    REQUIRE( down[ {1, 1} ] == 28 );
+
+    gf_image imf{ im };
+    const auto downf = downsample( imf, pyramid_filter::BOX );
+    REQUIRE( downf[ {0, 0} ] == 5.5 );
+    REQUIRE( downf[ {1, 1} ] == 27.5 );
+
+    // views
+    const auto view = create_image_view( im, { {1, 2}, {4, 2} } );
+    const auto down_view = downsample( view, pyramid_filter::BOX );
+    REQUIRE( down_view.size() == size{ 2, 1 } );
+    REQUIRE( down_view[ {0, 0} ] == 27 );  // (21 + 22 + 31 + 32)/4 = 26.5
+    REQUIRE( down_view[ {1, 0} ] == 29 );
+}
+
+TEST_CASE("image_pyramid_test - gaussian downsample")
+{
+    // constant and linear images are preserved, including at the
+    // replicated edges for constants
+    g16_image flat{ 64, 32, 1234_g16 };
+    const auto down = downsample( flat );
+    REQUIRE( down.size() == size{ 32, 16 } );
+    for ( const auto& v : down )
+        REQUIRE( v == 1234 );
+
+    gf_image ramp{ 64, 32 };
+    fill( ramp, []( auto x, auto y ){ return g_f( 3.0*x - 2.0*y ); } );
+    const auto down_ramp = downsample( ramp );
+    for ( uint32_t y=1; y<15; ++y )
+        for ( uint32_t x=1; x<31; ++x )
+            REQUIRE( down_ramp[ {x, y} ] == 3.0*2*x - 2.0*2*y );
+
+    // integer filtering is exact: it matches filtering in double and
+    // rounding
+    g16_image noise{ 40, 24 };
+    fill( noise, []( auto x, auto y ){ return g_16( (x*7919 + y*104729) % 65536 ); } );
+    const auto down_noise = downsample( noise );
+    const auto down_noise_f = downsample( gf_image{ noise } );
+    for ( uint32_t i=0; i<down_noise.pixel_count(); ++i )
+        REQUIRE( down_noise[i] == static_cast<uint16_t>( std::floor( down_noise_f[i].v + 0.5 ) ) );
+}
+
+TEST_CASE("image_pyramid_test - pyramid")
+{
+    gf_image im{ 256, 128 };
+    fill( im, []( auto x, auto y ){ return g_f( std::sin( 0.05*x ) * std::cos( 0.07*y ) ); } );
+
+    REQUIRE( image_pyramid<g_f>::max_levels( im.size() ) == 8 );
+    image_pyramid<g_f> pyramid( im, 4 );
+    REQUIRE( pyramid.levels() == 4 );
+    REQUIRE( to_string( pyramid.filter() ) == "gaussian" );
+
+    // a level 3 pixel covers 8x8 level 0 pixels
+    REQUIRE( image_pyramid<g_f>::scale( 3 ) == 8 );
+    REQUIRE( pyramid.level( 0 ).width() == image_pyramid<g_f>::scale( 3 ) * pyramid.level( 3 ).width() );
+    REQUIRE( &pyramid.level( 0 ) == &im );
+
+    // each level is the downsampled previous level
+    const auto level2 = downsample( downsample( im ) );
+    REQUIRE( pyramid.level( 2 ) == level2 );
+    REQUIRE( pyramid[ 3 ] == downsample( level2 ) );
+    REQUIRE( pyramid.level( 3 ).size() == size{ 32, 16 } );
+
+    // views are in the coordinates of the level
+    const auto view = pyramid.view( 2, { {8, 4}, {16, 16} } );
+    REQUIRE( view[ {0, 0} ] == level2[ {8, 4} ] );
+
+    // reset reuses the storage of each level
+    const auto* data = pyramid.level( 3 ).data();
+    gf_image next{ im.size(), 2.0_gf };
+    pyramid.reset( next );
+    REQUIRE( pyramid.level( 3 ).data() == data );
+    REQUIRE( pyramid.level( 3 )[ {5, 5} ] == 2.0 );
+
+    _REQUIRE_THROWS_MATCHES( pyramid.level( 4 ), std::out_of_range, ContainsSubstring( "level 4 of 4" ) );
+    _REQUIRE_THROWS_MATCHES(
+        image_pyramid<g_f>( im, 9 ),
+        std::invalid_argument,
+        ContainsSubstring( "at most 8 levels" ) );
+}
+
+TEST_CASE("image_pyramid_test - concurrent access")
+{
+    g16_image im{ 512, 512 };
+    fill( im, []( auto x, auto y ){ return g_16( (x*x + y) % 4096 ); } );
+    const auto expected = downsample( downsample( downsample( im ) ) );
+
+    image_pyramid<g_16> pyramid( im, 5 );
+    std::vector<std::thread> threads;
+    std::vector<bool> ok( 4, false );
+    for ( size_t t=0; t<ok.size(); ++t )
+        threads.emplace_back( [&, t]() { ok[t] = pyramid.level( 3 ) == expected; } );
+    for ( auto& t : threads )
+        t.join();
+
+    for ( const bool b : ok )
+        REQUIRE( b );
+}
@@ -0,0 +1,113 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cmath>
+#include <string>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "core/image.h"
+#include "core/image_reduce.h"
+#include "core/image_utils.h"
+#include "core/image_view.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+TEST_CASE("image_reduce_test - sum and mean")
+{
+    g8_image im{ 200, 100, 3_g8 };
+    REQUIRE( sum( im ) == 200*100*3 );
+    REQUIRE( std::is_same_v<decltype( sum( im ) ), int64_t> );
+    REQUIRE( mean( im ) == 3.0 );
+
+    gf_image a{ 64, 32 };
+    fill( a, []( auto x, auto y ){ return g_f( x + 64*y ); } );
+    const double n = a.pixel_count();
+    REQUIRE( sum( a ) == n*(n - 1)/2 );
+    REQUIRE( mean( a ) == (n - 1)/2 );
+
+    // expressions are reduced without materialising them
+    gf_image b{ 64, 32, 1.0_gf };
+    REQUIRE( sum( (a - b)*(a - b) ) == sum( gf_image{ (a - b)*(a - b) } ) );
+
+    // views only include the viewed pixels
+    auto view = create_image_view( a, { {1, 2}, {3, 4} } );
+    double expected = 0;
+    for ( uint32_t y=2; y<6; ++y )
+        for ( uint32_t x=1; x<4; ++x )
+            expected += x + 64*y;
+    REQUIRE( sum( view ) == expected );
+    REQUIRE( mean( view ) == expected/12 );
+
+    _REQUIRE_THROWS_MATCHES( mean( gf_image{} ), std::runtime_error, ContainsSubstring( "empty" ) );
+}
+
+TEST_CASE("image_reduce_test - variance")
+{
+    gf_image im{ 10, 10, 5.0_gf };
+    REQUIRE( variance( im ) == 0.0 );
+
+    // alternating large values with a small spread
+    fill( im, []( auto x, auto ){ return g_f( 1e9 + (x % 2 ? 1 : -1) ); } );
+    REQUIRE_THAT( variance( im ), WithinAbs( 1.0, 1e-9 ) );
+    REQUIRE_THAT( variance( im - 1e9_gf ), WithinAbs( 1.0, 1e-12 ) );
+
+    g16_image ramp{ 5, 1 };
+    fill( ramp, []( auto x, auto ){ return g_16( x ); } );
+    REQUIRE( variance( ramp ) == 2.0 );
+}
+
+TEST_CASE("image_reduce_test - dot")
+{
+    gf_image a{ 30, 20 };
+    fill( a, []( auto x, auto y ){ return g_f( x - y ); } );
+    gf_image b{ 30, 20, 2.0_gf };
+
+    REQUIRE( dot( a, b ) == 2*sum( a ) );
+    REQUIRE( dot( a, a ) == sum( a*a ) );
+    REQUIRE( dot( a - b, b ) == 2*sum( a ) - 4*a.pixel_count() );
+
+    g8_image c{ 100, 100, 200_g8 };
+    REQUIRE( dot( c, c ) == int64_t{ 200*200 }*100*100 );
+
+    _REQUIRE_THROWS_MATCHES(
+        dot( a, gf_image{ 20, 30 } ),
+        std::runtime_error,
+        ContainsSubstring( "sizes don't match" ) );
+}
+
+TEST_CASE("image_reduce_test - minmax and argmax")
+{
+    g16_image im{ 50, 40, 100_g16 };
+    im[ {10, 30} ] = 7;
+    im[ {20, 5} ] = 900;
+    im[ {30, 35} ] = 900;
+
+    auto [min, max] = minmax( im );
+    REQUIRE( min == 7 );
+    REQUIRE( max == 900 );
+
+    // first occurrence in row-major order
+    REQUIRE( argmax( im ) == point2<uint32_t>{ 20, 5 } );
+
+    // local coordinates of a view
+    auto view = create_image_view( im, { {25, 30}, {10, 10} } );
+    REQUIRE( argmax( view ) == point2<uint32_t>{ 5, 5 } );
+
+    // of an expression
+    gf_image a{ 8, 8 };
+    fill( a, []( auto x, auto y ){ return g_f( (x - 3.0)*(x - 3.0) + (y - 6.0)*(y - 6.0) ); } );
+    REQUIRE( argmax( gf_image{ 8, 8, 100.0_gf } - a ) == point2<uint32_t>{ 3, 6 } );
+    auto [emin, emax] = minmax( gf_image{ 8, 8, 100.0_gf } - a );
+    REQUIRE( emax == 100.0 );
+    REQUIRE( emin == 100.0 - (16.0 + 36.0) );
+
+    _REQUIRE_THROWS_MATCHES( argmax( g8_image{} ), std::runtime_error, ContainsSubstring( "empty" ) );
+}
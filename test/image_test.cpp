@@ -10,6 +10,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <utility>
 
 // local
 #include "test_utils.h"
@@ -121,6 +122,11 @@ TEST_CASE("image_test - line_out_of_bounds_test")
     _REQUIRE_THROWS_MATCHES( im.line(101),
                              std::range_error,
                              ContainsSubstring( "line out of range"s, CaseSensitive::No ) );
+
+    // one past the last line
+    REQUIRE_NOTHROW( im.line(99) );
+    REQUIRE_THROWS_AS( im.line(100), std::range_error );
+    REQUIRE_THROWS_AS( std::as_const( im ).line(100), std::range_error );
 }
 
 TEST_CASE("image_test - line_test")
@@ -235,3 +241,152 @@ TEST_CASE("image_test - iterator_test")
         REQUIRE( *im.line(h) == h*100 );
 }
 
+
+TEST_CASE("image_test - layout_test")
+{
+    // packed rows
+    REQUIRE( image_layout::packed().pitch( 100, 2 ) == 100 );
+
+    // rows rounded up to 64 bytes, with padding
+    REQUIRE( image_layout::aligned().pitch( 100, 2 ) == 128 );
+    REQUIRE( image_layout::aligned().pitch( 64, 8 ) == 64 );
+    REQUIRE( (image_layout{ 64, 64, false }).pitch( 100, 2 ) == 160 );
+
+    // a pitch of a multiple of 4KiB is extended by a cache line
+    REQUIRE( image_layout::aligned().pitch( 512, 8 ) == 520 );
+    REQUIRE( (image_layout{ 64, 0, false }).pitch( 512, 8 ) == 512 );
+
+    REQUIRE_THROWS_AS( (image_layout{ 48, 0, false }).pitch( 10, 1 ), std::invalid_argument );
+    REQUIRE_THROWS_AS( (image_layout{ 128, 0, false }).pitch( 10, 1 ), std::invalid_argument );
+    REQUIRE_THROWS_AS( (image_layout{ 0, 3, false }).pitch( 10, 2 ), std::invalid_argument );
+}
+
+TEST_CASE("image_test - pitched_image_test")
+{
+    g16_image packed{ 100, 30 };
+    std::iota( std::begin( packed ), std::end( packed ), 0 );
+
+    g16_image pitched{ packed.size(), 0_g16, image_layout::aligned() };
+    REQUIRE( pitched.pitch() == 128 );
+    REQUIRE( std::get<1>( pitched.stride() ) == 128*sizeof(g_16) );
+
+    // each row starts on a 64-byte boundary
+    for ( uint32_t h=0; h<pitched.height(); ++h )
+        REQUIRE( reinterpret_cast<uintptr_t>( pitched.line(h) ) % 64 == 0 );
+
+    // iteration skips row padding
+    REQUIRE( std::distance( pitched.begin(), pitched.end() ) == (std::ptrdiff_t)pitched.pixel_count() );
+    std::copy( std::cbegin( packed ), std::cend( packed ), std::begin( pitched ) );
+    REQUIRE( pitched == packed );
+    REQUIRE( pitched[ {7, 3} ] == 307 );
+    REQUIRE( pitched[ 307 ] == 307 );
+    REQUIRE( pitched.line( 3 )[7] == 307 );
+    REQUIRE( *std::prev( std::end( pitched ) ) == 2999 );
+    REQUIRE( *std::rbegin( pitched ) == 2999 );
+
+    size_t count = 0;
+    for ( auto it = std::rbegin( pitched ); it != std::rend( pitched ); ++it )
+        count += (*it == 2999 - count);
+    REQUIRE( count == pitched.pixel_count() );
+
+    // copy, conversion and expressions preserve the pixels and the layout
+    g16_image copy{ pitched };
+    REQUIRE( copy.layout() == image_layout::aligned() );
+    REQUIRE( copy == packed );
+
+    // row padding isn't compared
+    gf_image zeros{ packed.size(), 0.0_gf, image_layout::aligned() };
+    gf_image fives{ packed.size(), 5.0_gf, image_layout::aligned() };
+    std::fill( std::begin( zeros ), std::end( zeros ), 1.0_gf );
+    std::fill( std::begin( fives ), std::end( fives ), 1.0_gf );
+    REQUIRE( zeros.pitch() != zeros.width() );
+    REQUIRE( zeros == fives );
+
+    gf_image converted{ packed.size(), 0.0_gf, image_layout::aligned() };
+    converted = pitched;
+    REQUIRE( converted.pitch() == 104 );
+    REQUIRE( converted[ {99, 29} ] == 2999 );
+
+    g16_image sum{ packed.size(), 0_g16, image_layout::aligned() };
+    sum = pitched + pitched;
+    REQUIRE( sum.pitch() == 128 );
+    REQUIRE( sum[ {99, 29} ] == 2*2999 );
+
+    // views see through the padding
+    auto view = create_image_view( pitched, rect{ {10, 5}, {20, 4} } );
+    REQUIRE( view[ {0, 0} ] == 510 );
+    REQUIRE( view.line( 1 )[2] == 612 );
+    REQUIRE( view.stride() == pitched.stride() );
+
+    // changing the layout is destructive but keeps the size
+    pitched.set_layout( image_layout::packed() );
+    REQUIRE( pitched.pitch() == 100 );
+    REQUIRE( pitched.size() == packed.size() );
+}
+
+TEST_CASE("image_test - shared_image_test")
+{
+    g16_image im{ 100, 30 };
+    std::iota( std::begin( im ), std::end( im ), 0 );
+    const g16_image expected{ im };
+
+    // sharing moves the pixels, it doesn't copy them
+    const g_16* pixels = std::as_const( im ).data();
+    REQUIRE( !im.is_shared() );
+    im.share();
+    REQUIRE( im.is_shared() );
+    REQUIRE( std::as_const( im ).data() == pixels );
+    REQUIRE( im == expected );
+
+    // copies share the buffer
+    g16_image copy{ im };
+    g16_image assigned;
+    assigned = copy;
+    auto extracted = extract( im, im.rect() );
+    REQUIRE( copy.is_shared() );
+    REQUIRE( std::as_const( copy ).data() == pixels );
+    REQUIRE( std::as_const( assigned ).data() == pixels );
+    REQUIRE( std::as_const( extracted ).data() == pixels );
+    REQUIRE( assigned == expected );
+
+    // const access, including through a view, leaves the buffer shared
+    const auto& const_copy = copy;
+    const auto view = create_image_view( const_copy, rect{ {10, 5}, {20, 4} } );
+    REQUIRE( view[ {0, 0} ] == 510 );
+    REQUIRE( const_copy[ {7, 3} ] == 307 );
+    REQUIRE( *std::cbegin( const_copy ) == 0 );
+    REQUIRE( copy.is_shared() );
+
+    // writing detaches the written image only
+    copy[ {7, 3} ] = 1;
+    REQUIRE( !copy.is_shared() );
+    REQUIRE( std::as_const( copy ).data() != pixels );
+    REQUIRE( copy[ {7, 3} ] == 1 );
+    REQUIRE( copy[ {8, 3} ] == 308 );
+    REQUIRE( im[ {7, 3} ] == 307 );
+    REQUIRE( assigned[ {7, 3} ] == 307 );
+
+    // the last image using the buffer takes it over without copying
+    im.detach();
+    REQUIRE( !im.is_shared() );
+    REQUIRE( std::as_const( im ).data() != pixels );
+    REQUIRE( im == expected );
+    assigned = g16_image{};
+    g16_image last{ extracted };
+    REQUIRE( last.is_shared() );
+    extracted = g16_image{};
+    last.detach();
+    REQUIRE( !last.is_shared() );
+    REQUIRE( std::as_const( last ).data() == pixels );
+    REQUIRE( last == expected );
+
+    // moves and resizing
+    last.share();
+    g16_image moved{ std::move( last ) };
+    REQUIRE( moved.is_shared() );
+    REQUIRE( std::as_const( moved ).data() == pixels );
+    moved.resize( 10, 10 );
+    REQUIRE( !moved.is_shared() );
+    moved[ {0, 0} ] = 5;
+    REQUIRE( moved[ {0, 0} ] == 5 );
+}
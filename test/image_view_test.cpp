@@ -7,6 +7,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <vector>
 
 // local
 #include "test_utils.h"
@@ -287,3 +288,47 @@ TEST_CASE("image_view_test - fill_test")
     REQUIRE( save_to_file( "view_fill_test.pgm", im ) );
 }
 
+
+TEST_CASE("image_view_test - rows_test")
+{
+    g16_image im{ 200, 200 };
+    fill( im, []( auto x, auto y ){ return g_16( x + y ); } );
+
+    auto view = create_image_view( im, { {50, 40}, {30, 20} } );
+    const auto rows = view.rows();
+    REQUIRE( rows.size() == view.height() );
+
+    uint32_t y = 0;
+    for ( const auto row : rows )
+    {
+        REQUIRE( row.size() == view.width() );
+        REQUIRE( row.data() == view.line( y ) );
+        REQUIRE( rows[y].data() == row.data() );
+        REQUIRE( row[0] == g_16( 50 + 40 + y ) );
+        ++y;
+    }
+    REQUIRE( y == view.height() );
+
+    // iterators visit the same pixels in the same order
+    std::vector<g_16> from_rows;
+    for ( const auto row : rows )
+        from_rows.insert( std::end(from_rows), std::begin(row), std::end(row) );
+    std::vector<g_16> from_iterators( std::cbegin(view), std::cend(view) );
+    REQUIRE( from_rows == from_iterators );
+    REQUIRE( from_rows.size() == view.pixel_count() );
+    REQUIRE( from_rows[ 5*view.width() + 7 ] == view[ {7, 5} ] );
+
+    // algorithms only touch the viewed pixels
+    fill( view, 1_g16 );
+    REQUIRE( pixel_sum( view ) == view.pixel_count() );
+    auto [min, max] = find_image_range( view );
+    REQUIRE( min == 1 );
+    REQUIRE( max == 1 );
+    REQUIRE( im[ {49, 40} ] == g_16( 49 + 40 ) );
+    REQUIRE( im[ {80, 40} ] == g_16( 80 + 40 ) );
+
+    // an empty view has no rows
+    g16_image_view empty;
+    REQUIRE( empty.rows().empty() );
+    REQUIRE( empty.begin() == empty.end() );
+}
@@ -0,0 +1,108 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "core/image.h"
+#include "core/image_utils.h"
+#include "core/image_view.h"
+#include "core/integral_image.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    /// sum and sum of squares of \a r visited pixel by pixel
+    template < typename ImageT >
+    std::pair<double, double> reference_sums( const ImageT& im, const rect& r )
+    {
+        double s = 0, ss = 0;
+        for ( int32_t y=r.bottom(); y<r.top(); ++y )
+            for ( int32_t x=r.left(); x<r.right(); ++x )
+            {
+                const double v = im[ {static_cast<uint32_t>( x ), static_cast<uint32_t>( y )} ].v;
+                s += v;
+                ss += v*v;
+            }
+
+        return { s, ss };
+    }
+
+}
+
+TEST_CASE("integral_image_test - window statistics")
+{
+    g16_image im{ 50, 31 };
+    fill( im, []( auto x, auto y ){ return g_16( (x*7919 + y*104729) % 65536 ); } );
+
+    const integral_image<g_16> integral{ im };
+    static_assert( std::is_same_v<integral_image<g_16>::value_t, int64_t> );
+    REQUIRE( integral.size() == im.size() );
+
+    for ( const auto& r : std::vector<rect>{ { {0, 0}, {50, 31} },
+                                             { {0, 0}, {1, 1} },
+                                             { {7, 3}, {16, 16} },
+                                             { {49, 30}, {1, 1} },
+                                             { {34, 15}, {16, 16} } } )
+    {
+        const auto [s, ss] = reference_sums( im, r );
+        REQUIRE( integral.sum( r ) == s );
+        REQUIRE( integral.sum_sqr( r ) == ss );
+
+        const double n = r.area();
+        REQUIRE_THAT( integral.mean( r ), WithinRel( s/n, 1e-12 ) );
+        REQUIRE_THAT( integral.variance( r ), WithinAbs( ss/n - (s/n)*(s/n), 1e-3 ) );
+        REQUIRE_THAT( integral.stddev( r ), WithinAbs( std::sqrt( integral.variance( r ) ), 1e-12 ) );
+    }
+
+    // empty rects
+    REQUIRE( integral.sum( { {3, 3}, {0, 5} } ) == 0 );
+    REQUIRE( integral.mean( { {3, 3}, {0, 5} } ) == 0.0 );
+    REQUIRE( integral.variance( { {3, 3}, {0, 0} } ) == 0.0 );
+
+    // a flat window has no variance
+    const integral_image<g_16> flat{ g16_image{ 8, 8, 300_g16 } };
+    REQUIRE( flat.mean( { {2, 2}, {4, 4} } ) == 300.0 );
+    REQUIRE( flat.variance( { {2, 2}, {4, 4} } ) == 0.0 );
+}
+
+TEST_CASE("integral_image_test - views and reset")
+{
+    gf_image im{ 40, 40 };
+    fill( im, []( auto x, auto y ){ return g_f( std::sin( 0.3*x ) + 0.1*y ); } );
+
+    // the tables of a view are in the view's coordinates
+    const auto view = create_image_view( im, { {10, 5}, {20, 30} } );
+    integral_image<g_f> integral{ view };
+    REQUIRE( integral.size() == size{ 20, 30 } );
+    static_assert( std::is_same_v<integral_image<g_f>::value_t, double> );
+
+    const rect r{ {2, 4}, {8, 8} };
+    const auto [s, ss] = reference_sums( im, rect{ {12, 9}, {8, 8} } );
+    REQUIRE_THAT( integral.sum( r ), WithinAbs( s, 1e-9 ) );
+    REQUIRE_THAT( integral.sum_sqr( r ), WithinAbs( ss, 1e-9 ) );
+
+    // reset to the whole image
+    integral.reset( im );
+    REQUIRE( integral.size() == im.size() );
+    REQUIRE_THAT( integral.sum( rect{ {12, 9}, {8, 8} } ), WithinAbs( s, 1e-9 ) );
+    REQUIRE( integral.contains( { {32, 32}, {8, 8} } ) );
+    REQUIRE( !integral.contains( { {33, 32}, {8, 8} } ) );
+    REQUIRE( !integral.contains( { {-1, 0}, {8, 8} } ) );
+
+    _REQUIRE_THROWS_MATCHES(
+        integral.sum( { {33, 32}, {8, 8} } ),
+        std::out_of_range,
+        ContainsSubstring( "is not within" ) );
+}
@@ -0,0 +1,130 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "core/image.h"
+#include "core/image_reduce.h"
+#include "core/image_view.h"
+#include "core/mapped_image.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    /// write a 16 byte header followed by \a frames frames of \a w x
+    /// \a h 16-bit pixels, rows \a pitch pixels apart; pixel (x, y)
+    /// of frame f has value 1000*f + 10*y + x
+    void write_stack( const std::string& path, uint32_t w, uint32_t h, uint32_t pitch, uint32_t frames )
+    {
+        std::vector<uint16_t> data( 8 + frames*h*pitch, 0xffff );
+        for ( uint32_t f=0; f<frames; ++f )
+            for ( uint32_t y=0; y<h; ++y )
+                for ( uint32_t x=0; x<w; ++x )
+                    data[ 8 + (f*h + y)*pitch + x ] = 1000*f + 10*y + x;
+
+        std::ofstream os( path, std::ios::binary );
+        os.write( reinterpret_cast<const char*>( data.data() ), data.size()*sizeof(uint16_t) );
+    }
+
+}
+
+TEST_CASE("mapped_image_test - map frames of a stack")
+{
+    const std::string path = "mapped_image_test.raw";
+    write_stack( path, 6, 4, 8, 3 );
+
+    auto file = std::make_shared<mapped_file>( path );
+    const size_t frame_bytes = 4*8*sizeof(uint16_t);
+    const auto frame = map_image<g_16>( file, { 6, 4 }, 16 + 2*frame_bytes, 8 );
+
+    REQUIRE( !frame.owns_data() );
+    REQUIRE( frame.size() == size{ 6, 4 } );
+    REQUIRE( frame.pitch() == 8 );
+    REQUIRE( reinterpret_cast<const uint8_t*>( frame.data() ) == file->data() + 16 + 2*frame_bytes );
+    REQUIRE( frame[ {0, 0} ] == 2000 );
+    REQUIRE( frame[ {5, 3} ] == 2035 );
+    REQUIRE( frame[ 7 ] == 2011 );
+
+    // usable as any other image
+    const auto view = create_image_view( frame, { {1, 1}, {2, 2} } );
+    REQUIRE( sum( view ) == 2011 + 2012 + 2021 + 2022 );
+    auto [min, max] = minmax( frame );
+    REQUIRE( min == 2000 );
+    REQUIRE( max == 2035 );
+    REQUIRE( gf_image{ frame }[ {5, 3} ] == 2035 );
+
+    // copies own their pixels, with packed rows
+    g16_image copy{ frame };
+    REQUIRE( copy.owns_data() );
+    REQUIRE( copy.pitch() == 6 );
+    REQUIRE( copy == frame );
+    copy[ {0, 0} ] = 1;
+    REQUIRE( frame[ {0, 0} ] == 2000 );
+
+    // the image keeps the mapping alive
+    file.reset();
+    g16_image moved{ std::move( copy ) };
+    moved = frame;
+    REQUIRE( moved[ {5, 3} ] == 2035 );
+
+    // resizing gives storage of its own
+    auto resized{ map_image<g_16>( path, { 6, 4 }, 16, 8 ) };
+    REQUIRE( resized[ {1, 0} ] == 1 );
+    resized.resize( 3, 3 );
+    REQUIRE( resized.owns_data() );
+    resized[ {0, 0} ] = 7;
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("mapped_image_test - copy on write")
+{
+    const std::string path = "mapped_image_test.raw";
+    write_stack( path, 4, 4, 4, 1 );
+
+    auto im = map_image<g_16>( path, { 4, 4 }, 16, 0, mapped_file::mode::COPY_ON_WRITE );
+    REQUIRE( im.pitch() == 4 );
+    im[ {2, 2} ] = 5;
+    REQUIRE( im[ {2, 2} ] == 5 );
+
+    // the file is unchanged
+    REQUIRE( map_image<g_16>( path, { 4, 4 }, 16 )[ {2, 2} ] == 22 );
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("mapped_image_test - errors")
+{
+    const std::string path = "mapped_image_test.raw";
+    write_stack( path, 4, 4, 4, 1 );
+
+    _REQUIRE_THROWS_MATCHES(
+        map_image<g_16>( path, { 4, 4 }, 32 ),
+        std::runtime_error,
+        ContainsSubstring( "requires 64 bytes, file has 48" ) );
+    _REQUIRE_THROWS_MATCHES(
+        map_image<g_16>( path, { 4, 4 }, 15 ),
+        std::runtime_error,
+        ContainsSubstring( "alignment" ) );
+    _REQUIRE_THROWS_MATCHES(
+        map_image<g_16>( path, { 4, 4 }, 16, 3 ),
+        std::runtime_error,
+        ContainsSubstring( "pitch" ) );
+    REQUIRE_THROWS_AS( map_image<g_16>( "does-not-exist.raw", { 4, 4 } ), std::runtime_error );
+
+    std::remove( path.c_str() );
+}
@@ -0,0 +1,114 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+
+// to be tested
+#include "algos/fft.h"
+#include "core/image.h"
+#include "core/memory_resource.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+using namespace openpiv::algos;
+
+TEST_CASE("memory_resource_test - images use the thread's resource")
+{
+    gf_image outside{ 16, 16 };
+    REQUIRE( outside.resource() == std::pmr::new_delete_resource() );
+    REQUIRE( thread_memory_resource() == std::pmr::new_delete_resource() );
+
+    {
+        const scoped_arena arena;
+        gf_image inside{ 16, 16 };
+        REQUIRE( inside.resource() != std::pmr::new_delete_resource() );
+        REQUIRE( inside.resource() == thread_memory_resource() );
+        REQUIRE( reinterpret_cast<uintptr_t>( inside.data() ) % 64 == 0 );
+
+        // copies use the resource current where they're made
+        gf_image copy{ outside };
+        REQUIRE( copy.resource() == inside.resource() );
+
+        // assignment keeps the destination's resource
+        outside = inside;
+        REQUIRE( outside.resource() == std::pmr::new_delete_resource() );
+
+        // explicit resources
+        {
+            const scoped_memory_resource heap{ std::pmr::new_delete_resource() };
+            REQUIRE( gf_image{ 4, 4 }.resource() == std::pmr::new_delete_resource() );
+        }
+        gf_image explicit_heap{ {4, 4}, {}, image_layout::packed(), std::pmr::new_delete_resource() };
+        REQUIRE( explicit_heap.resource() == std::pmr::new_delete_resource() );
+    }
+
+    REQUIRE( thread_memory_resource() == std::pmr::new_delete_resource() );
+}
+
+TEST_CASE("memory_resource_test - arena is released by the outermost scope")
+{
+    const auto before = scoped_arena::stats();
+    {
+        const scoped_arena outer;
+        {
+            const scoped_arena inner;
+            gf_image im{ 16, 16 };
+        }
+        REQUIRE( scoped_arena::stats().releases == before.releases );
+    }
+    REQUIRE( scoped_arena::stats().releases == before.releases + 1 );
+}
+
+TEST_CASE("memory_resource_test - arena grows to fit a scope")
+{
+    // run on a new thread to start from a fresh arena
+    arena_stats first, second, third;
+    std::thread t( [&](){
+        const size_t capacity = scoped_arena::stats().capacity;
+
+        auto window = [capacity](){
+            const scoped_arena arena;
+            gf_image a{ 256, 256 };
+            gf_image b{ 256, 256 };
+            g16_image c{ 32, static_cast<uint32_t>( capacity/64 ) };
+        };
+
+        window();
+        first = scoped_arena::stats();
+        window();
+        second = scoped_arena::stats();
+        window();
+        third = scoped_arena::stats();
+    } );
+    t.join();
+
+    REQUIRE( first.grown == 1 );
+    REQUIRE( second.grown == 1 );
+    REQUIRE( third.grown == 1 );
+    REQUIRE( third.capacity == first.capacity );
+    REQUIRE( third.releases == 3 );
+}
+
+TEST_CASE("memory_resource_test - FFT caches don't use the arena")
+{
+    FFT fft( {32, 32} );
+    gf_image a{ 32, 32, 1.0_gf };
+    gf_image first;
+    {
+        const scoped_arena arena;
+        first = fft.cross_correlate( a, a );
+    }
+
+    // the arena has been released and reused; the cache must be intact
+    {
+        const scoped_arena arena;
+        gf_image overwrite{ 64, 64, 7.0_gf };
+        REQUIRE( fft.cross_correlate( a, a ) == first );
+    }
+}
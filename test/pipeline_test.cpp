@@ -0,0 +1,140 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// to be tested
+#include "core/bounded_queue.h"
+#include "core/pipeline.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+using namespace std::literals;
+
+TEST_CASE("pipeline_test - bounded_queue push/pop")
+{
+    bounded_queue<int> q( 2 );
+    REQUIRE( q.capacity() == 2 );
+    REQUIRE( q.push( 1 ) );
+    REQUIRE( q.push( 2 ) );
+    REQUIRE( q.size() == 2 );
+
+    REQUIRE( *q.pop() == 1 );
+    REQUIRE( *q.pop() == 2 );
+    REQUIRE( q.size() == 0 );
+}
+
+TEST_CASE("pipeline_test - bounded_queue close drains")
+{
+    bounded_queue<int> q( 4 );
+    q.push( 1 );
+    q.push( 2 );
+    q.close();
+
+    REQUIRE( q.closed() );
+    REQUIRE( !q.push( 3 ) );
+    REQUIRE( *q.pop() == 1 );
+    REQUIRE( *q.pop() == 2 );
+    REQUIRE( !q.pop() );
+}
+
+TEST_CASE("pipeline_test - bounded_queue blocks when full")
+{
+    bounded_queue<int> q( 1 );
+    q.push( 1 );
+
+    std::atomic<bool> pushed{ false };
+    std::thread producer( [&](){ q.push( 2 ); pushed = true; } );
+
+    std::this_thread::sleep_for( 20ms );
+    REQUIRE( !pushed );
+
+    REQUIRE( *q.pop() == 1 );
+    producer.join();
+    REQUIRE( pushed );
+    REQUIRE( *q.pop() == 2 );
+}
+
+TEST_CASE("pipeline_test - zero capacity")
+{
+    REQUIRE_THROWS_AS( bounded_queue<int>( 0 ), std::runtime_error );
+}
+
+TEST_CASE("pipeline_test - run_pipeline preserves order")
+{
+    constexpr size_t count = 50;
+    std::vector<size_t> written;
+
+    auto stats = run_pipeline(
+        count,
+        []( size_t i ) { return std::vector<size_t>( 10, i ); },
+        []( size_t, std::vector<size_t>&& v ) { return v[0] * 2; },
+        [&written]( size_t i, size_t&& v ) { REQUIRE( v == 2*i ); written.push_back( v ); },
+        2 );
+
+    REQUIRE( stats.count == count );
+    REQUIRE( written.size() == count );
+    for ( size_t i=0; i<count; ++i )
+        REQUIRE( written[i] == 2*i );
+}
+
+TEST_CASE("pipeline_test - run_pipeline overlaps stages")
+{
+    // each stage sleeps for the same time; if stages overlap the
+    // total time is ~(count + 2) * t rather than 3 * count * t
+    constexpr size_t count = 10;
+    constexpr auto t = 10ms;
+
+    auto stats = run_pipeline(
+        count,
+        [t]( size_t i ) { std::this_thread::sleep_for( t ); return i; },
+        [t]( size_t, size_t&& i ) { std::this_thread::sleep_for( t ); return i; },
+        [t]( size_t, size_t&& ) { std::this_thread::sleep_for( t ); } );
+
+    REQUIRE( stats.total_time < 3 * count * t );
+    REQUIRE( stats.total_time < stats.load_time + stats.process_time + stats.write_time );
+}
+
+TEST_CASE("pipeline_test - run_pipeline propagates exceptions")
+{
+    SECTION("load")
+    {
+        REQUIRE_THROWS_WITH(
+            run_pipeline(
+                10,
+                []( size_t i ) { if ( i == 5 ) throw std::runtime_error( "load" ); return i; },
+                []( size_t, size_t&& i ) { return i; },
+                []( size_t, size_t&& ) {} ),
+            "load" );
+    }
+
+    SECTION("process")
+    {
+        REQUIRE_THROWS_WITH(
+            run_pipeline(
+                10,
+                []( size_t i ) { return i; },
+                []( size_t, size_t&& i ) { if ( i == 5 ) throw std::runtime_error( "process" ); return i; },
+                []( size_t, size_t&& ) {} ),
+            "process" );
+    }
+
+    SECTION("write")
+    {
+        REQUIRE_THROWS_WITH(
+            run_pipeline(
+                10,
+                []( size_t i ) { return i; },
+                []( size_t, size_t&& i ) { return i; },
+                []( size_t i, size_t&& ) { if ( i == 5 ) throw std::runtime_error( "write" ); } ),
+            "write" );
+    }
+}
@@ -0,0 +1,105 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// to be tested
+#include "core/image.h"
+#include "io/piv_service.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    /// a service that returns a 2x1 field holding the first pixel of
+    /// each image, as sent
+    template < typename T >
+    vector_field_d first_pixels( const image<T>& a, const image<T>& b )
+    {
+        if ( a.width() == 13 )
+            throw std::runtime_error( "unlucky width" );
+
+        vector_field_d f( 2, 1 );
+        f.u()[0] = a[0].v;
+        f.v()[0] = b[0].v;
+        f.u()[1] = a.width();
+        f.v()[1] = a.height();
+        return f;
+    }
+
+}
+
+TEST_CASE("piv_service_test - round trip")
+{
+    if ( !has_local_socket() )
+        return;
+
+    // each pixel type has its own handler; pixels aren't converted
+    const std::string socket_path = "piv_service_test.sock";
+    piv_service service( socket_path, piv_handlers{ first_pixels<g_8>, first_pixels<g_16>, first_pixels<g_f> } );
+    std::thread server( [&service](){ service.run(); } );
+
+    {
+        piv_client client( socket_path, "." );
+
+        g16_image a( 8, 6, 1000_g16 );
+        g16_image b( 8, 6, 2000_g16 );
+        auto f = client.process( a, b );
+        REQUIRE( f.nx() == 2 );
+        REQUIRE( f.u()[0] == 1000 );
+        REQUIRE( f.v()[0] == 2000 );
+        REQUIRE( f.u()[1] == 8 );
+        REQUIRE( f.v()[1] == 6 );
+
+        // buffers are resized as required
+        gf_image c( 20, 10, 0.5_gf );
+        f = client.process( c, c );
+        REQUIRE( f.u()[0] == 0.5 );
+        REQUIRE( f.u()[1] == 20 );
+
+        g8_image d( 4, 4, 7_g8 );
+        REQUIRE( client.process( d, d ).u()[0] == 7 );
+
+        // errors are returned to the client, which may carry on
+        g8_image e( 13, 4 );
+        REQUIRE_THROWS_WITH( client.process( e, e ), ContainsSubstring( "unlucky width" ) );
+        REQUIRE_THROWS_AS( client.process( d, e ), std::runtime_error );
+        REQUIRE( client.process( d, d ).v()[0] == 7 );
+    }
+
+    // another client
+    {
+        piv_client client( socket_path, "." );
+        g8_image d( 4, 4, 9_g8 );
+        REQUIRE( client.process( d, d ).u()[0] == 9 );
+        client.shutdown();
+    }
+
+    server.join();
+    REQUIRE( service.requests() == 5 );
+}
+
+TEST_CASE("piv_service_test - stop")
+{
+    if ( !has_local_socket() )
+        return;
+
+    const std::string socket_path = "piv_service_stop_test.sock";
+    {
+        piv_service service( socket_path, []( const auto& a, const auto& b ) { return first_pixels( a, b ); } );
+        std::thread server( [&service](){ service.run(); } );
+        service.stop();
+        server.join();
+    }
+
+    // socket file is removed with the service
+    REQUIRE_THROWS_AS( piv_client( socket_path ), std::runtime_error );
+}
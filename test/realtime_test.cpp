@@ -0,0 +1,223 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// to be tested
+#include "core/realtime.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+using namespace std::literals;
+
+TEST_CASE("realtime_test - latency percentiles")
+{
+    latency_recorder recorder( 100 );
+    REQUIRE( recorder.percentile( 50 ) == latency_recorder::duration_t{} );
+
+    for ( size_t i=1; i<=100; ++i )
+        recorder.add( std::chrono::milliseconds( i ) );
+
+    REQUIRE( recorder.count() == 100 );
+    REQUIRE( recorder.percentile( 50 ) == 50ms );
+    REQUIRE( recorder.percentile( 99 ) == 99ms );
+    REQUIRE( recorder.percentile( 100 ) == 100ms );
+    REQUIRE( recorder.percentile( 0 ) == 1ms );
+    REQUIRE( recorder.max() == 100ms );
+
+    // only the most recent samples are kept
+    for ( size_t i=0; i<100; ++i )
+        recorder.add( 1ms );
+    REQUIRE( recorder.percentile( 100 ) == 1ms );
+    REQUIRE( recorder.max() == 100ms );
+}
+
+TEST_CASE("realtime_test - frames are processed in order")
+{
+    static constexpr size_t count = 20;
+    std::vector<size_t> seen;
+    std::atomic<size_t> errors{ 0 };
+
+    // callbacks run on the processing thread, so only count errors there
+    realtime_options options;
+    options.deadline = 10s;
+    realtime_pipeline<int, int> pipeline(
+        std::vector<int>( 3 ),
+        [&errors]( int& frame, const realtime_context& ctx ) {
+            if ( ctx.quality() != realtime_quality::FULL || ctx.behind( 0.5 ) )
+                ++errors;
+            return 2*frame;
+        },
+        [&seen, &errors]( const realtime_frame_info& info, int* result ) {
+            if ( !result || *result != 2*static_cast<int>(info.index) || !info.deadline_met )
+                ++errors;
+            seen.push_back( info.index );
+        },
+        options );
+
+    for ( size_t i=0; i<count; )
+    {
+        if ( int* frame = pipeline.try_acquire() )
+        {
+            *frame = static_cast<int>( i++ );
+            pipeline.submit();
+        }
+        else
+            std::this_thread::yield();
+    }
+    pipeline.close();
+
+    auto stats = pipeline.stats();
+    REQUIRE( errors == 0 );
+    REQUIRE( seen.size() == stats.submitted );
+    REQUIRE( stats.submitted == count );
+    REQUIRE( stats.quality_counts[static_cast<size_t>(realtime_quality::FULL)] == count );
+    REQUIRE( stats.late == 0 );
+    REQUIRE( stats.p50 <= stats.p99 );
+    REQUIRE( stats.p99 <= stats.max );
+    for ( size_t i=0; i<seen.size(); ++i )
+        REQUIRE( seen[i] == i );
+}
+
+TEST_CASE("realtime_test - overruns when all slots are in use")
+{
+    std::atomic<bool> release{ false };
+    realtime_pipeline<int, int> pipeline(
+        std::vector<int>( 1 ),
+        [&release]( int& frame, const realtime_context& ) {
+            while ( !release )
+                std::this_thread::sleep_for( 1ms );
+            return frame;
+        },
+        []( const realtime_frame_info&, int* ) {} );
+
+    REQUIRE( pipeline.try_acquire() );
+    pipeline.submit();
+    REQUIRE( pipeline.try_acquire() == nullptr );
+    REQUIRE_THROWS_AS( pipeline.submit(), std::runtime_error );
+
+    release = true;
+    pipeline.close();
+    REQUIRE( pipeline.stats().overruns == 1 );
+    REQUIRE( pipeline.stats().submitted == 1 );
+}
+
+TEST_CASE("realtime_test - frame ids survive overruns")
+{
+    std::atomic<bool> release{ false };
+    std::vector<std::pair<size_t, size_t>> seen;    // index, id
+    realtime_options options;
+    options.deadline = 10s;
+    realtime_pipeline<int, int> pipeline(
+        std::vector<int>( 1 ),
+        [&release]( int& frame, const realtime_context& ) {
+            while ( !release )
+                std::this_thread::sleep_for( 1ms );
+            return frame;
+        },
+        [&seen]( const realtime_frame_info& info, int* ) { seen.emplace_back( info.index, info.id ); },
+        options );
+
+    // frame 0 is submitted, frame 1 lost to an overrun, frame 2
+    // submitted once the slot is free
+    REQUIRE( pipeline.try_acquire() );
+    pipeline.submit( 0 );
+    REQUIRE( pipeline.try_acquire() == nullptr );
+
+    release = true;
+    int* frame = nullptr;
+    while ( !(frame = pipeline.try_acquire()) )
+        std::this_thread::yield();
+    pipeline.submit( 2 );
+    pipeline.close();
+
+    REQUIRE( pipeline.stats().overruns >= 1 );
+    REQUIRE( seen.size() == 2 );
+    REQUIRE( seen[0] == std::make_pair<size_t, size_t>( 0, 0 ) );
+    REQUIRE( seen[1] == std::make_pair<size_t, size_t>( 1, 2 ) );
+}
+
+TEST_CASE("realtime_test - quality is reduced to meet the deadline")
+{
+    // full quality can never meet the deadline, reduced quality can
+    realtime_options options;
+    options.deadline = 40ms;
+    std::vector<realtime_quality> qualities;
+    realtime_pipeline<int, int> pipeline(
+        std::vector<int>( 2 ),
+        []( int& frame, const realtime_context& ctx ) {
+            std::this_thread::sleep_for( ctx.quality() == realtime_quality::FULL ? 60ms : 2ms );
+            return frame;
+        },
+        [&qualities]( const realtime_frame_info& info, int* ) { qualities.push_back( info.quality ); },
+        options );
+
+    for ( size_t i=0; i<10; ++i )
+    {
+        if ( pipeline.try_acquire() )
+            pipeline.submit();
+        std::this_thread::sleep_for( 80ms );
+    }
+    pipeline.close();
+
+    const auto stats = pipeline.stats();
+    REQUIRE( qualities.size() == stats.submitted );
+    REQUIRE( stats.quality_counts[static_cast<size_t>(realtime_quality::FULL)] == 1 );
+    REQUIRE( stats.quality_counts[static_cast<size_t>(realtime_quality::NO_SUBPIXEL)] == stats.submitted - 1 );
+    REQUIRE( qualities.back() == realtime_quality::NO_SUBPIXEL );
+    REQUIRE( to_string( qualities.back() ) == "no-subpixel" );
+}
+
+TEST_CASE("realtime_test - late frames are dropped")
+{
+    realtime_options options;
+    options.deadline = 5ms;
+    std::vector<bool> results;
+    std::atomic<size_t> errors{ 0 };
+    realtime_pipeline<int, int> pipeline(
+        std::vector<int>( 2 ),
+        []( int& frame, const realtime_context& ) {
+            std::this_thread::sleep_for( 20ms );
+            return frame;
+        },
+        [&results, &errors]( const realtime_frame_info& info, int* result ) {
+            if ( (info.quality == realtime_quality::DROPPED) != (result == nullptr) )
+                ++errors;
+            results.push_back( result != nullptr );
+        },
+        options );
+
+    // the second frame waits behind the first, past its deadline
+    for ( size_t i=0; i<2; ++i )
+    {
+        REQUIRE( pipeline.try_acquire() );
+        pipeline.submit();
+    }
+    pipeline.close();
+
+    REQUIRE( errors == 0 );
+    REQUIRE( results == std::vector<bool>{ true, false } );
+    REQUIRE( pipeline.stats().quality_counts[static_cast<size_t>(realtime_quality::DROPPED)] == 1 );
+    REQUIRE( pipeline.stats().late == 1 );
+}
+
+TEST_CASE("realtime_test - errors are reported to the producer")
+{
+    realtime_pipeline<int, int> pipeline(
+        std::vector<int>( 2 ),
+        []( int&, const realtime_context& ) -> int { throw std::runtime_error( "camera on fire" ); },
+        []( const realtime_frame_info&, int* ) {} );
+
+    REQUIRE( pipeline.try_acquire() );
+    pipeline.submit();
+    REQUIRE_THROWS_WITH( pipeline.close(), ContainsSubstring( "camera on fire" ) );
+}
@@ -0,0 +1,132 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// to be tested
+#include "core/sharded_batch.h"
+#include "io/vector_field_series.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+TEST_CASE("sharded_batch_test - workers write into a series")
+{
+    if ( !has_sharded_batch() )
+        return;
+
+    const std::string path = "sharded_batch_test.vfs";
+    constexpr size_t count = 23;
+    vector_field_series::create( path, count, { 4, 3 } );
+
+    // each worker opens its own mapping of the result file
+    std::unique_ptr<vector_field_series> series;
+    std::vector<size_t> shards;
+    sharded_batch_options options;
+    options.process_count = 3;
+    options.poll_interval = std::chrono::milliseconds( 1 );
+
+    std::vector<size_t> progress;
+    run_sharded(
+        count,
+        [&series, &shards]( size_t i )
+        {
+            vector_field_d f( 4, 3 );
+            f.u()[0] = i;
+            f.v()[0] = shards.back();
+            series->write( i, f );
+        },
+        options,
+        [&progress]( size_t completed, size_t total )
+        {
+            if ( total == count )
+                progress.push_back( completed );
+        },
+        [&series, &shards, &path]( size_t shard, size_t, size_t )
+        {
+            shards.push_back( shard );
+            series = std::make_unique<vector_field_series>( path, mapped_file::mode::READ_WRITE );
+        } );
+
+    // workers don't share the parent's memory
+    REQUIRE( shards.empty() );
+    REQUIRE( !series );
+
+    REQUIRE( !progress.empty() );
+    REQUIRE( progress.back() == count );
+    for ( size_t i=1; i<progress.size(); ++i )
+        REQUIRE( progress[i] >= progress[i - 1] );
+
+    vector_field_series result( path );
+    for ( size_t i=0; i<count; ++i )
+    {
+        REQUIRE( result.written( i ) );
+        REQUIRE( result.read( i ).u()[0] == i );
+
+        // contiguous shards
+        size_t shard = 0;
+        while ( ((shard + 1)*count)/3 <= i )
+            ++shard;
+        REQUIRE( result.read( i ).v()[0] == shard );
+    }
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("sharded_batch_test - more processes than items")
+{
+    if ( !has_sharded_batch() )
+        return;
+
+    size_t reported = 0;
+    sharded_batch_options options;
+    options.process_count = 8;
+    run_sharded( 2, []( size_t ) {}, options, [&reported]( size_t completed, size_t ) { reported = completed; } );
+    REQUIRE( reported == 2 );
+
+    REQUIRE_NOTHROW( run_sharded( 0, []( size_t ) { throw std::runtime_error( "not called" ); } ) );
+}
+
+TEST_CASE("sharded_batch_test - worker errors are reported")
+{
+    if ( !has_sharded_batch() )
+        return;
+
+    sharded_batch_options options;
+    options.process_count = 2;
+    REQUIRE_THROWS_WITH(
+        run_sharded(
+            10,
+            []( size_t i ) {
+                if ( i == 7 )
+                    throw std::runtime_error( "bad pair 7" );
+            },
+            options ),
+        ContainsSubstring( "worker 1 failed: bad pair 7" ) );
+}
+
+#if !defined(_WIN32)
+TEST_CASE("sharded_batch_test - workers that can't be waited for are reported")
+{
+    if ( !has_sharded_batch() )
+        return;
+
+    // with SIGCHLD ignored finished workers are reaped automatically,
+    // so waitpid fails and their outcome is unknown
+    const auto previous = std::signal( SIGCHLD, SIG_IGN );
+    sharded_batch_options options;
+    options.process_count = 2;
+    CHECK_THROWS_WITH(
+        run_sharded( 4, []( size_t ) {}, options ),
+        ContainsSubstring( "worker 0 could not be waited for" ) );
+    std::signal( SIGCHLD, previous );
+}
+#endif
@@ -0,0 +1,233 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// local
+#include "test_utils.h"
+
+// to be tested
+#include "core/mapped_file.h"
+#include "core/vector_field.h"
+#include "io/vector_field_io.h"
+#include "io/vector_field_series.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+namespace {
+
+    template < typename T >
+    vector_field<T> make_field( uint32_t nx, uint32_t ny )
+    {
+        vector_field<T> f( nx, ny );
+        for ( size_t i=0; i<f.size(); ++i )
+        {
+            f.x()[i] = 16 * (i % nx);
+            f.y()[i] = 16 * (i / nx);
+            f.u()[i] = 0.25 * i;
+            f.v()[i] = -0.5 * i;
+            f.quality()[i] = 1.5;
+            f.flags()[i] = i % 3 == 0 ? vector_flag::INVALID : vector_flag::NONE;
+        }
+
+        return f;
+    }
+
+    template < typename T, typename U >
+    bool same( const vector_field<T>& a, const vector_field<U>& b )
+    {
+        if ( a.nx() != b.nx() || a.ny() != b.ny() )
+            return false;
+
+        for ( size_t i=0; i<a.size(); ++i )
+            if ( a.x()[i] != b.x()[i] || a.y()[i] != b.y()[i] ||
+                 a.u()[i] != b.u()[i] || a.v()[i] != b.v()[i] ||
+                 a.quality()[i] != b.quality()[i] || a.flags()[i] != b.flags()[i] )
+                return false;
+
+        return true;
+    }
+
+}
+
+TEST_CASE("vector_field_io_test - mapped_file")
+{
+    const std::string path = "mapped_file_test.bin";
+    {
+        auto file = mapped_file::create( path, 100 );
+        REQUIRE( file.size() == 100 );
+        file.data()[10] = 42;
+    }
+
+    mapped_file file( path );
+    REQUIRE( file.size() == 100 );
+    REQUIRE( file.data()[10] == 42 );
+
+    mapped_file moved( std::move( file ) );
+    REQUIRE( !file.is_open() );
+    REQUIRE( moved.data()[10] == 42 );
+
+    REQUIRE_THROWS_AS( mapped_file( "does-not-exist.bin" ), std::runtime_error );
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("vector_field_io_test - round trip")
+{
+    const std::string path = "vector_field_test.vec";
+    auto field = make_field<double>( 7, 5 );
+
+    vector_field_parameters parameters;
+    parameters.window_size = { 32, 32 };
+    parameters.window_spacing = { 16, 16 };
+    parameters.dt = 0.001;
+    parameters.scale = 2.5;
+    parameters.position_units = "mm";
+    parameters.velocity_units = "m/s";
+
+    write_vector_field( path, field, parameters );
+
+    SECTION("same type")
+    {
+        vector_field_parameters read_parameters;
+        auto read = read_vector_field<double>( path, &read_parameters );
+        REQUIRE( same( field, read ) );
+        REQUIRE( read_parameters.window_size == size{ 32, 32 } );
+        REQUIRE( read_parameters.window_spacing == size{ 16, 16 } );
+        REQUIRE( read_parameters.dt == 0.001 );
+        REQUIRE( read_parameters.scale == 2.5 );
+        REQUIRE( read_parameters.position_units == "mm" );
+        REQUIRE( read_parameters.velocity_units == "m/s" );
+
+        // columns are aligned within the mapping
+        REQUIRE( reinterpret_cast<uintptr_t>( read.u() ) % 64 == 0 );
+
+        // writes are private to the mapping
+        read.u()[0] = 100;
+        REQUIRE( read_vector_field<double>( path ).u()[0] == 0 );
+    }
+
+    SECTION("converted type")
+    {
+        auto read = read_vector_field<float>( path );
+        REQUIRE( same( field, read ) );
+    }
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("vector_field_io_test - float field")
+{
+    const std::string path = "vector_field_float_test.vec";
+    auto field = make_field<float>( 3, 3 );
+    write_vector_field( path, field );
+    REQUIRE( same( field, read_vector_field<float>( path ) ) );
+    REQUIRE( same( field, read_vector_field<double>( path ) ) );
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("vector_field_io_test - text conversion")
+{
+    const std::string path = "vector_field_text_test.vec";
+    auto field = make_field<double>( 2, 2 );
+    write_vector_field( path, field );
+
+    std::stringstream converted;
+    convert_vector_field_to_text( path, converted );
+
+    std::stringstream direct;
+    write_vector_field_text( direct, field );
+
+    REQUIRE( converted.str() == direct.str() );
+    REQUIRE( direct.str() == "0, 0, 0, -0, 1.5\n16, 0, 0.25, -0.5, 1.5\n0, 16, 0.5, -1, 1.5\n16, 16, 0.75, -1.5, 1.5\n" );
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("vector_field_io_test - invalid files")
+{
+    const std::string path = "vector_field_invalid_test.vec";
+    {
+        std::ofstream os( path, std::ios::binary );
+        os << std::string( 512, 'x' );
+    }
+    REQUIRE_THROWS_AS( read_vector_field<double>( path ), std::runtime_error );
+
+    {
+        std::ofstream os( path, std::ios::binary );
+        os << "short";
+    }
+    REQUIRE_THROWS_AS( read_vector_field<double>( path ), std::runtime_error );
+
+    // a column offset which would wrap around when its size is added
+    write_vector_field( path, make_field<double>( 3, 2 ) );
+    {
+        const uint64_t offset = ~uint64_t{ 63 };
+        std::fstream fs( path, std::ios::binary | std::ios::in | std::ios::out );
+        fs.seekp( 128 + 2*sizeof(uint64_t) );
+        fs.write( reinterpret_cast<const char*>( &offset ), sizeof(offset) );
+    }
+    _REQUIRE_THROWS_MATCHES(
+        read_vector_field<double>( path ),
+        std::runtime_error,
+        ContainsSubstring( "invalid column layout" ) );
+
+    std::remove( path.c_str() );
+}
+
+TEST_CASE("vector_field_io_test - series")
+{
+    const std::string path = "vector_field_series_test.vfs";
+
+    vector_field_parameters parameters;
+    parameters.window_size = { 32, 32 };
+    parameters.velocity_units = "m/s";
+
+    {
+        auto series = vector_field_series::create( path, 4, { 3, 2 }, parameters );
+        REQUIRE( series.frames() == 4 );
+        REQUIRE( series.shape() == size{ 3, 2 } );
+        REQUIRE( !series.written( 0 ) );
+        REQUIRE_THROWS_AS( series.read( 0 ), std::runtime_error );
+
+        // frames may be written in any order
+        series.write( 2, make_field<double>( 3, 2 ) );
+        auto field = make_field<double>( 3, 2 );
+        field.u()[1] = 42;
+        series.write( 0, field );
+
+        REQUIRE_THROWS_AS( series.write( 1, make_field<double>( 2, 3 ) ), std::runtime_error );
+        REQUIRE_THROWS_AS( series.write( 4, field ), std::out_of_range );
+    }
+
+    {
+        // a second writer sees the first writer's frames
+        vector_field_series series( path, mapped_file::mode::READ_WRITE );
+        REQUIRE( series.written( 0 ) );
+        series.write( 3, make_field<double>( 3, 2 ) );
+    }
+
+    vector_field_series series( path );
+    REQUIRE( series.parameters().window_size == size{ 32, 32 } );
+    REQUIRE( series.parameters().velocity_units == "m/s" );
+    REQUIRE( series.written( 0 ) );
+    REQUIRE( !series.written( 1 ) );
+    REQUIRE( series.written( 2 ) );
+    REQUIRE( series.written( 3 ) );
+    REQUIRE( series.read( 0 ).u()[1] == 42 );
+    REQUIRE( same( series.read( 2 ), make_field<double>( 3, 2 ) ) );
+    REQUIRE( reinterpret_cast<uintptr_t>( series.read( 3 ).v() ) % 64 == 0 );
+
+    REQUIRE_THROWS_AS( series.write( 1, make_field<double>( 3, 2 ) ), std::runtime_error );
+    REQUIRE_THROWS_AS( vector_field_series( "vector_field_float_test_missing.vfs" ), std::runtime_error );
+
+    std::remove( path.c_str() );
+}
@@ -0,0 +1,134 @@
+// catch
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// to be tested
+#include "core/grid.h"
+#include "core/vector_field.h"
+
+using namespace std::string_literals;
+using namespace Catch;
+using namespace Catch::Matchers;
+using namespace openpiv::core;
+
+TEST_CASE("vector_field_test - construction")
+{
+    vector_field_d empty;
+    REQUIRE( empty.empty() );
+    REQUIRE( empty.nx() == 0 );
+
+    vector_field_f f( 5, 3 );
+    REQUIRE( f.nx() == 5 );
+    REQUIRE( f.ny() == 3 );
+    REQUIRE( f.size() == 15 );
+    REQUIRE( f.shape() == size{ 5, 3 } );
+    REQUIRE( f.stride() == 5 );
+
+    bool zeroed = true;
+    for ( size_t i=0; i<f.size(); ++i )
+        zeroed &= f.x()[i] == 0 && f.y()[i] == 0 && f.u()[i] == 0 && f.v()[i] == 0 &&
+            f.quality()[i] == 0 && f.flags()[i] == vector_flag::NONE;
+    REQUIRE( zeroed );
+}
+
+TEST_CASE("vector_field_test - columns are contiguous and disjoint")
+{
+    vector_field_d f( 4, 4 );
+    for ( size_t i=0; i<f.size(); ++i )
+    {
+        f.x()[i] = 1;
+        f.y()[i] = 2;
+        f.u()[i] = 3;
+        f.v()[i] = 4;
+        f.quality()[i] = 5;
+        f.flags()[i] = vector_flag::REPLACED;
+    }
+
+    for ( size_t i=0; i<f.size(); ++i )
+    {
+        auto e = f[i];
+        REQUIRE( e.xy == point2<double>{ 1, 2 } );
+        REQUIRE( e.uv == vector2<double>{ 3, 4 } );
+        REQUIRE( e.quality == 5 );
+        REQUIRE( e.flags == vector_flag::REPLACED );
+    }
+}
+
+TEST_CASE("vector_field_test - indexing and neighbours")
+{
+    vector_field_d f( 4, 3 );
+    REQUIRE( f.index( 2, 1 ) == 6 );
+    REQUIRE( f.position( 6 ) == point2<uint32_t>{ 2, 1 } );
+
+    REQUIRE( *f.neighbour( 6, 1, 0 ) == 7 );
+    REQUIRE( *f.neighbour( 6, -1, 0 ) == 5 );
+    REQUIRE( *f.neighbour( 6, 0, 1 ) == 10 );
+    REQUIRE( *f.neighbour( 6, 0, -1 ) == 2 );
+    REQUIRE( *f.neighbour( 6, 1, 1 ) == 11 );
+
+    // edges don't wrap
+    REQUIRE( !f.neighbour( 3, 1, 0 ) );
+    REQUIRE( !f.neighbour( 4, -1, 0 ) );
+    REQUIRE( !f.neighbour( 1, 0, -1 ) );
+    REQUIRE( !f.neighbour( 9, 0, 1 ) );
+}
+
+TEST_CASE("vector_field_test - set and clone")
+{
+    vector_field_d f( 2, 2 );
+    f.set( 3, { { 10, 20 }, { 1.5, -2.5 }, 3.0, vector_flag::INVALID } );
+
+    // shared fields alias
+    auto shared = f.share();
+    REQUIRE( shared.u()[3] == 1.5 );
+    shared.u()[3] = 7;
+    REQUIRE( f.u()[3] == 7 );
+
+    // copies and clones don't
+    auto copy = f;
+    copy.u()[3] = 8;
+    REQUIRE( f.u()[3] == 7 );
+    REQUIRE( copy.flags()[3] == vector_flag::INVALID );
+
+    shared = f;
+    shared.u()[3] = 8;
+    REQUIRE( f.u()[3] == 7 );
+
+    auto deep = f.clone();
+    deep.u()[3] = 9;
+    REQUIRE( f.u()[3] == 7 );
+    REQUIRE( deep.x()[3] == 10 );
+    REQUIRE( deep.flags()[3] == vector_flag::INVALID );
+}
+
+TEST_CASE("vector_field_test - external storage")
+{
+    auto storage = std::make_shared<std::vector<float>>( 6*4, 1.0f );
+    auto flags = std::make_shared<std::vector<uint8_t>>( 4, vector_flag::MASKED );
+    float* p = storage->data();
+
+    vector_field_f::columns_t columns{ p, p + 4, p + 8, p + 12, p + 16, flags->data() };
+    vector_field_f f( 2, 2, columns, storage );
+    REQUIRE( f.u()[0] == 1.0f );
+    REQUIRE( f.flags()[2] == vector_flag::MASKED );
+
+    columns.v = nullptr;
+    REQUIRE_THROWS_AS( vector_field_f( 2, 2, columns, storage ), std::runtime_error );
+}
+
+TEST_CASE("vector_field_test - grid shape")
+{
+    auto grid = generate_cartesian_grid( {200, 72}, {32, 32}, 0.5 );
+    auto shape = grid_shape( grid );
+    REQUIRE( shape == size{ 11, 3 } );
+    REQUIRE( shape.area() == grid.size() );
+
+    vector_field_d f( shape );
+    REQUIRE( f.size() == grid.size() );
+}